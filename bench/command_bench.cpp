@@ -0,0 +1,417 @@
+/**
+ * @file command_bench.cpp
+ * @brief Swell Smart Lamp - Benchmark WebSocket command path (env:native_bench)
+ *
+ * Me-replay stream command (bench/streams/) ke handleWebSocketMessage()
+ * dengan fake hardware, lalu melaporkan per tipe command:
+ * p50/p99/max latency, byte & jumlah alokasi heap, heap high-water mark
+ * selama command, dan byte WebSocket yang dikirim.
+ *
+ * Format stream: satu command per baris, "<delay_ms> <json>".
+ * delay_ms = jeda simulasi sejak command sebelumnya. Baris '#' = komentar.
+ *
+ *   pio run -e native_bench
+ *   .pio/build/native_bench/program --repeat 200 --budget-us 500 bench/streams/session.txt bench/streams/slider_drag.txt
+ *
+ * --binary: setiap command dikonversi sekali ke frame biner
+ * (binary_protocol.h) lalu di-replay sebagai frame biner.
+ *
+ * Setiap pesan lewat reassembleWebSocketMessage() seperti di onEvent();
+ * --chunk N memecah frame jadi potongan N byte (simulasi multi-paket TCP).
+ *
+ * --clients N: jumlah dashboard yang terhubung (command datang dari client
+ * #1), --slow-clients M: M di antaranya hanya mengosongkan antrian kirim
+ * 1 pesan/detik. "ws B/cmd" = byte di jaringan untuk semua client.
+ */
+
+#ifndef ARDUINO
+
+#include <algorithm>
+#include <chrono>
+#include <malloc.h>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "actuators.h"
+#include "binary_protocol.h"
+#include "audio_driver.h"
+#include "hal_native.h"
+#include "light_engine.h"
+#include "settings_store.h"
+#include "socket_fanout.h"
+#include "status_broadcast.h"
+#include "swell_core.h"
+#include "wall_clock.h"
+#include "ws_reassembly.h"
+
+// =================================================================
+// HEAP ACCOUNTING (glibc malloc hooks)
+// =================================================================
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+struct HeapStats
+{
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+    size_t allocatedBytes = 0;
+    size_t allocations = 0;
+};
+
+static HeapStats heap;
+
+static void trackAlloc(void *ptr)
+{
+    if (!ptr)
+        return;
+    size_t size = malloc_usable_size(ptr);
+    heap.liveBytes += size;
+    heap.allocatedBytes += size;
+    heap.allocations++;
+    if (heap.liveBytes > heap.peakBytes)
+        heap.peakBytes = heap.liveBytes;
+}
+
+static void trackFree(void *ptr)
+{
+    if (ptr)
+        heap.liveBytes -= malloc_usable_size(ptr);
+}
+
+extern "C" void *malloc(size_t size)
+{
+    void *ptr = __libc_malloc(size);
+    trackAlloc(ptr);
+    return ptr;
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    void *ptr = __libc_calloc(count, size);
+    trackAlloc(ptr);
+    return ptr;
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    size_t oldSize = ptr ? malloc_usable_size(ptr) : 0;
+    void *result = __libc_realloc(ptr, size);
+    if (result || size == 0)
+    {
+        heap.liveBytes -= oldSize;
+        trackAlloc(result);
+    }
+    return result;
+}
+
+extern "C" void free(void *ptr)
+{
+    trackFree(ptr);
+    __libc_free(ptr);
+}
+
+// =================================================================
+// COMMAND STREAM
+// =================================================================
+
+struct StreamEntry
+{
+    unsigned long delayMs;
+    std::string command; // Nama command (untuk grouping)
+    std::string json;
+    std::string payload; // Yang di-replay: JSON atau frame biner
+    bool binary = false;
+};
+
+static bool convertToBinary(StreamEntry &entry)
+{
+    SwellCommand command;
+    uint8_t frame[BINARY_COMMAND_MAX_SIZE];
+    if (!parseCommand(reinterpret_cast<const uint8_t *>(entry.json.data()), entry.json.size(), command))
+        return false;
+
+    size_t len = encodeBinaryCommand(command, frame, sizeof(frame));
+    if (len == 0)
+        return false;
+
+    entry.payload.assign(reinterpret_cast<const char *>(frame), len);
+    entry.binary = true;
+    return true;
+}
+
+static std::string extractCommandName(const std::string &json)
+{
+    size_t key = json.find("\"command\"");
+    if (key == std::string::npos)
+        return "<invalid>";
+    size_t start = json.find('"', json.find(':', key) + 1);
+    size_t end = start == std::string::npos ? start : json.find('"', start + 1);
+    if (end == std::string::npos)
+        return "<invalid>";
+    return json.substr(start + 1, end - start - 1);
+}
+
+static bool loadStream(const char *path, std::vector<StreamEntry> &entries)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        fprintf(stderr, "cannot open stream %s\n", path);
+        return false;
+    }
+
+    char line[1024];
+    while (fgets(line, sizeof(line), file))
+    {
+        char *text = line;
+        while (*text == ' ' || *text == '\t')
+            text++;
+        if (*text == '#' || *text == '\n' || *text == '\0')
+            continue;
+
+        char *json = nullptr;
+        unsigned long delayMs = strtoul(text, &json, 10);
+        while (*json == ' ' || *json == '\t')
+            json++;
+        size_t len = strcspn(json, "\r\n");
+
+        StreamEntry entry;
+        entry.delayMs = delayMs;
+        entry.json.assign(json, len);
+        entry.command = extractCommandName(entry.json);
+        entry.payload = entry.json;
+        entries.push_back(entry);
+    }
+
+    fclose(file);
+    return true;
+}
+
+// =================================================================
+// RESULTS
+// =================================================================
+
+struct CommandStats
+{
+    std::vector<double> latencyUs;
+    size_t allocatedBytes = 0;
+    size_t allocations = 0;
+    size_t peakHeapBytes = 0; // High-water mark di atas heap awal command
+    size_t wsBytes = 0;
+};
+
+static double percentile(std::vector<double> &samples, double p)
+{
+    if (samples.empty())
+        return 0;
+    std::sort(samples.begin(), samples.end());
+    size_t rank = (size_t)(p / 100.0 * samples.size() + 0.5);
+    rank = std::min(std::max(rank, (size_t)1), samples.size());
+    return samples[rank - 1];
+}
+
+/** @brief Kirim payload lewat reassembly seperti onEvent(), dipotong per chunk byte */
+static void deliverMessage(const StreamEntry &entry, size_t chunk)
+{
+    const uint8_t *payload = reinterpret_cast<const uint8_t *>(entry.payload.data());
+    size_t total = entry.payload.size();
+    if (chunk == 0 || chunk > total)
+        chunk = total;
+
+    WsFragment fragment;
+    fragment.binary = entry.binary;
+    fragment.frameNumber = 0;
+    fragment.finalFrame = true;
+    fragment.frameLength = total;
+
+    size_t offset = 0;
+    do
+    {
+        size_t len = total - offset < chunk ? total - offset : chunk;
+        fragment.frameIndex = offset;
+
+        const uint8_t *message;
+        size_t messageLen;
+        if (reassembleWebSocketMessage(1, fragment, payload + offset, len, message, messageLen) == WS_MESSAGE_COMPLETE)
+            handleWebSocketMessage(message, messageLen, entry.binary, 1);
+        offset += len;
+    } while (offset < total);
+}
+
+static void advanceSimulatedTime(unsigned long delayMs)
+{
+    // Cek deadline scheduler sekali per detik simulasi (jalan hanya jika jatuh tempo)
+    nativeFakes.sockets.drain(delayMs);
+
+    unsigned long long target = nativeFakes.clock.now + delayMs;
+    while (nativeFakes.clock.now / 1000 < target / 1000)
+    {
+        nativeFakes.clock.now = (nativeFakes.clock.now / 1000 + 1) * 1000;
+        serviceWallClock();
+        serviceSchedules();
+        serviceUserSettingsPersistence();
+        serviceAudio();
+        serviceLight();
+    }
+    nativeFakes.clock.now = target;
+    serviceUserSettingsPersistence();
+    serviceAudio();
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long repeat = 100;
+    double budgetUs = 0;
+    bool binary = false;
+    size_t chunk = 0;
+    unsigned long clients = 1, slowClients = 0;
+    std::vector<StreamEntry> stream;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--binary") == 0)
+            binary = true;
+        else if (strcmp(argv[i], "--chunk") == 0 && i + 1 < argc)
+            chunk = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--clients") == 0 && i + 1 < argc)
+            clients = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--slow-clients") == 0 && i + 1 < argc)
+            slowClients = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--budget-us") == 0 && i + 1 < argc)
+            budgetUs = atof(argv[++i]);
+        else if (!loadStream(argv[i], stream))
+            return 2;
+    }
+
+    if (stream.empty())
+    {
+        fprintf(stderr, "usage: %s [--repeat N] [--budget-us US] [--binary] [--chunk BYTES] [--clients N] [--slow-clients M] stream.txt...\n", argv[0]);
+        return 2;
+    }
+
+    // Fake device: 20:30, DFPlayer ada, settings default
+    hal.rtc->set(0, 30, 20, 2, 5, 1, 26);
+    wallClockSync(true);
+    loadUserSettings();
+    initializeDFPlayer();
+    serviceAudio();
+    nativeFakes.sockets.keepLastMessage = false;
+    nativeFakes.sockets.clients.clear();
+    for (unsigned long id = 1; id <= std::max(clients, slowClients + 1); id++)
+    {
+        FakeSocketClient client{(uint32_t)id};
+        if (id > std::max(clients, slowClients + 1) - slowClients)
+            client.drainPerSecond = 1;
+        nativeFakes.sockets.clients.push_back(client);
+    }
+
+    size_t jsonBytes = 0, replayBytes = 0;
+    for (StreamEntry &entry : stream)
+    {
+        if (binary && !convertToBinary(entry))
+            fprintf(stderr, "tidak bisa dikonversi ke biner, tetap JSON: %s\n", entry.json.c_str());
+        jsonBytes += entry.json.size();
+        replayBytes += entry.payload.size();
+    }
+
+    std::map<std::string, CommandStats> results;
+    std::map<std::string, size_t> occurrences;
+    for (const StreamEntry &entry : stream)
+        occurrences[entry.command]++;
+    for (auto &item : occurrences)
+        results[item.first].latencyUs.reserve(item.second * repeat);
+
+    for (unsigned long round = 0; round < repeat; round++)
+    {
+        for (const StreamEntry &entry : stream)
+        {
+            advanceSimulatedTime(entry.delayMs);
+
+            CommandStats &stats = results[entry.command];
+            HeapStats before = heap;
+            heap.peakBytes = heap.liveBytes;
+            unsigned long wsBytesBefore = nativeFakes.sockets.bytesSent;
+
+            auto started = std::chrono::steady_clock::now();
+            deliverMessage(entry, chunk);
+            auto elapsed = std::chrono::steady_clock::now() - started;
+
+            stats.allocatedBytes += heap.allocatedBytes - before.allocatedBytes;
+            stats.allocations += heap.allocations - before.allocations;
+            stats.peakHeapBytes = std::max(stats.peakHeapBytes, heap.peakBytes - before.liveBytes);
+            stats.wsBytes += nativeFakes.sockets.bytesSent - wsBytesBefore;
+            stats.latencyUs.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+
+            heap.peakBytes = std::max(heap.peakBytes, before.peakBytes);
+        }
+    }
+
+    serviceAudio(); // Kirim sisa frame DFPlayer sebelum statistik dicetak
+
+    printf("%-16s %7s %9s %9s %9s %11s %10s %10s %9s\n",
+           "command", "count", "p50(us)", "p99(us)", "max(us)", "alloc B/cmd", "allocs/cmd", "heap peak", "ws B/cmd");
+
+    bool overBudget = false;
+    for (auto &item : results)
+    {
+        CommandStats &stats = item.second;
+        size_t count = stats.latencyUs.size();
+        double p50 = percentile(stats.latencyUs, 50);
+        double p99 = percentile(stats.latencyUs, 99);
+        double max = stats.latencyUs.empty() ? 0 : stats.latencyUs.back();
+
+        printf("%-16s %7zu %9.2f %9.2f %9.2f %11.1f %10.1f %10zu %9.1f%s\n",
+               item.first.c_str(), count, p50, p99, max,
+               (double)stats.allocatedBytes / count, (double)stats.allocations / count,
+               stats.peakHeapBytes, (double)stats.wsBytes / count,
+               budgetUs > 0 && p99 > budgetUs ? "  OVER BUDGET" : "");
+
+        overBudget |= budgetUs > 0 && p99 > budgetUs;
+    }
+
+    printf("\ninbound per stream   : %zu bytes %s (JSON: %zu bytes)\n",
+           replayBytes, binary ? "binary" : "JSON", jsonBytes);
+    const WsReassemblyStats &frames = wsReassemblyStats();
+    printf("ws messages          : %lu zero-copy, %lu reassembled, %lu oversized, %lu out-of-order (largest %zu B)\n",
+           frames.zeroCopy, frames.reassembled, frames.oversized, frames.outOfOrder, frames.largestMessage);
+    const SocketFanoutStats &fanout = socketFanoutStats();
+    printf("ws fan-out           : %lu broadcasts, %lu replies, %lu deliveries to %zu clients (%lu dropped, %lu status skipped, %lu resyncs, queue high-water %zu)\n",
+           fanout.broadcasts, fanout.replies, fanout.deliveries, nativeFakes.sockets.clients.size(),
+           fanout.dropped, fanout.statusSkipped, fanout.resyncs, fanout.queueHighWater);
+    printf("heap high-water mark : %zu bytes\n", heap.peakBytes);
+    printf("total allocated      : %zu bytes in %zu allocations\n", heap.allocatedBytes, heap.allocations);
+    const SettingsPersistenceStats &persistence = userSettingsPersistenceStats();
+    printf("nvs writes           : %lu (%lu bytes)\n", nativeFakes.store.writes, nativeFakes.store.bytesWritten);
+    printf("setting changes      : %lu (%lu coalesced, %lu unchanged skipped)\n",
+           persistence.changeRequests, persistence.writesCoalesced, persistence.writesSkippedUnchanged);
+    const StatusBroadcastStats &status = statusBroadcastStats();
+    printf("status broadcasts    : %lu full, %lu patch, %lu seq-only (%lu fields sent, %lu suppressed)\n",
+           status.fullUpdates, status.patches, status.heartbeats, status.fieldsSent, status.fieldsSuppressed);
+    const ActuatorStats &actuators = actuatorStats();
+    unsigned long actuatorWrites = 0, actuatorSuppressed = 0;
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+    {
+        actuatorWrites += actuators.writes[i];
+        actuatorSuppressed += actuators.suppressed[i];
+    }
+    printf("actuator writes      : %lu (%lu suppressed, unchanged)\n", actuatorWrites, actuatorSuppressed);
+    const LightStats &light = lightStats();
+    printf("light fades          : %lu scenes, %lu segments (%lu deferred, %lu pwm writes while fading)\n",
+           light.scenes, light.segments, light.deferred, nativeFakes.pwm.conflicts);
+    const AudioDriverStats &audio = audioDriverStats();
+    printf("audio commands       : %lu (%lu coalesced, %lu suppressed, %lu timeouts)\n",
+           nativeFakes.audio.commands, audio.coalesced, audio.suppressed, audio.timeouts);
+
+    return overBudget ? 1 : 0;
+}
+
+#endif
@@ -19,12 +19,111 @@ const FIXED_RELAX_PLAYLIST = [
 
 const ALARM_TRACK = { trackNumber: 5, title: "ALARM SOUND", filename: "0005_Alarm_sound_alarm.mp3" };
 
+// Playlist dari device di-cache bersama etag-nya; device hanya mengirim
+// ulang playlist penuh jika etag berubah ("playlistUnchanged" jika sama)
+const PLAYLIST_CACHE_KEY = 'swell_playlist';
+
+function loadPlaylistCache() {
+    try {
+        const cached = JSON.parse(localStorage.getItem(PLAYLIST_CACHE_KEY) || 'null');
+        return cached && Array.isArray(cached.playlist) && cached.playlist.length ? cached : null;
+    } catch (e) {
+        return null;
+    }
+}
+
+function savePlaylistCache(etag, playlist) {
+    localStorage.setItem(PLAYLIST_CACHE_KEY, JSON.stringify({ etag, playlist }));
+}
+
+function getActivePlaylist() {
+    const cached = loadPlaylistCache();
+    return cached ? cached.playlist : FIXED_RELAX_PLAYLIST;
+}
+
+// =================================================================
+// BINARY PROTOCOL (include/binary_protocol.h)
 // =================================================================
-// RTC TIME TRACKING VARIABLES
+// Setelah ESP32 membalas "hello" dengan binaryVersion yang sama, command
+// dikirim sebagai frame biner: 1 byte opcode + payload lebar tetap
+// (little-endian). Tambahkan ?json di URL atau localStorage
+// swell_protocol = "json" untuk tetap memakai JSON (debugging).
+const BINARY_PROTOCOL_VERSION = 1;
+const BINARY_OPCODES = {
+    'getStatus': 0x01,
+    'getPlaylist': 0x02,
+    'getClockSync': 0x03,
+    'rtc-calibrate': 0x04,
+    'timer-toggle': 0x05,
+    'timer-confirm': 0x06,
+    'light-intensity': 0x07,
+    'aroma-toggle': 0x08,
+    'alarm-toggle': 0x09,
+    'music-toggle': 0x0A,
+    'music-track': 0x0B,
+    'music-volume': 0x0C
+};
+const forceJsonProtocol = new URLSearchParams(location.search).has('json') ||
+    localStorage.getItem('swell_protocol') === 'json';
+let binaryProtocol = false;
+
+function parseTimeBytes(text) {
+    const match = /^(\d{1,2}):(\d{1,2})/.exec(text || '');
+    return match ? [parseInt(match[1]), parseInt(match[2])] : [0xFF, 0xFF];
+}
+
+/** @returns {Uint8Array|null} null jika command tidak punya encoding biner */
+function encodeBinaryCommand(command, value) {
+    const opcode = BINARY_OPCODES[command];
+    if (opcode === undefined) return null;
+
+    let payload = [];
+    if (command === 'getPlaylist') {
+        const etag = (value && value.etag) || '';
+        if (etag.length === 8) payload = Array.from(etag, c => c.charCodeAt(0));
+    } else if (command === 'getClockSync') {
+        const token = (value && value.token) >>> 0;
+        payload = [token & 0xFF, (token >>> 8) & 0xFF, (token >>> 16) & 0xFF, token >>> 24];
+    } else if (command === 'rtc-calibrate') {
+        payload = [value.year & 0xFF, value.year >> 8, value.month, value.day,
+            value.dayOfWeek, value.hour, value.minute, value.second];
+    } else if (command === 'timer-confirm') {
+        payload = [...parseTimeBytes(value.start), ...parseTimeBytes(value.end)];
+    } else if (command !== 'getStatus') {
+        payload = [typeof value === 'boolean' ? (value ? 1 : 0) : value & 0xFF];
+    }
+
+    return Uint8Array.from([opcode, ...payload]);
+}
+
 // =================================================================
-let rtcTimeOffset = 0;
-let rtcTimeReceived = null;
-let rtcTimeReceivedAt = null;
+// RTC TIME TRACKING (clockSync + ekstrapolasi lokal)
+// =================================================================
+// ESP32 mengirim waktunya sekali (clockSync), browser melanjutkan sendiri
+// dengan performance.now(). getClockSync hanya dikirim lagi jika estimasi
+// error (setengah RTT + drift) melewati CLOCK_SYNC_MAX_ERROR_MS, atau
+// ESP32 mem-push clockSync baru saat jamnya melompat (kalibrasi).
+const CLOCK_SYNC_MAX_ERROR_MS = 500;
+const CLOCK_DRIFT_BUDGET_PPM = 100; // Selisih laju jam browser vs ESP32 (asumsi terburuk)
+const CLOCK_SYNC_RETRY_MS = 5000;
+
+let clockSync = null; // { localMs, perfAt, rttMs, generation, uptimeMs }
+let clockSyncToken = 0;
+let clockSyncPending = null; // { token, sentAt }
+let rtcTimeUpdatesStarted = false;
+
+// =================================================================
+// STATUS SNAPSHOT (delta broadcast dari ESP32)
+// =================================================================
+// ESP32 hanya mengirim field yang berubah (statusPatch). Snapshot lokal
+// di-merge lalu UI di-render ulang; jika ada seq yang terlewat, minta
+// full resync via getStatus. getStatus bisa dibuang ESP32 saat antrian
+// command penuh, jadi diminta lagi jika snapshot tidak datang.
+const STATUS_RESYNC_RETRY_MS = 3000;
+
+let statusSnapshot = null;
+let statusSeq = 0;
+let statusResyncSentAt = null; // performance.now() saat getStatus dikirim, null = tidak menunggu
 
 // =================================================================
 // LOGIKA UTAMA & INISIALISASI
@@ -179,10 +278,17 @@ function initializeDeviceDetailPage() {
 
     function onOpen(event) {
         console.log(`Connection to ${deviceIp} opened.`);
+        statusSnapshot = null;
+        binaryProtocol = false;
         updateConnectionStatus(true, deviceName);
+        if (!forceJsonProtocol) sendCommand('hello', { binary: BINARY_PROTOCOL_VERSION });
         sendCommand('getStatus');
-        sendCommand('getRTC');
+        statusResyncSentAt = performance.now();
+        clockSyncPending = null;
+        requestClockSync();
 
+        const cachedPlaylist = loadPlaylistCache();
+        sendCommand('getPlaylist', cachedPlaylist ? { etag: cachedPlaylist.etag } : {});
         populateSongDropdownWithFixedPlaylist();
         startRTCTimeUpdates();
     }
@@ -205,12 +311,22 @@ function initializeDeviceDetailPage() {
 
             if (data.type === 'statusUpdate') {
                 // ⭐ FIXED: Update UI berdasarkan user settings, bukan execution state
-                updateUIFromUserSettings(data.state, data.executionState);
+                handleStatusUpdate(data);
+            } else if (data.type === 'statusPatch') {
+                handleStatusPatch(data);
+            } else if (data.type === 'statusSeq') {
+                handleStatusSeq(data);
             } else if (data.type === 'playlist') {
-                console.log('📻 Received playlist from device, but using fixed playlist instead');
+                console.log(`📻 Received playlist from device (etag ${data.etag})`);
+                savePlaylistCache(data.etag, data.playlist);
                 populateSongDropdownWithFixedPlaylist();
-            } else if (data.type === 'rtcTime') {
-                handleRTCTimeUpdate(data);
+            } else if (data.type === 'playlistUnchanged') {
+                console.log(`📻 Cached playlist still valid (etag ${data.etag})`);
+            } else if (data.type === 'hello') {
+                binaryProtocol = !forceJsonProtocol && data.binaryVersion === BINARY_PROTOCOL_VERSION;
+                console.log(`🔌 Protokol command: ${binaryProtocol ? 'binary' : 'JSON'}`);
+            } else if (data.type === 'clockSync') {
+                handleClockSync(data);
             } else if (data.type === 'rtcCalibrated') {
                 handleRTCCalibrationResponse(data);
             }
@@ -223,34 +339,110 @@ function initializeDeviceDetailPage() {
     setupRTCCalibration();
 }
 
+// =================================================================
+// STATUS DELTA FUNCTIONS
+// =================================================================
+
+function handleStatusUpdate(data) {
+    statusSnapshot = { state: data.state, executionState: data.executionState };
+    statusSeq = data.seq || 0;
+    statusResyncSentAt = null;
+    updateUIFromUserSettings(statusSnapshot.state, statusSnapshot.executionState);
+}
+
+function handleStatusPatch(data) {
+    if (!statusSnapshot || data.seq !== statusSeq + 1) {
+        console.log(`🔄 Status seq gap (have ${statusSeq}, got ${data.seq}), requesting full resync`);
+        requestStatusResync();
+        return;
+    }
+
+    mergeStatus(statusSnapshot, { state: data.state, executionState: data.executionState });
+    statusSeq = data.seq;
+    updateUIFromUserSettings(statusSnapshot.state, statusSnapshot.executionState);
+}
+
+function handleStatusSeq(data) {
+    if (!statusSnapshot || data.seq !== statusSeq) {
+        requestStatusResync();
+    }
+}
+
+function requestStatusResync() {
+    statusSnapshot = null;
+    const now = performance.now();
+    if (statusResyncSentAt !== null && now - statusResyncSentAt < STATUS_RESYNC_RETRY_MS) return;
+    if (statusResyncSentAt !== null) console.log('🔄 getStatus tanpa balasan, minta ulang');
+    statusResyncSentAt = now;
+    sendCommand('getStatus');
+}
+
+function mergeStatus(target, patch) {
+    Object.keys(patch).forEach(key => {
+        const value = patch[key];
+        if (value === undefined) return;
+        if (value !== null && typeof value === 'object' && !Array.isArray(value)) {
+            if (!target[key] || typeof target[key] !== 'object') target[key] = {};
+            mergeStatus(target[key], value);
+        } else {
+            target[key] = value;
+        }
+    });
+    return target;
+}
+
 // =================================================================
 // NEW: RTC TIME FUNCTIONS
 // =================================================================
 
-function handleRTCTimeUpdate(data) {
-    console.log('🕐 RTC Time received from ESP32:', data);
-
-    const rtcData = data.rtc;
-    const rtcTime = new Date(
-        rtcData.year,
-        rtcData.month - 1,
-        rtcData.day,
-        rtcData.hour,
-        rtcData.minute,
-        rtcData.second
-    );
+function requestClockSync() {
+    if (!websocket || websocket.readyState !== WebSocket.OPEN) return;
+
+    clockSyncToken = (clockSyncToken % 1000000) + 1;
+    clockSyncPending = { token: clockSyncToken, sentAt: performance.now() };
+    sendCommand('getClockSync', { token: clockSyncToken });
+}
+
+function handleClockSync(data) {
+    const receivedAt = performance.now();
+    let perfAt = receivedAt;
+    let rttMs = clockSync ? clockSync.rttMs : 0;
 
-    rtcTimeReceived = rtcTime;
-    rtcTimeReceivedAt = new Date();
-    rtcTimeOffset = rtcTimeReceived.getTime() - rtcTimeReceivedAt.getTime();
+    // Balasan untuk request kita: waktu device diambil di tengah round-trip
+    if (clockSyncPending && data.echo === clockSyncPending.token) {
+        rttMs = receivedAt - clockSyncPending.sentAt;
+        perfAt = clockSyncPending.sentAt + rttMs / 2;
+        clockSyncPending = null;
+    }
+
+    if (clockSync && data.uptimeMs < clockSync.uptimeMs) {
+        console.log('🕐 ESP32 reboot terdeteksi (uptime mundur)');
+    }
 
-    console.log(`🕐 RTC Time: ${rtcTime.toLocaleString()}`);
-    console.log(`🕐 Browser Time: ${rtcTimeReceivedAt.toLocaleString()}`);
-    console.log(`🕐 Offset: ${rtcTimeOffset / 1000} seconds`);
+    clockSync = {
+        localMs: data.localMs,
+        perfAt,
+        rttMs,
+        generation: data.generation,
+        uptimeMs: data.uptimeMs
+    };
 
+    console.log(`🕐 clockSync: ${getCurrentRTCTime().toLocaleString()} (rtt ${rttMs.toFixed(0)} ms, gen ${data.generation}, drift ${data.driftPpb} ppb)`);
     updateRTCTimeDisplay();
 }
 
+function clockSyncErrorMs() {
+    if (!clockSync) return Infinity;
+    const elapsed = performance.now() - clockSync.perfAt;
+    return clockSync.rttMs / 2 + elapsed * CLOCK_DRIFT_BUDGET_PPM / 1e6;
+}
+
+function checkClockSync() {
+    if (clockSyncErrorMs() <= CLOCK_SYNC_MAX_ERROR_MS) return;
+    if (clockSyncPending && performance.now() - clockSyncPending.sentAt < CLOCK_SYNC_RETRY_MS) return;
+    requestClockSync();
+}
+
 function handleRTCCalibrationResponse(data) {
     const calibrationMessage = document.getElementById('calibration-message');
     const calibrateButton = document.getElementById('rtc-calibrate-button');
@@ -259,10 +451,7 @@ function handleRTCCalibrationResponse(data) {
         calibrationMessage.textContent = '✅ RTC successfully calibrated with browser time!';
         calibrationMessage.style.color = '#4cd964';
 
-        rtcTimeOffset = 0;
-        rtcTimeReceived = new Date();
-        rtcTimeReceivedAt = new Date();
-
+        // clockSync baru di-push ESP32 setelah kalibrasi
         console.log('✅ RTC Calibration successful');
     } else {
         calibrationMessage.textContent = '❌ RTC calibration failed. Please try again.';
@@ -278,15 +467,21 @@ function handleRTCCalibrationResponse(data) {
 }
 
 function getCurrentRTCTime() {
-    if (!rtcTimeReceived || !rtcTimeReceivedAt) {
+    if (!clockSync) {
         return new Date();
     }
 
-    const now = new Date();
-    const elapsedSinceReceived = now.getTime() - rtcTimeReceivedAt.getTime();
-    const estimatedRTCTime = new Date(rtcTimeReceived.getTime() + elapsedSinceReceived);
-
-    return estimatedRTCTime;
+    // localMs = jam dinding device sebagai "UTC"; ubah ke Date lokal browser
+    const device = new Date(clockSync.localMs + (performance.now() - clockSync.perfAt));
+    return new Date(
+        device.getUTCFullYear(),
+        device.getUTCMonth(),
+        device.getUTCDate(),
+        device.getUTCHours(),
+        device.getUTCMinutes(),
+        device.getUTCSeconds(),
+        device.getUTCMilliseconds()
+    );
 }
 
 function updateRTCTimeDisplay() {
@@ -314,16 +509,19 @@ function updateTimeComparison() {
 }
 
 function startRTCTimeUpdates() {
+    if (rtcTimeUpdatesStarted) return; // onOpen dipanggil lagi setiap reconnect
+    rtcTimeUpdatesStarted = true;
+
+    // Hanya render lokal; tidak ada polling ke ESP32
     setInterval(() => {
         updateRTCTimeDisplay();
         updateTimeComparison();
+        checkClockSync();
     }, 1000);
 
-    setInterval(() => {
-        if (websocket && websocket.readyState === WebSocket.OPEN) {
-            sendCommand('getRTC');
-        }
-    }, 30000);
+    document.addEventListener('visibilitychange', () => {
+        if (document.visibilityState === 'visible') checkClockSync();
+    });
 }
 
 function setupRTCCalibration() {
@@ -357,20 +555,31 @@ function populateSongDropdownWithFixedPlaylist() {
     const songSelect = document.getElementById('song-select');
     if (!songSelect) return;
 
+    const playlist = getActivePlaylist();
+    const selectedTrack = songSelect.value;
     songSelect.innerHTML = '';
 
-    FIXED_RELAX_PLAYLIST.forEach(track => {
+    playlist.forEach(track => {
         const option = document.createElement('option');
         option.value = track.trackNumber;
         option.textContent = track.title;
         songSelect.appendChild(option);
     });
 
-    console.log(`📻 Dropdown populated with ${FIXED_RELAX_PLAYLIST.length} updated tracks`);
+    if (selectedTrack) songSelect.value = selectedTrack;
+
+    console.log(`📻 Dropdown populated with ${playlist.length} updated tracks`);
 }
 
 function sendCommand(command, value) {
     if (websocket && websocket.readyState === WebSocket.OPEN) {
+        const frame = binaryProtocol ? encodeBinaryCommand(command, value) : null;
+        if (frame) {
+            console.log(`Sending to ESP32 (binary ${frame.length} B):`, command, value);
+            websocket.send(frame);
+            return;
+        }
+
         const message = JSON.stringify({ command, value });
         console.log('Sending to ESP32:', message);
         websocket.send(message);
@@ -611,11 +820,12 @@ function updateUIFromUserSettings(state, executionState) {
 
         // Update track dan volume controls
         if (songSelect && state.music.track) {
-            const trackExists = FIXED_RELAX_PLAYLIST.some(track => track.trackNumber === state.music.track);
+            const playlist = getActivePlaylist();
+            const trackExists = playlist.some(track => track.trackNumber === state.music.track);
             if (trackExists) {
                 songSelect.value = state.music.track;
             } else {
-                songSelect.value = FIXED_RELAX_PLAYLIST[0].trackNumber;
+                songSelect.value = playlist[0].trackNumber;
             }
         }
 
@@ -0,0 +1,39 @@
+/**
+ * @file actuators.h
+ * @brief Swell Smart Lamp - Output actuator dengan dirty-check (LED PWM, GPIO aromatherapy)
+ *
+ * Nilai terakhir yang di-apply ke setiap output di-cache. setActuator()
+ * hanya menyentuh hardware (hal.pwm / hal.gpio) jika nilainya berubah,
+ * sehingga scheduler boleh "menulis ulang" state yang sama tanpa biaya.
+ * Write pertama setelah boot atau invalidateActuators() selalu dikirim.
+ *
+ * fadeActuator() sama, tapi output PWM berpindah ke nilai baru lewat fade
+ * hardware LEDC; actuatorValue() langsung berisi nilai tujuan fade.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+enum ActuatorOutput : uint8_t
+{
+    ACTUATOR_WHITE_LED,   // PWM_CHANNEL_WHITE
+    ACTUATOR_YELLOW_LED,  // PWM_CHANNEL_YELLOW
+    ACTUATOR_AROMATHERAPY, // AROMATHERAPY_PIN (0 / 1)
+    ACTUATOR_COUNT
+};
+
+struct ActuatorStats
+{
+    unsigned long writes[ACTUATOR_COUNT] = {};     // Benar-benar ke hardware
+    unsigned long suppressed[ACTUATOR_COUNT] = {}; // Nilai sama, tidak dikirim
+    unsigned long fades[ACTUATOR_COUNT] = {};      // Bagian dari writes yang berupa fade hardware
+};
+
+void setActuator(ActuatorOutput output, uint32_t value);
+void fadeActuator(ActuatorOutput output, uint32_t value, uint32_t durationMs); // GPIO / 0 ms = setActuator()
+uint32_t actuatorValue(ActuatorOutput output); // Nilai terakhir yang di-apply
+void invalidateActuators();                    // Paksa write berikutnya ke hardware
+
+const char *actuatorName(ActuatorOutput output);
+const ActuatorStats &actuatorStats();
@@ -0,0 +1,95 @@
+/**
+ * @file audio_driver.h
+ * @brief Swell Smart Lamp - Driver DFPlayer Mini non-blocking (antrian frame UART)
+ *
+ * Pengganti DFRobotDFPlayerMini: play/stop/volume tidak pernah menunggu
+ * ACK. Request masuk ke antrian kecil, serviceAudio() (dari loop()) mengirim
+ * satu frame setiap kali, menunggu ACK (0x41) dengan timeout + retry, dan
+ * meneruskan event dari modul (siap, error, track selesai) ke handler.
+ *
+ * Coalescing di antrian:
+ * - volume: hanya nilai terakhir yang dikirim, volume sama di-skip
+ * - play/stop: request transport baru menggantikan yang belum terkirim,
+ *   stop saat tidak ada yang diputar di-skip
+ *
+ * Handshake (reset -> tunggu 0x3F) juga non-blocking; request selama
+ * handshake ditahan di antrian dan dikirim setelah modul siap.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+const size_t AUDIO_QUEUE_CAPACITY = 8;
+const unsigned long AUDIO_ACK_TIMEOUT_MS = 200;
+const int AUDIO_MAX_RETRIES = 2;                  // Kirim ulang sebelum frame dibuang
+const unsigned long AUDIO_INIT_TIMEOUT_MS = 3000; // Reset -> "card online" (0x3F)
+const int AUDIO_INIT_ATTEMPTS = 3;
+const unsigned long AUDIO_NO_DEADLINE = 0xFFFFFFFFUL;
+
+// Frame serial DFPlayer: 7E FF 06 CMD ACK PARAM_H PARAM_L CHK_H CHK_L EF
+const size_t AUDIO_FRAME_SIZE = 10;
+
+enum DfPlayerCommand : uint8_t
+{
+    DFPLAYER_CMD_PLAY = 0x03,
+    DFPLAYER_CMD_VOLUME = 0x06,
+    DFPLAYER_CMD_EQ = 0x07,
+    DFPLAYER_CMD_RESET = 0x0C,
+    DFPLAYER_CMD_STOP = 0x16,
+
+    // Balasan / event dari modul
+    DFPLAYER_EVT_USB_FINISHED = 0x3C,
+    DFPLAYER_EVT_TF_FINISHED = 0x3D,
+    DFPLAYER_EVT_FLASH_FINISHED = 0x3E,
+    DFPLAYER_EVT_ONLINE = 0x3F,
+    DFPLAYER_EVT_ERROR = 0x40,
+    DFPLAYER_EVT_ACK = 0x41
+};
+
+void encodeAudioFrame(uint8_t command, uint16_t param, bool ack, uint8_t *frame);
+
+enum AudioDriverState : uint8_t
+{
+    AUDIO_OFFLINE,  // audioDriverBegin() belum dipanggil
+    AUDIO_STARTING, // Menunggu modul selesai reset
+    AUDIO_READY,
+    AUDIO_FAILED // Handshake gagal AUDIO_INIT_ATTEMPTS kali
+};
+
+enum AudioEvent : uint8_t
+{
+    AUDIO_EVENT_READY,
+    AUDIO_EVENT_FAILED,
+    AUDIO_EVENT_FINISHED, // param = nomor track yang selesai
+    AUDIO_EVENT_ERROR     // param = kode error DFPlayer
+};
+
+typedef void (*AudioEventHandler)(AudioEvent event, int param);
+
+struct AudioDriverStats
+{
+    unsigned long framesSent = 0; // Termasuk retry dan reset
+    unsigned long acked = 0;
+    unsigned long retries = 0;
+    unsigned long timeouts = 0; // Frame dibuang setelah semua retry habis
+    unsigned long errors = 0;   // Balasan 0x40 dari modul
+    unsigned long coalesced = 0;
+    unsigned long suppressed = 0; // Request redundant (volume sama / stop saat idle)
+    unsigned long dropped = 0;    // Antrian penuh
+    unsigned long finished = 0;
+    unsigned long highWater = 0;
+};
+
+void audioDriverBegin(AudioEventHandler handler); // Buka UART + mulai handshake
+bool audioPlay(int track);
+bool audioStop();
+bool audioVolume(int level); // 0-30
+bool audioEqNormal();
+
+void serviceAudio();                     // Kirim/terima frame, panggil dari loop()
+unsigned long millisUntilAudioService(); // AUDIO_NO_DEADLINE jika hanya menunggu event
+
+AudioDriverState audioDriverState();
+const AudioDriverStats &audioDriverStats();
@@ -0,0 +1,44 @@
+/**
+ * @file binary_protocol.h
+ * @brief Swell Smart Lamp - Framing biner untuk command WebSocket
+ *
+ * Alternatif ringkas untuk JSON {command, value}. Satu frame WebSocket
+ * biner = 1 byte opcode (nilai CommandType) + payload lebar tetap,
+ * little-endian, tanpa heap dan tanpa ArduinoJson:
+ *
+ *   opcode                     payload
+ *   0x01 getStatus             -
+ *   0x02 getPlaylist           - | etag 8 karakter hex
+ *   0x03 getClockSync          u32 token
+ *   0x04 rtc-calibrate         u16 year, u8 month, day, dayOfWeek, hour, minute, second
+ *   0x05 timer-toggle          u8 0/1
+ *   0x06 timer-confirm         u8 startHour, startMinute, endHour, endMinute (0xFF = tidak ada)
+ *   0x07 light-intensity       u8 0-100
+ *   0x08 aroma-toggle          u8 0/1
+ *   0x09 alarm-toggle          u8 0/1
+ *   0x0A music-toggle          u8 0/1
+ *   0x0B music-track           u8 nomor track
+ *   0x0C music-volume          u8 0-100
+ *   0x0D hello                 u8 versi protokol biner
+ *
+ * Panjang payload diambil dari CommandSpec::binarySize (command_table.cpp),
+ * nilai divalidasi dengan validateCommand() yang sama dengan JSON.
+ *
+ * Negosiasi: browser mengirim JSON {"command":"hello","value":{"binary":1}},
+ * ESP32 membalas {"type":"hello","binaryVersion":1}; setelah itu browser
+ * boleh mengirim frame biner. Balasan/broadcast dari ESP32 tetap JSON
+ * (dikirim sekali ke semua client, termasuk client JSON).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "command_queue.h"
+
+const uint8_t BINARY_PROTOCOL_VERSION = 1;
+const size_t BINARY_COMMAND_MAX_SIZE = 9; // opcode + rtc-calibrate / getPlaylist
+
+bool decodeBinaryCommand(const uint8_t *data, size_t len, SwellCommand &command);
+size_t encodeBinaryCommand(const SwellCommand &command, uint8_t *out, size_t capacity); // 0 jika gagal
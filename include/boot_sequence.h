@@ -0,0 +1,72 @@
+/**
+ * @file boot_sequence.h
+ * @brief Swell Smart Lamp - Boot bertahap: stage init paralel dengan dependensi + timing
+ *
+ * Setiap stage (WiFi, filesystem, RTC, settings, DFPlayer, web server)
+ * dimulai begitu stage yang ditunggunya selesai, tanpa menunggu stage
+ * lain. Stage yang lama (asosiasi WiFi, handshake DFPlayer, mount SPIFFS)
+ * berjalan di background dan melapor selesai lewat poll() atau
+ * bootStageDone(), sementara setup() kembali dan loop() sudah jalan.
+ *
+ * Durasi tiap stage dan waktu sampai semua stage selesai dicatat
+ * (log + GET /metrics). Dependensi hanya soal urutan: stage yang gagal
+ * atau timeout tetap melepas stage yang menunggunya (web server tetap
+ * naik walau SPIFFS gagal di-mount).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+const size_t BOOT_MAX_STAGES = 8;
+const unsigned long BOOT_NO_DEADLINE = 0xFFFFFFFFUL;
+
+enum BootStageState : uint8_t
+{
+    BOOT_PENDING, // Menunggu dependensi
+    BOOT_RUNNING,
+    BOOT_DONE,
+    BOOT_FAILED // Gagal atau timeout
+};
+
+// Hasil start()/poll(): BOOT_RUNNING = selesai nanti (poll() berikutnya atau bootStageDone())
+typedef BootStageState (*BootStageFn)();
+
+struct BootStage
+{
+    const char *name;
+    uint32_t after;          // Bitmask BOOT_AFTER(index) stage yang harus selesai dulu
+    BootStageFn start;
+    BootStageFn poll;        // Opsional, dicek serviceBoot() selama BOOT_RUNNING
+    unsigned long timeoutMs; // 0 = tanpa batas
+};
+
+#define BOOT_AFTER(index) (1UL << (index))
+
+struct BootStageTiming
+{
+    BootStageState state;
+    unsigned long startMs; // hal.clock->millis() saat start()
+    unsigned long doneMs;  // ... saat selesai (valid jika DONE / FAILED)
+};
+
+/**
+ * @brief Mulai boot: stage tanpa dependensi di-start sesuai urutan tabel.
+ * Tabel harus hidup selama program berjalan (biasanya static const).
+ */
+void bootBegin(const BootStage *stages, size_t count);
+
+void serviceBoot();                     // loop(): poll, timeout, start stage yang siap
+unsigned long millisUntilBootService(); // Timeout terdekat, BOOT_NO_DEADLINE jika tidak ada
+
+// Dari task mana pun (task filesystem, event WiFi); diabaikan jika stage
+// sudah selesai / timeout. Pemanggil membangunkan loop() sendiri.
+void bootStageDone(size_t index, bool ok);
+
+bool bootComplete();
+unsigned long bootReadyMs(); // Waktu semua stage selesai sejak boot (valid jika bootComplete())
+
+size_t bootStageCount();
+const char *bootStageName(size_t index);
+BootStageTiming bootStageTiming(size_t index);
@@ -0,0 +1,89 @@
+/**
+ * @file command_queue.h
+ * @brief Swell Smart Lamp - Antrian command SPSC (AsyncTCP task -> loop())
+ *
+ * Task AsyncTCP hanya mem-parse JSON menjadi SwellCommand lalu enqueue.
+ * loop() adalah satu-satunya pemilik userSettings, executionState, LEDC dan
+ * DFPlayer: semua command di-apply di sana lewat processCommandQueue().
+ *
+ * Ring buffer lock-free single-producer/single-consumer: producer hanya
+ * menulis head, consumer hanya menulis tail. Jika penuh, command dibuang
+ * (dihitung di CommandQueueStats::dropped), task jaringan tidak pernah
+ * menunggu.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+const size_t COMMAND_QUEUE_CAPACITY = 16; // Harus pangkat 2
+
+// Nilai enum juga opcode protokol biner (binary_protocol.h, swell-script.js)
+// dan index SWELL_COMMANDS (command_table.cpp): jangan diubah urutannya,
+// command baru ditambahkan di akhir
+enum CommandType : uint8_t
+{
+    CMD_UNKNOWN = 0,
+    CMD_GET_STATUS = 1,
+    CMD_GET_PLAYLIST = 2,
+    CMD_GET_CLOCK_SYNC = 3,
+    CMD_RTC_CALIBRATE = 4,
+    CMD_TIMER_TOGGLE = 5,
+    CMD_TIMER_CONFIRM = 6,
+    CMD_LIGHT_INTENSITY = 7,
+    CMD_AROMA_TOGGLE = 8,
+    CMD_ALARM_TOGGLE = 9,
+    CMD_MUSIC_TOGGLE = 10,
+    CMD_MUSIC_TRACK = 11,
+    CMD_MUSIC_VOLUME = 12,
+    CMD_HELLO = 13, // Negosiasi protokol saat connect
+    CMD_GET_LOGS = 14, // Log terbaru dari ring buffer (swell_log.h)
+    CMD_GET_METRICS = 15, // Counter & histogram runtime (metrics.h)
+    COMMAND_TYPE_COUNT
+};
+
+/** @brief Command yang sudah di-parse, bisa disalin tanpa heap */
+struct SwellCommand
+{
+    CommandType type = CMD_UNKNOWN;
+    int32_t value = 0;     // Nilai bool/int dari field "value" (getClockSync: token)
+    uint32_t clientId = 0; // Pengirim; balasan query hanya ke client ini (0 = semua)
+
+    // timer-confirm: -1 = tidak ada di pesan (nilai lama dipertahankan)
+    int16_t startHour = -1;
+    int16_t startMinute = -1;
+    int16_t endHour = -1;
+    int16_t endMinute = -1;
+
+    // rtc-calibrate
+    int16_t year = 0;
+    int8_t month = 0;
+    int8_t day = 0;
+    int8_t dayOfWeek = 0;
+    int8_t hour = 0;
+    int8_t minute = 0;
+    int8_t second = 0;
+
+    // getPlaylist
+    char etag[12] = {};
+};
+
+struct CommandQueueStats
+{
+    unsigned long enqueued = 0;  // Ditulis producer
+    unsigned long dropped = 0;   // Ditulis producer (antrian penuh)
+    unsigned long highWater = 0; // Ditulis producer
+    unsigned long applied = 0;   // Ditulis consumer
+    unsigned long coalesced = 0; // Ditulis consumer (slider: hanya nilai terakhir di-apply)
+};
+
+// Producer (task AsyncTCP)
+bool enqueueCommand(const SwellCommand &command);
+
+// Consumer (loop())
+bool dequeueCommand(SwellCommand &command);
+const SwellCommand *peekCommand(); // nullptr jika kosong
+size_t commandQueueDepth();
+
+CommandQueueStats &commandQueueStats();
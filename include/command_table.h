@@ -0,0 +1,77 @@
+/**
+ * @file command_table.h
+ * @brief Swell Smart Lamp - Tabel command WebSocket (nama, skema argumen, gating)
+ *
+ * Setiap CommandType punya satu baris di SWELL_COMMANDS (command_table.cpp):
+ * nama JSON, skema "value", ukuran payload biner, syarat state sebelum
+ * di-apply, dan apakah command sejenis di antrian boleh digabung. Parser
+ * JSON, decoder biner (binary_protocol.cpp) dan applyCommand() membaca
+ * tabel yang sama, jadi command baru cukup: nilai enum di command_queue.h,
+ * satu baris di SWELL_COMMANDS, satu handler di swell_core.cpp.
+ *
+ * Lookup nama -> CommandType memakai FNV-1a constexpr sebagai label switch:
+ * O(1), tanpa heap, dan nama yang hash-nya bentrok gagal saat compile
+ * (duplicate case). Setelah hash cocok nama tetap dibandingkan penuh.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "command_queue.h"
+
+/** @brief Skema field "value" di JSON {command, value} */
+enum CommandArg : uint8_t
+{
+    ARG_NONE,       // value diabaikan
+    ARG_BOOL,       // true/false (angka 0/1 juga diterima)
+    ARG_INT,        // Bilangan bulat dalam rentang min..max
+    ARG_FIELD,      // {<field>: bilangan bulat}, field boleh tidak ada (= 0)
+    ARG_ETAG,       // {etag: "8 hex"}, opsional
+    ARG_TIME_RANGE, // {start: "HH:MM", end: "HH:MM"}, masing-masing opsional
+    ARG_DATE_TIME   // {year, month, day, dayOfWeek, hour, minute, second}
+};
+
+/** @brief Syarat state sebelum command di-apply (dicek di loop()) */
+enum CommandGate : uint8_t
+{
+    GATE_NONE,
+    GATE_TIMER_ON,       // timer.on
+    GATE_TIMER_CONFIRMED // timer.confirmed (semua fitur)
+};
+
+struct CommandSpec
+{
+    CommandType type;
+    const char *name;   // Nama di JSON {"command": ...}
+    CommandArg arg;
+    const char *field;  // ARG_FIELD: key di dalam value
+    int32_t min;        // ARG_INT: rentang valid (inklusif)
+    int32_t max;
+    uint8_t binarySize; // Panjang payload frame biner (tanpa opcode)
+    CommandGate gate;
+    bool latestWins;    // Slider: di antrian hanya nilai terakhir yang di-apply
+};
+
+/** @brief FNV-1a 32-bit, constexpr supaya bisa dipakai sebagai label case */
+constexpr uint32_t commandHash(const char *name, uint32_t hash = 2166136261u)
+{
+    return *name ? commandHash(name + 1, (hash ^ (uint8_t)*name) * 16777619u) : hash;
+}
+
+const CommandSpec &commandSpec(CommandType type); // CMD_UNKNOWN jika type tidak valid
+const char *commandName(CommandType type);
+
+// Nama tidak harus diakhiri '\0' (bisa langsung dari buffer JSON)
+CommandType lookupCommand(const char *name, size_t len);
+
+/**
+ * @brief Cari command di JSON mentah tanpa parse penuh dan tanpa heap.
+ * @return CMD_UNKNOWN jika objek level atas tidak punya key "command" string atau namanya
+ *         tidak terdaftar; name/nameLen menunjuk ke nama di buffer (untuk log)
+ */
+CommandType scanJsonCommand(const uint8_t *data, size_t len, const char *&name, size_t &nameLen);
+
+/** @brief Cek rentang argumen sesuai skema (dipakai parser JSON & biner) */
+bool validateCommand(const SwellCommand &command);
@@ -0,0 +1,150 @@
+/**
+ * @file hal.h
+ * @brief Swell Smart Lamp - Hardware Abstraction Layer
+ *
+ * Interface tipis di atas semua periferal yang dipakai firmware (LEDC PWM,
+ * GPIO, DS3231 RTC, millis/delay, DFPlayer, NVS Preferences, WebSocket, WiFi).
+ * Logic scheduler & command path di swell_core.cpp hanya bicara ke `hal`,
+ * sehingga bisa dijalankan di ESP32 (hal_esp32.cpp) maupun di Linux
+ * (hal_native.cpp, env:native) untuk profiling dengan perf/valgrind.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// =================================================================
+// PERIPHERAL INTERFACES
+// =================================================================
+
+/** @brief LEDC PWM channel output (ledcWrite + unit fade hardware) */
+class PwmOutput
+{
+public:
+    virtual ~PwmOutput() = default;
+    virtual void write(uint8_t channel, uint32_t duty) = 0;
+    // Fade linear ke duty dalam durationMs, berjalan di hardware (tidak
+    // menunggu). Sampai selesai, write/fade lain ke channel yang sama akan
+    // menunggu di ESP32, jadi pemanggil harus menjaga jaraknya sendiri.
+    virtual void fade(uint8_t channel, uint32_t duty, uint32_t durationMs) = 0;
+};
+
+/** @brief Digital GPIO output (digitalWrite / digitalRead) */
+class DigitalOutput
+{
+public:
+    virtual ~DigitalOutput() = default;
+    virtual void write(uint8_t pin, bool high) = 0;
+    virtual bool read(uint8_t pin) = 0;
+};
+
+/** @brief Real-time clock (DS3231 via uRTCLib) - year() adalah 2 digit (0-99) */
+class RtcClock
+{
+public:
+    virtual ~RtcClock() = default;
+    virtual bool refresh() = 0;
+    virtual bool lostPower() = 0;
+    virtual void lostPowerClear() = 0;
+    virtual void set(uint8_t second, uint8_t minute, uint8_t hour, uint8_t dayOfWeek,
+                     uint8_t day, uint8_t month, uint8_t year) = 0;
+    virtual bool enableSecondPulse() = 0; // Output SQW 1 Hz (tepi turun = detik baru)
+
+    virtual uint8_t year() = 0;
+    virtual uint8_t month() = 0;
+    virtual uint8_t day() = 0;
+    virtual uint8_t dayOfWeek() = 0;
+    virtual uint8_t hour() = 0;
+    virtual uint8_t minute() = 0;
+    virtual uint8_t second() = 0;
+};
+
+/** @brief Monotonic system time (millis / delay) */
+class SystemClock
+{
+public:
+    virtual ~SystemClock() = default;
+    virtual unsigned long millis() = 0;
+    virtual void delay(unsigned long ms) = 0;
+};
+
+/**
+ * @brief UART ke MP3 player module (DFPlayer Mini), non-blocking.
+ *        Protokol frame ada di audio_driver.cpp.
+ */
+class AudioSerial
+{
+public:
+    virtual ~AudioSerial() = default;
+    virtual void begin() = 0;                                   // Buka UART 9600 8N1
+    virtual size_t write(const uint8_t *data, size_t len) = 0; // Tidak menunggu balasan
+    virtual int read() = 0;                                     // -1 jika belum ada byte
+};
+
+/** @brief Persistent key-value store (NVS Preferences) */
+class KeyValueStore
+{
+public:
+    virtual ~KeyValueStore() = default;
+    virtual bool begin(const char *name, bool readOnly) = 0;
+    virtual void end() = 0;
+    virtual bool isKey(const char *key) = 0;
+    virtual size_t putBytes(const char *key, const void *value, size_t len) = 0;
+    virtual size_t getBytes(const char *key, void *buf, size_t maxLen) = 0;
+    virtual bool remove(const char *key) = 0;
+};
+
+struct SocketClientInfo
+{
+    uint32_t id;
+    size_t queued; // Pesan yang masih mengantri di client (AsyncWebSocketClient::queueLen)
+};
+
+/** @brief WebSocket text ke sebagian/semua client (AsyncWebSocket), lihat socket_fanout.h */
+class SocketBroadcaster
+{
+public:
+    virtual ~SocketBroadcaster() = default;
+    // Mengisi maksimal max client yang terhubung, return jumlah total
+    virtual size_t listClients(SocketClientInfo *clients, size_t max) = 0;
+    // Satu buffer dipakai bersama oleh semua client tujuan
+    virtual void textTo(const uint32_t *clientIds, size_t count, const char *message, size_t len) = 0;
+};
+
+/**
+ * @brief WiFi station (WiFi.begin / disconnect), non-blocking. Event link
+ *        (connected, got IP, disconnected) dilaporkan ke wifi_manager.h.
+ */
+class WifiLink
+{
+public:
+    virtual ~WifiLink() = default;
+    virtual void begin() = 0; // Mode STA, tanpa auto-reconnect bawaan
+    // bssid + channel dari cache = tanpa scan semua channel; bssid null = scan
+    virtual void connect(const char *ssid, const char *password, const uint8_t *bssid, uint8_t channel) = 0;
+    virtual void disconnect() = 0;
+    virtual int rssi() = 0; // dBm, 0 jika tidak terhubung
+};
+
+// =================================================================
+// HAL INSTANCE
+// =================================================================
+
+/**
+ * @brief Kumpulan periferal aktif. Didefinisikan oleh hal_esp32.cpp
+ *        (firmware) atau hal_native.cpp (env:native).
+ */
+struct Hal
+{
+    PwmOutput *pwm;
+    DigitalOutput *gpio;
+    RtcClock *rtc;
+    SystemClock *clock;
+    AudioSerial *audio;
+    KeyValueStore *store;
+    SocketBroadcaster *sockets;
+    WifiLink *wifi;
+};
+
+extern Hal hal;
@@ -0,0 +1,197 @@
+/**
+ * @file hal_native.h
+ * @brief Swell Smart Lamp - Fake hal.h untuk env:native (Linux)
+ *
+ * Semua fake deterministik: waktu hanya maju lewat FakeSystemClock::advance()
+ * atau delay(), RTC mengikuti system clock, dan setiap akses "hardware"
+ * dihitung supaya benchmark bisa membandingkan jumlah write per skenario.
+ */
+
+#pragma once
+
+#ifndef ARDUINO
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "hal.h"
+
+/** @brief Fade langsung dianggap selesai; write selama fade dihitung sebagai konflik */
+class FakePwmOutput : public PwmOutput
+{
+public:
+    explicit FakePwmOutput(SystemClock &clock) : clock(clock) {}
+
+    void write(uint8_t channel, uint32_t duty) override;
+    void fade(uint8_t channel, uint32_t duty, uint32_t durationMs) override;
+
+    uint32_t duty[16] = {};
+    unsigned long writes = 0;
+    unsigned long fades = 0;
+    unsigned long conflicts = 0; // Di ESP32 akan menunggu fade sebelumnya selesai
+
+private:
+    void checkIdle(uint8_t channel);
+
+    SystemClock &clock;
+    unsigned long fadeEnd[16] = {};
+};
+
+class FakeDigitalOutput : public DigitalOutput
+{
+public:
+    void write(uint8_t pin, bool high) override;
+    bool read(uint8_t pin) override;
+
+    bool level[40] = {};
+    unsigned long writes = 0;
+};
+
+class FakeSystemClock : public SystemClock
+{
+public:
+    unsigned long millis() override { return (unsigned long)now; } // Wrap 2^32 seperti ESP32 di env:native32
+    void delay(unsigned long ms) override { now += ms; }
+    void advance(unsigned long ms) { now += ms; }
+
+    unsigned long long now = 0; // Waktu simulasi sebenarnya (tidak pernah wrap)
+};
+
+/** @brief RTC yang berjalan mengikuti FakeSystemClock (detik sejak 2000-01-01) */
+class FakeRtcClock : public RtcClock
+{
+public:
+    explicit FakeRtcClock(FakeSystemClock &clock) : clock(clock) {}
+
+    bool refresh() override;
+    bool lostPower() override { return powerLost; }
+    void lostPowerClear() override { powerLost = false; }
+    void set(uint8_t second, uint8_t minute, uint8_t hour, uint8_t dayOfWeek,
+             uint8_t day, uint8_t month, uint8_t year) override;
+    bool enableSecondPulse() override { return false; }
+
+    uint8_t year() override { return yearValue; }
+    uint8_t month() override { return monthValue; }
+    uint8_t day() override { return dayValue; }
+    uint8_t dayOfWeek() override { return dayOfWeekValue; }
+    uint8_t hour() override { return hourValue; }
+    uint8_t minute() override { return minuteValue; }
+    uint8_t second() override { return secondValue; }
+
+    bool powerLost = false;
+    long driftPpm = 0; // RTC lebih cepat (+) / lambat (-) dari FakeSystemClock
+    unsigned long refreshes = 0;
+
+private:
+    FakeSystemClock &clock;   // RTC hardware terpisah: ikut waktu sebenarnya, bukan millis()
+    long long epochAtSet = 0; // Detik sejak 2000-01-01 saat set()
+    unsigned long long nowAtSet = 0;
+
+    uint8_t yearValue = 0, monthValue = 1, dayValue = 1, dayOfWeekValue = 7;
+    uint8_t hourValue = 0, minuteValue = 0, secondValue = 0;
+};
+
+/** @brief DFPlayer palsu: decode frame, langsung membalas ACK / "card online" */
+class FakeAudioSerial : public AudioSerial
+{
+public:
+    void begin() override {}
+    size_t write(const uint8_t *data, size_t len) override;
+    int read() override;
+
+    bool present = true; // false = modul tidak membalas sama sekali
+    bool playing = false;
+    int track = 0;
+    int level = 0;
+    unsigned long commands = 0; // Frame play/stop/volume/EQ yang diterima
+
+private:
+    void reply(uint8_t command, uint16_t param);
+
+    std::deque<uint8_t> rx;
+};
+
+class FakeKeyValueStore : public KeyValueStore
+{
+public:
+    bool begin(const char *name, bool readOnly) override;
+    void end() override { opened = false; }
+    bool isKey(const char *key) override;
+    size_t putBytes(const char *key, const void *value, size_t len) override;
+    size_t getBytes(const char *key, void *buf, size_t maxLen) override;
+    bool remove(const char *key) override;
+
+    std::map<std::string, std::vector<uint8_t>> entries;
+    unsigned long writes = 0;
+    unsigned long bytesWritten = 0;
+    bool failWrites = false; // putBytes() gagal (flash penuh / rusak)
+
+private:
+    std::string ns;
+    bool opened = false;
+    bool readOnly = true;
+};
+
+struct FakeSocketClient
+{
+    uint32_t id;
+    unsigned long drainPerSecond = 0; // Pesan yang terkirim per detik, 0 = antrian langsung kosong
+    size_t queued = 0;
+    unsigned long received = 0;
+    unsigned long drainCredit = 0; // Sisa (pesan x ms) dari drain() sebelumnya
+};
+
+class FakeSocketBroadcaster : public SocketBroadcaster
+{
+public:
+    size_t listClients(SocketClientInfo *clients, size_t max) override;
+    void textTo(const uint32_t *clientIds, size_t count, const char *message, size_t len) override;
+    void drain(unsigned long elapsedMs); // Simulasi TCP mengosongkan antrian tiap client
+
+    std::vector<FakeSocketClient> clients{FakeSocketClient{1}};
+    std::string lastMessage;
+    bool keepLastMessage = true;
+    unsigned long messages = 0;   // Panggilan textTo (buffer)
+    unsigned long deliveries = 0; // Pesan per client
+    unsigned long bytesSent = 0;  // Byte di jaringan (semua client)
+};
+
+/**
+ * @brief AP palsu: connect() langsung berhasil (event CONNECTED + GOT_IP)
+ *        selama accessPointUp, gagal "no AP found" jika tidak
+ */
+class FakeWifiLink : public WifiLink
+{
+public:
+    void begin() override {}
+    void connect(const char *ssid, const char *password, const uint8_t *bssid, uint8_t channel) override;
+    void disconnect() override;
+    int rssi() override { return linked ? -55 : 0; }
+    void setAccessPoint(bool up); // false = router mati (link putus, beacon timeout)
+
+    bool accessPointUp = true;
+    uint8_t accessPointBssid[6] = {0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56};
+    uint8_t accessPointChannel = 6;
+    bool linked = false;
+    unsigned long scans = 0;       // connect() tanpa BSSID
+    unsigned long directJoins = 0; // connect() dengan BSSID + channel
+};
+
+/** @brief Akses langsung ke fake yang dipasang di `hal` */
+struct NativeFakes
+{
+    FakeSystemClock clock;
+    FakePwmOutput pwm{clock};
+    FakeDigitalOutput gpio;
+    FakeRtcClock rtc{clock};
+    FakeAudioSerial audio;
+    FakeKeyValueStore store;
+    FakeSocketBroadcaster sockets;
+    FakeWifiLink wifi;
+};
+
+extern NativeFakes nativeFakes;
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * @file json_writer.h
+ * @brief Swell Smart Lamp - Serializer JSON streaming ke buffer tetap (tanpa heap)
+ *
+ * Dipakai untuk semua pesan keluar (clockSync, playlist, rtcCalibrated,
+ * status). Pesan ditulis langsung ke buffer milik pemanggil, tanpa
+ * JsonDocument dan tanpa String, lalu di-broadcast sekali ke semua client
+ * (atau dengan sendJson() hanya ke client yang bertanya):
+ *
+ *   char buffer[OUTBOUND_JSON_CAPACITY];
+ *   JsonWriter json(buffer, sizeof(buffer));
+ *   json.beginObject().add("type", "clockSync").endObject();
+ *   broadcastJson(json);
+ *
+ * Jika buffer tidak cukup, overflowed() bernilai true dan pesan dibuang
+ * (tidak pernah mengirim JSON terpotong).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+const size_t OUTBOUND_JSON_CAPACITY = 1024; // Pesan terbesar: playlist (~550 byte)
+const int JSON_WRITER_MAX_DEPTH = 8;
+
+class JsonWriter
+{
+public:
+    JsonWriter(char *buffer, size_t capacity);
+
+    // key == nullptr untuk elemen array / root
+    JsonWriter &beginObject(const char *key = nullptr);
+    JsonWriter &endObject();
+    JsonWriter &beginArray(const char *key = nullptr);
+    JsonWriter &endArray();
+
+    JsonWriter &add(const char *key, const char *value);
+    JsonWriter &add(const char *key, bool value);
+    JsonWriter &add(const char *key, int value);
+    JsonWriter &add(const char *key, unsigned int value);
+    JsonWriter &add(const char *key, long value);
+    JsonWriter &add(const char *key, unsigned long value);
+    JsonWriter &add(const char *key, long long value); // Epoch ms (> 32 bit)
+
+    const char *c_str() const { return buffer; }
+    size_t length() const { return len; }
+    bool overflowed() const { return overflow; }
+
+private:
+    void separator(const char *key);
+    void open(char bracket, const char *key);
+    void close(char bracket);
+    void putChar(char c);
+    void putRaw(const char *text, size_t count);
+    void putString(const char *text);
+
+    char *buffer;
+    size_t capacity;
+    size_t len = 0;
+    bool overflow = false;
+    int depth = 0;
+    bool hasItems[JSON_WRITER_MAX_DEPTH] = {};
+};
+
+void sendJson(const JsonWriter &json, uint32_t clientId); // Lewat socket_fanout.h, SOCKET_ALL_CLIENTS = semua
+void broadcastJson(const JsonWriter &json);                // sendJson(json, SOCKET_ALL_CLIENTS)
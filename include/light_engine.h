@@ -0,0 +1,66 @@
+/**
+ * @file light_engine.h
+ * @brief Swell Smart Lamp - Lampu LED: dimming perseptual + fade di hardware LEDC
+ *
+ * - Kecerahan dinyatakan dalam level perseptual 0..LIGHT_LEVEL_MAX
+ *   (intensitas 0-100% dari slider). Level -> duty lewat tabel CIE 1931
+ *   L* yang dihitung saat compile untuk SWELL_PWM_RESOLUTION, jadi ujung
+ *   redup punya ratusan langkah, bukan 0-10 duty linear.
+ * - Perpindahan putih <-> kuning di tepi jendela timer menjadi fade
+ *   sunset/sunrise (LIGHT_SUNSET_FADE_MS); slider dan on/off memakai fade
+ *   singkat LIGHT_ADJUST_FADE_MS.
+ * - Fade dijalankan unit fade LEDC per segmen <= LIGHT_FADE_SEGMENT_MS
+ *   (kurva perseptual didekati piecewise-linear). loop() hanya bangun di
+ *   batas segmen; di antaranya tidak ada CPU yang dipakai.
+ * - Di ESP32 perubahan duty selama fade berjalan menunggu fade selesai,
+ *   jadi target baru ditahan sampai segmen yang berjalan habis, supaya
+ *   loop() tidak pernah terblokir.
+ *
+ * Hanya dipanggil dari loop().
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Kecerahan maksimum dalam duty 8 bit lama (PWM 100 Hz / 8 bit, putih = 10).
+// Dipertahankan supaya daya LED tidak berubah; naikkan lewat -D jika perlu
+#ifndef SWELL_LED_MAX_DUTY_8BIT
+#define SWELL_LED_MAX_DUTY_8BIT 10
+#endif
+
+// Durasi sunset (masuk jendela timer) dan sunrise (keluar jendela)
+#ifndef SWELL_LIGHT_SUNSET_MS
+#define SWELL_LIGHT_SUNSET_MS 300000UL
+#endif
+
+const uint16_t LIGHT_LEVEL_MAX = 255;
+const unsigned long LIGHT_SUNSET_FADE_MS = SWELL_LIGHT_SUNSET_MS;
+const unsigned long LIGHT_ADJUST_FADE_MS = 400;   // Slider intensitas, lampu on/off
+const unsigned long LIGHT_FADE_SEGMENT_MS = 4000; // Target baru menunggu paling lama selama ini
+const unsigned long LIGHT_NO_DEADLINE = 0xFFFFFFFFUL;
+
+enum LightChannel : uint8_t
+{
+    LIGHT_WHITE,
+    LIGHT_YELLOW,
+    LIGHT_CHANNEL_COUNT
+};
+
+struct LightStats
+{
+    unsigned long scenes = 0;   // setLightScene() yang mengubah target
+    unsigned long segments = 0; // Fade hardware yang dimulai
+    unsigned long deferred = 0; // Target baru ditahan karena segmen masih berjalan
+};
+
+uint16_t lightLevelForIntensity(int percent); // 0-100% -> level perseptual
+uint32_t lightDuty(uint16_t level);           // Level -> duty LEDC (tabel gamma)
+
+void setLightScene(uint16_t whiteLevel, uint16_t yellowLevel, unsigned long fadeMs);
+uint16_t lightLevel(LightChannel channel); // Level target
+
+void serviceLight();                     // Mulai segmen fade berikutnya, panggil dari loop()
+unsigned long millisUntilLightService(); // LIGHT_NO_DEADLINE jika tidak ada fade
+
+const LightStats &lightStats();
@@ -0,0 +1,73 @@
+/**
+ * @file metrics.h
+ * @brief Swell Smart Lamp - Instrumentasi runtime (GET /metrics + command getMetrics)
+ *
+ * Sebagian besar angka sudah dihitung modul lain (commandQueueStats(),
+ * audioDriverStats(), socketFanoutStats(), ...) dan hanya dibaca saat
+ * scrape, jadi jalur panas tidak bertambah kerja. Yang dicatat di sini:
+ *
+ * - durasi satu iterasi loop() (histogram, mikrodetik)
+ * - latensi ACK DFPlayer (histogram, milidetik)
+ * - latensi reconnect WiFi, link putus -> IP lagi (histogram, milidetik)
+ * - pesan / byte WebSocket masuk dan yang gagal di-parse
+ *
+ * Data yang hanya ada di firmware (heap, request HTTP per route)
+ * ditambahkan main.cpp lewat setPlatformMetrics().
+ *
+ * Satu daftar metric, dua format: teks Prometheus 0.0.4 dan JSON
+ * {"type":"metrics", ...} untuk client yang mengirim getMetrics.
+ * Scrape HTTP berjalan di task AsyncTCP dan membaca counter tanpa lock;
+ * nilainya bisa tertinggal satu iterasi loop(), tidak pernah rusak.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+const size_t HISTOGRAM_MAX_BOUNDS = 8;
+const size_t METRICS_JSON_CAPACITY = 4096; // getMetrics: ~3 KB dengan 8 route statis
+
+/** @brief Histogram bucket tetap; record() hanya dari satu task */
+struct Histogram
+{
+    Histogram(const uint32_t *bounds, size_t boundCount);
+
+    void record(uint32_t value);
+
+    const uint32_t *bounds; // Batas atas (le) naik; bucket terakhir = +Inf
+    size_t boundCount;
+    unsigned long buckets[HISTOGRAM_MAX_BOUNDS + 1] = {}; // Tidak kumulatif
+    unsigned long count = 0;
+    uint64_t sum = 0;
+};
+
+/** @brief Tujuan metric (teks Prometheus atau JSON) */
+class MetricsWriter
+{
+public:
+    virtual ~MetricsWriter() = default;
+
+    // label / labelValue opsional; seri berlabel dengan nama sama ditulis berurutan
+    virtual void counter(const char *name, const char *help, unsigned long value,
+                         const char *label = nullptr, const char *labelValue = nullptr) = 0;
+    virtual void gauge(const char *name, const char *help, long value,
+                       const char *label = nullptr, const char *labelValue = nullptr) = 0;
+    virtual void histogram(const char *name, const char *help, const Histogram &histogram) = 0;
+};
+
+typedef void (*MetricsSection)(MetricsWriter &out);
+typedef void (*MetricsTextSink)(void *context, const char *text, size_t len);
+
+// Jalur panas
+void recordLoopIteration(unsigned long busyUs);
+void recordAudioAckLatency(unsigned long ms);
+void recordWifiReconnect(unsigned long ms);
+void recordWebSocketIn(size_t len, bool parsed);
+
+void setPlatformMetrics(MetricsSection section);
+void writeMetrics(MetricsWriter &out);
+
+void writeMetricsText(MetricsTextSink sink, void *context); // Prometheus text format 0.0.4
+size_t writeMetricsText(char *buffer, size_t capacity);     // 0 jika buffer tidak cukup
+void sendMetrics(uint32_t clientId);                        // JSON ke client penanya
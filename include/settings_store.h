@@ -0,0 +1,100 @@
+/**
+ * @file settings_store.h
+ * @brief Swell Smart Lamp - Write-behind persistence untuk UserSettings
+ *
+ * Command WebSocket hanya menandai settings "dirty". Flush ke NVS dilakukan
+ * dari loop() setelah tidak ada perubahan selama SETTINGS_FLUSH_QUIET_MS,
+ * atau paling lambat SETTINGS_FLUSH_DEADLINE_MS sejak perubahan pertama.
+ * Flush dilewati jika isi settings sama dengan yang terakhir tersimpan.
+ *
+ * =================================================================
+ * FORMAT RECORD (NVS key "settings")
+ * =================================================================
+ *
+ *   [0..1] magic 'S','W'
+ *   [2]    version record
+ *   [3]    N = panjang payload
+ *   [4..]  payload N byte (lihat SettingsField)
+ *   [+2]   CRC-16/CCITT (little-endian) atas semua byte sebelumnya
+ *
+ * Field hanya boleh DITAMBAH di akhir payload, arti field yang sudah ada
+ * tidak pernah diubah (butuh arti baru = field baru). Dengan aturan ini
+ * record lama yang lebih pendek tetap terbaca (field baru memakai default)
+ * dan record dari firmware lebih baru tetap terbaca prefix-nya, tanpa
+ * menaikkan versi.
+ *
+ * SETTINGS_RECORD_VERSION hanya dinaikkan untuk perubahan yang melanggar
+ * aturan di atas. Firmware lama menolak record versi lebih baru
+ * (SETTINGS_DECODE_NEWER_VERSION) dan TIDAK menimpanya, supaya settings
+ * kembali utuh setelah upgrade lagi. Selama itu settings firmware lama
+ * disimpan dan dibaca dari key "settingsCompat" (default jika belum ada),
+ * jadi perubahan user setelah downgrade tidak hilang saat reboot.
+ * Format lama (v1, dump mentah sizeof(UserSettings) di key "userSettings")
+ * dimigrasi otomatis saat boot.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct UserSettings;
+
+const unsigned long SETTINGS_FLUSH_QUIET_MS = 2000;     // Jeda tanpa perubahan sebelum flush
+const unsigned long SETTINGS_FLUSH_DEADLINE_MS = 10000; // Batas maksimal data dirty di RAM
+const unsigned long SETTINGS_NO_FLUSH_PENDING = 0xFFFFFFFFUL;
+
+const uint8_t SETTINGS_RECORD_VERSION = 2;
+const size_t SETTINGS_RECORD_HEADER_SIZE = 4;
+const size_t SETTINGS_RECORD_CRC_SIZE = 2;
+const size_t SETTINGS_RECORD_MAX_SIZE = 32;
+
+/** @brief Offset field di dalam payload record (append-only) */
+enum SettingsField : uint8_t
+{
+    FIELD_FLAGS = 0, // bit0 timer.on, bit1 timer.confirmed, bit2 aroma, bit3 alarm, bit4 music
+    FIELD_TIMER_START_HOUR,
+    FIELD_TIMER_START_MINUTE,
+    FIELD_TIMER_END_HOUR,
+    FIELD_TIMER_END_MINUTE,
+    FIELD_LIGHT_INTENSITY,
+    FIELD_MUSIC_TRACK,
+    FIELD_MUSIC_VOLUME,
+    SETTINGS_PAYLOAD_SIZE
+};
+
+enum SettingsDecodeResult
+{
+    SETTINGS_DECODE_OK,
+    SETTINGS_DECODE_TRUNCATED,
+    SETTINGS_DECODE_BAD_MAGIC,
+    SETTINGS_DECODE_BAD_CRC,
+    SETTINGS_DECODE_BAD_VERSION,  // Versi < 2: tidak pernah ditulis firmware mana pun
+    SETTINGS_DECODE_NEWER_VERSION // Dari firmware lebih baru: jangan ditimpa
+};
+
+struct SettingsPersistenceStats
+{
+    unsigned long changeRequests = 0;         // Jumlah markUserSettingsDirty()
+    unsigned long flashWrites = 0;            // Jumlah putBytes ke NVS yang berhasil
+    unsigned long writeFailures = 0;          // begin()/putBytes() gagal, settings tetap dirty
+    unsigned long writesCoalesced = 0;        // Perubahan yang digabung ke flush berikutnya
+    unsigned long writesSkippedUnchanged = 0; // Flush yang dilewati karena isi sama
+    unsigned long compatWrites = 0;           // ... ke key "settingsCompat" (record versi lebih baru di flash)
+};
+
+// ⭐ FIXED: Settings management dengan user settings
+bool saveUserSettings(); // Tulis langsung ke flash; false = gagal, tetap dirty untuk dicoba lagi
+void loadUserSettings();
+
+void markUserSettingsDirty();
+void serviceUserSettingsPersistence(); // Dipanggil dari loop()
+void flushUserSettings();              // Paksa flush jika dirty
+unsigned long millisUntilUserSettingsFlush(); // SETTINGS_NO_FLUSH_PENDING jika tidak dirty
+bool userSettingsDirty();
+const SettingsPersistenceStats &userSettingsPersistenceStats();
+
+// Record codec (pure, tanpa akses NVS)
+uint16_t settingsCrc16(const uint8_t *data, size_t len);
+size_t encodeSettingsRecord(const UserSettings &settings, uint8_t *out, size_t capacity);
+SettingsDecodeResult decodeSettingsRecord(const uint8_t *data, size_t len, UserSettings &settings);
@@ -0,0 +1,52 @@
+/**
+ * @file socket_fanout.h
+ * @brief Swell Smart Lamp - Pengiriman WebSocket per client (balasan terarah + backpressure)
+ *
+ * Semua pesan keluar lewat sini (broadcastJson / sendJson / notifyClients):
+ *
+ * - Balasan query (getStatus, getPlaylist, getClockSync, hello,
+ *   rtc-calibrate) hanya dikirim ke client yang bertanya.
+ * - Broadcast memakai satu buffer bersama untuk semua client, jadi biaya
+ *   per pesan tidak naik dengan jumlah dashboard.
+ * - Client yang antrian kirimnya >= SOCKET_QUEUE_LIMIT dilewati (pesan
+ *   dibuang untuk client itu saja), supaya HP yang lambat tidak sampai
+ *   diputus AsyncWebSocket (WS_MAX_QUEUED_MESSAGES).
+ * - Status lebih ketat (SOCKET_STATUS_QUEUE_LIMIT): patch untuk client
+ *   lambat dilewati dan client ditandai; begitu antriannya longgar ia
+ *   menerima satu snapshot terbaru sebagai ganti semua patch yang
+ *   terlewat (drop-oldest).
+ *
+ * Hanya dipanggil dari loop().
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+const size_t SOCKET_MAX_CLIENTS = 16;       // ws.cleanupClients() membatasi 8, sisanya untuk client yang belum dibersihkan
+const size_t SOCKET_STATUS_QUEUE_LIMIT = 4; // Status dilewati jika antrian client sudah sepanjang ini
+const size_t SOCKET_QUEUE_LIMIT = 16;       // Pesan lain dibuang di sini (AsyncWebSocket memutus client di 32)
+const uint32_t SOCKET_ALL_CLIENTS = 0;      // Id client AsyncWebSocket mulai dari 1
+
+struct SocketFanoutStats
+{
+    unsigned long broadcasts = 0;
+    unsigned long replies = 0;       // Pesan ke satu client
+    unsigned long deliveries = 0;    // Pesan x client tujuan
+    unsigned long bytesOut = 0;      // Byte payload x client tujuan
+    unsigned long dropped = 0;       // Dilewati karena antrian >= SOCKET_QUEUE_LIMIT
+    unsigned long statusSkipped = 0; // Status dilewati untuk client lambat
+    unsigned long resyncs = 0;       // Snapshot pengganti status yang terlewat
+    size_t clients = 0;              // Saat pengiriman terakhir
+    size_t queueDepth = 0;           // Antrian terpanjang saat pengiriman terakhir
+    size_t queueHighWater = 0;
+};
+
+// Menulis statusUpdate lengkap ke buffer, return panjangnya (0 jika gagal)
+typedef size_t (*StatusSnapshotWriter)(char *buffer, size_t capacity);
+
+void sendToClients(uint32_t clientId, const char *message, size_t len); // SOCKET_ALL_CLIENTS = broadcast
+void sendStatusToClients(const char *message, size_t len, StatusSnapshotWriter writeSnapshot);
+
+const SocketFanoutStats &socketFanoutStats();
@@ -0,0 +1,35 @@
+/**
+ * @file status_broadcast.h
+ * @brief Swell Smart Lamp - Delta status broadcast (statusUpdate / statusPatch)
+ *
+ * Snapshot status terakhir yang di-broadcast disimpan. notifyClients()
+ * hanya mengirim field yang berubah sebagai "statusPatch". Setiap pesan
+ * status membawa `seq` yang naik satu per pesan:
+ *
+ *   {"type":"statusUpdate","seq":7,"state":{...},"executionState":{...}}
+ *   {"type":"statusPatch","seq":8,"state":{"music":{"volume":60}}}
+ *   {"type":"statusSeq","seq":8}   // tidak ada perubahan (heartbeat)
+ *
+ * Client yang melihat lompatan seq (pesan hilang / baru connect) meminta
+ * resync penuh dengan command "getStatus"; jawabannya hanya dikirim ke
+ * client itu. Client yang antriannya penuh dilewati dan menerima snapshot
+ * saat antriannya longgar (socket_fanout.h).
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+struct StatusBroadcastStats
+{
+    unsigned long fullUpdates = 0;
+    unsigned long patches = 0;
+    unsigned long heartbeats = 0;
+    unsigned long fieldsSent = 0;
+    unsigned long fieldsSuppressed = 0; // Field yang tidak dikirim karena tidak berubah
+};
+
+void notifyClients();                        // Patch (atau heartbeat) ke semua client
+void sendStatusSnapshot(uint32_t clientId); // statusUpdate lengkap, seq saat ini
+uint32_t currentStatusSeq();
+const StatusBroadcastStats &statusBroadcastStats();
@@ -0,0 +1,176 @@
+/**
+ * @file swell_core.h
+ * @brief Swell Smart Lamp - Core logic (settings, scheduler, command path)
+ *
+ * Semua logic yang tidak bergantung langsung ke Arduino/ESP-IDF: user
+ * settings, execution state, scheduler, music/aromatherapy/alarm dan
+ * WebSocket command handling. Periferal diakses lewat `hal` (hal.h),
+ * sehingga file ini dipakai bersama oleh firmware dan env:native.
+ */
+
+#pragma once
+
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "command_queue.h"
+#include "hal.h"
+
+// =================================================================
+// KONFIGURASI HARDWARE
+// =================================================================
+
+const int WHITE_LED_PIN = 12;
+const int YELLOW_LED_PIN = 14;
+const int AROMATHERAPY_PIN = 4;
+const int DFPLAYER_RX_PIN = 16;
+const int DFPLAYER_TX_PIN = 17;
+
+const int PWM_CHANNEL_WHITE = 0;
+const int PWM_CHANNEL_YELLOW = 1;
+
+// LEDC: 1 kHz tidak terlihat berkedip (juga di kamera HP), 16 bit memberi
+// langkah halus di ujung redup kurva gamma (lihat light_engine.h).
+// Batas LEDC: frekuensi x 2^resolusi <= 80 MHz (APB)
+#ifndef SWELL_PWM_FREQUENCY
+#define SWELL_PWM_FREQUENCY 1000
+#endif
+#ifndef SWELL_PWM_RESOLUTION
+#define SWELL_PWM_RESOLUTION 16
+#endif
+
+const int PWM_FREQUENCY = SWELL_PWM_FREQUENCY;
+const int PWM_RESOLUTION = SWELL_PWM_RESOLUTION;
+
+// =================================================================
+// FIXED PLAYLIST CONFIGURATION
+// =================================================================
+
+struct MusicTrack
+{
+    int trackNumber;
+    const char *title;
+    const char *filename;
+};
+
+extern const MusicTrack RELAX_PLAYLIST[];
+extern const int RELAX_PLAYLIST_SIZE;
+const int ALARM_TRACK_NUMBER = 5;
+
+// =================================================================
+// ⭐ FIXED: NEW SETTINGS STRUCTURE - SEPARATED USER CONFIG & EXECUTION STATE
+// =================================================================
+
+/**
+ * @brief User Settings - Persistent configuration yang disimpan di flash
+ * @note Ini adalah konfigurasi user yang TIDAK berubah otomatis oleh scheduler
+ */
+struct UserSettings
+{
+    struct Timer
+    {
+        bool on = false;        // Timer toggle ON/OFF
+        bool confirmed = false; // Timer sudah dikonfirmasi
+        int startHour = 21;     // Jam mulai sleep phase
+        int startMinute = 0;    // Menit mulai sleep phase
+        int endHour = 4;        // Jam selesai sleep phase
+        int endMinute = 0;      // Menit selesai sleep phase
+    } timer;
+
+    struct Light
+    {
+        int intensity = 50; // Yellow light intensity 0-100%
+    } light;
+
+    // ⭐ FIXED: User scenario settings (TIDAK auto-disable)
+    struct Aromatherapy
+    {
+        bool enabled = false; // User setting: apakah aromatherapy akan aktif saat timer?
+    } aromatherapy;
+
+    struct Alarm
+    {
+        bool enabled = false;                            // User setting: apakah alarm akan aktif?
+        static constexpr int track = ALARM_TRACK_NUMBER; // Fixed ke track 5 (tidak disimpan)
+    } alarm;
+
+    struct Music
+    {
+        bool enabled = false; // User setting: apakah music akan aktif saat timer?
+        int track = 1;        // Selected track
+        int volume = 15;      // Volume level 0-30
+    } music;
+};
+
+/**
+ * @brief Execution State - Runtime status hardware (TIDAK disimpan di flash)
+ * @note Ini adalah status real-time hardware yang berubah sesuai schedule
+ */
+struct ExecutionState
+{
+    // Hardware execution status (real-time, tidak persistent)
+    bool aromatherapyActive = false; // Apakah aromatherapy sedang jalan sekarang?
+    bool musicActive = false;        // Apakah music sedang play sekarang?
+    bool alarmActive = false;        // Apakah alarm sedang bunyi sekarang?
+
+    // Timing states
+    bool inTimerWindow = false;       // Apakah sekarang dalam timer window?
+    bool inMusicWindow = false;       // Apakah sekarang dalam music window (1 jam pertama)?
+    unsigned long musicStartTime = 0; // Kapan music mulai play
+    unsigned long aromaStartTime = 0; // Kapan aromatherapy mulai
+};
+
+struct ScheduleStats
+{
+    unsigned long runs = 0; // Jumlah checkAndApplySchedules() (deadline + command)
+};
+
+// ⭐ FIXED: Global instances
+extern UserSettings userSettings;     // User configuration (persistent)
+extern ExecutionState executionState; // Hardware state (runtime only)
+extern bool dfPlayerInitialized;
+
+// =================================================================
+// FUNCTION DECLARATIONS
+// =================================================================
+
+// Hardware initialization
+void checkAndSetRTC();
+bool initializeDFPlayer();
+
+// Music system
+void generateAndSendPlaylist(const char *knownEtag = nullptr, uint32_t clientId = 0); // knownEtag: versi milik client
+const char *playlistEtagString();
+int getValidMusicTrackNumber(int requestedTrack);
+void playMusicTrack(int trackNumber);
+void stopMusic();
+void setMusicVolume(int volume);
+
+// ⭐ FIXED: Scheduling system dengan execution state
+void checkAndApplySchedules(); // Jalankan sekarang + hitung deadline berikutnya
+void requestScheduleRun();     // Jalankan di serviceSchedules() berikutnya
+bool serviceSchedules();       // Dipanggil dari loop(): jalan hanya jika deadline tercapai
+unsigned long millisUntilNextSchedule();
+const ScheduleStats &scheduleStats();
+bool calculateInTimerWindow(int currentTime, int startTime, int endTime);
+bool isInMusicTimeWindow(int currentTimeInMinutes, int startTimeInMinutes);
+bool hasReached1HourLimit();
+
+// Aromatherapy system
+void handleAromatherapyExecution();
+void resetAromatherapy();
+
+// RTC system
+void sendClockSync(uint32_t token = 0, uint32_t clientId = 0); // token dikembalikan sebagai "echo", clientId 0 = semua
+void serviceClockSync();                // Push clockSync jika jam device melompat (kalibrasi)
+bool calibrateRTC(int year, int month, int day, int dayOfWeek, int hour, int minute, int second);
+
+// WebSocket communication
+// binary = frame WebSocket biner (binary_protocol.h), selain itu JSON
+// clientId = pengirim; balasan query hanya ke client itu (0 = semua client)
+bool parseCommand(const uint8_t *data, size_t len, SwellCommand &command);           // JSON, aman dari task mana pun
+void applyCommand(const SwellCommand &command);                                     // Hanya dari loop()
+void handleWebSocketMessage(const uint8_t *data, size_t len, bool binary = false, uint32_t clientId = 0); // Parse + apply langsung
+bool queueWebSocketMessage(const uint8_t *data, size_t len, bool binary = false, uint32_t clientId = 0);  // Parse + enqueue (AsyncTCP)
+void processCommandQueue();                                                         // Apply antrian (loop())
@@ -0,0 +1,122 @@
+/**
+ * @file swell_log.h
+ * @brief Swell Smart Lamp - Logging berlevel + ring buffer (ESP32 & native)
+ *
+ * Pemanggil tidak pernah menunggu UART:
+ *
+ * - SWELL_LOGE/W/I/D(tag, format, ...) memformat satu baris ke ring buffer
+ *   lock-free (multi-producer: loop(), task AsyncTCP, handler web) lalu
+ *   langsung kembali. Jika ring penuh, entri tertua ditimpa.
+ * - Di ESP32 task prioritas rendah (logBegin()) menguras ring ke Serial.
+ *   Di env:native baris langsung dicetak jika swellNativeLogEnabled.
+ * - Level di bawah SWELL_LOG_LEVEL (build flag) hilang saat compile,
+ *   termasuk string formatnya; format tetap dicek compiler.
+ * - Log terbaru bisa dibaca lewat WebSocket: command getLogs {"since": N}.
+ *
+ * Satu panggilan = satu baris (tanpa '\n' di format).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SWELL_LOG_LEVEL_NONE 0
+#define SWELL_LOG_LEVEL_ERROR 1
+#define SWELL_LOG_LEVEL_WARN 2
+#define SWELL_LOG_LEVEL_INFO 3
+#define SWELL_LOG_LEVEL_DEBUG 4
+
+#ifndef SWELL_LOG_LEVEL
+#define SWELL_LOG_LEVEL SWELL_LOG_LEVEL_INFO
+#endif
+
+const size_t LOG_RING_ENTRIES = 64; // Harus pangkat 2
+const size_t LOG_TEXT_MAX = 96;     // Termasuk '\0'; baris lebih panjang dipotong (batas UTF-8)
+
+enum LogTag : uint8_t
+{
+    LOG_SYS,      // Boot, power management
+    LOG_NET,      // WiFi
+    LOG_WEB,      // HTTP / SPIFFS
+    LOG_WS,       // WebSocket (koneksi, fan-out)
+    LOG_CMD,      // Command WebSocket
+    LOG_CLOCK,    // RTC, jam software
+    LOG_SETTINGS, // Persistence user settings
+    LOG_AUDIO,    // Driver DFPlayer
+    LOG_MUSIC,
+    LOG_AROMA,
+    LOG_ALARM,
+    LOG_LIGHT,
+    LOG_TAG_COUNT
+};
+
+/** @brief Salinan satu entri ring buffer */
+struct LogEntry
+{
+    uint32_t seq; // Naik terus sejak boot, dipakai sebagai cursor pembaca
+    uint32_t timeMs;
+    uint8_t level;
+    LogTag tag;
+    char text[LOG_TEXT_MAX];
+};
+
+struct LogStats
+{
+    unsigned long written = 0;   // Ditulis producer (bisa dari beberapa task, perkiraan)
+    unsigned long truncated = 0; // Baris lebih panjang dari LOG_TEXT_MAX
+    unsigned long lost = 0;      // Tertimpa sebelum sempat dikuras ke Serial / stdout
+};
+
+void swellLog(uint8_t level, LogTag tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+// Level yang di-strip: tidak pernah dipanggil, hanya supaya format & argumen tetap dicek
+inline void swellLogDiscard(LogTag, const char *, ...) __attribute__((format(printf, 2, 3)));
+inline void swellLogDiscard(LogTag, const char *, ...) {}
+
+#define SWELL_LOG_STRIPPED(tag, ...)                \
+    do                                              \
+    {                                               \
+        if (false)                                  \
+            swellLogDiscard(tag, __VA_ARGS__);      \
+    } while (0)
+
+#if SWELL_LOG_LEVEL >= SWELL_LOG_LEVEL_ERROR
+#define SWELL_LOGE(tag, ...) swellLog(SWELL_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#else
+#define SWELL_LOGE(tag, ...) SWELL_LOG_STRIPPED(tag, __VA_ARGS__)
+#endif
+
+#if SWELL_LOG_LEVEL >= SWELL_LOG_LEVEL_WARN
+#define SWELL_LOGW(tag, ...) swellLog(SWELL_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#else
+#define SWELL_LOGW(tag, ...) SWELL_LOG_STRIPPED(tag, __VA_ARGS__)
+#endif
+
+#if SWELL_LOG_LEVEL >= SWELL_LOG_LEVEL_INFO
+#define SWELL_LOGI(tag, ...) swellLog(SWELL_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#else
+#define SWELL_LOGI(tag, ...) SWELL_LOG_STRIPPED(tag, __VA_ARGS__)
+#endif
+
+#if SWELL_LOG_LEVEL >= SWELL_LOG_LEVEL_DEBUG
+#define SWELL_LOGD(tag, ...) swellLog(SWELL_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#else
+#define SWELL_LOGD(tag, ...) SWELL_LOG_STRIPPED(tag, __VA_ARGS__)
+#endif
+
+void logBegin(); // ESP32: mulai task penguras ke Serial
+
+// Pembaca independen (Serial, getLogs): cursor = seq entri berikutnya.
+// Entri yang sudah tertimpa dilompati; return false jika belum ada yang baru
+bool readLog(uint32_t &cursor, LogEntry &entry);
+uint32_t logHeadSeq();      // seq yang akan dipakai entri berikutnya
+uint32_t logOldestSeq();    // Entri tertua yang masih ada di ring
+
+char logLevelLetter(uint8_t level); // 'E', 'W', 'I', 'D'
+const char *logTagName(LogTag tag);
+const LogStats &logStats();
+
+#ifndef ARDUINO
+extern bool swellNativeLogEnabled;
+#endif
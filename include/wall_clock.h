@@ -0,0 +1,61 @@
+/**
+ * @file wall_clock.h
+ * @brief Swell Smart Lamp - Jam software yang didisiplinkan oleh DS3231
+ *
+ * Waktu kalender dihitung dari millis() + anchor (epoch ms sejak
+ * 2000-01-01 00:00), tanpa I2C. DS3231 hanya dibaca saat boot, saat
+ * kalibrasi dan setiap WALL_CLOCK_RESYNC_MS:
+ *
+ * - Fase: pembacaan RTC "detik S" berarti waktu sebenarnya di
+ *   [S, S+1). Jika prediksi jam software di luar interval itu, jam
+ *   digeser ke tepi terdekat; lama-lama fase menempel ke tepi detik RTC.
+ *   Dengan pin SQW 1 Hz (-D SWELL_RTC_SQW_PIN=<gpio>), tepi detik diketahui
+ *   langsung dari interrupt.
+ * - Drift: selisih laju millis() terhadap RTC (ppb) diestimasi dari
+ *   baseline panjang (>= WALL_CLOCK_DRIFT_MIN_BASELINE_MS) dan dikoreksi.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+const unsigned long WALL_CLOCK_RESYNC_MS = 600000;               // Baca DS3231 tiap 10 menit
+const unsigned long WALL_CLOCK_DRIFT_MIN_BASELINE_MS = 3600000;  // Estimasi drift setelah >= 1 jam
+const long WALL_CLOCK_MAX_DRIFT_PPB = 500000;                    // Batas wajar (500 ppm)
+
+struct WallClockTime
+{
+    int year; // 4 digit
+    uint8_t month;
+    uint8_t day;
+    uint8_t dayOfWeek; // 1 = Minggu ... 7 = Sabtu (sama dengan DS3231 di proyek ini)
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint16_t millisecond;
+};
+
+struct WallClockStats
+{
+    unsigned long syncs = 0;       // Pembacaan DS3231 (I2C)
+    unsigned long edgeSyncs = 0;   // ... yang memakai tepi SQW
+    unsigned long steps = 0;       // Koreksi fase
+    long lastStepMs = 0;           // Koreksi terakhir (+ = jam software tertinggal)
+    long driftPpb = 0;             // Koreksi laju millis() yang dipakai sekarang
+    uint32_t generation = 0;       // Naik jika waktu melompat (set RTC / koreksi >= 1 s)
+};
+
+void wallClockSync(bool reset = false); // Baca DS3231 sekarang; reset = waktu RTC baru di-set
+bool serviceWallClock();                // Resync jika jatuh tempo, true jika membaca RTC
+unsigned long millisUntilWallClockSync();
+void wallClockSecondEdge(unsigned long atMillis); // Dari ISR SQW (aman di interrupt)
+
+long long wallClockEpochMs(); // ms sejak 2000-01-01 00:00 (waktu lokal)
+void wallClockNow(WallClockTime &time);
+long wallClockSecondOfDay(); // 0-86399
+
+const WallClockStats &wallClockStats();
+
+// Kalender (hari sejak 2000-01-01), dipakai juga oleh fake RTC di env:native
+long long daysFromCivil(int year, unsigned month, unsigned day);
+void civilFromDays(long long days, int &year, unsigned &month, unsigned &day);
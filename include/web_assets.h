@@ -0,0 +1,42 @@
+/**
+ * @file web_assets.h
+ * @brief Swell Smart Lamp - Format tabel web asset yang di-embed ke flash
+ *
+ * Tabel dihasilkan scripts/build_web_assets.py ke
+ * .pio/generated/web_assets_embedded.h dan hanya dipakai jika firmware
+ * di-build dengan -D SWELL_EMBED_WEB_ASSETS (env esp32doit-devkit-v1-embedded).
+ * Asset dikirim langsung dari flash (zero-copy), tanpa SPIFFS.
+ *
+ * Lookup path: FNV-1a 32-bit -> slot di EMBEDDED_WEB_ASSET_SLOTS (open
+ * addressing, linear probing), nilai slot = index asset + 1, 0 = kosong.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <pgmspace.h>
+#else
+#define PROGMEM
+#endif
+
+struct EmbeddedWebAsset
+{
+    const char *path;        // Mis. "/swell-script.js"
+    const char *contentType; // MIME type
+    const uint8_t *data;     // Isi file (gzip jika gzip == true), di flash
+    uint32_t length;
+    const char *etag; // Hash isi, sudah termasuk tanda kutip
+    bool gzip;
+};
+
+/** @brief FNV-1a 32-bit, harus sama dengan path_hash() di build_web_assets.py */
+inline uint32_t webAssetPathHash(const char *path)
+{
+    uint32_t hash = 2166136261u;
+    for (; *path; path++)
+        hash = (hash ^ (uint8_t)*path) * 16777619u;
+    return hash;
+}
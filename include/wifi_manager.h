@@ -0,0 +1,65 @@
+/**
+ * @file wifi_manager.h
+ * @brief Swell Smart Lamp - Koneksi WiFi non-blocking dengan reconnect di background
+ *
+ * Event WiFi (task event ESP32 / fake di env:native) hanya diantrikan lewat
+ * wifiLink*(); serviceWiFi() di loop() yang menjalankan state machine:
+ *
+ * - Link putus: langsung coba lagi ke BSSID + channel terakhir (tanpa scan
+ *   semua channel), lalu scan penuh, lalu backoff eksponensial
+ *   WIFI_BACKOFF_MIN_MS .. WIFI_BACKOFF_MAX_MS. loop() tidak pernah menunggu.
+ * - BSSID/channel AP terakhir disimpan di NVS (hanya jika berubah), jadi
+ *   boot berikutnya juga bisa langsung connect tanpa scan.
+ * - Latensi link putus -> IP lagi dicatat (histogram di GET /metrics).
+ *
+ * Web server listen di semua interface sejak boot, jadi langsung bisa
+ * diakses lagi begitu IP didapat; callback online/offline dipanggil dari loop().
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+const unsigned long WIFI_CONNECT_TIMEOUT_MS = 10000;      // Scan + asosiasi + DHCP
+const unsigned long WIFI_FAST_CONNECT_TIMEOUT_MS = 4000;  // Dengan BSSID/channel dari cache
+const unsigned long WIFI_BACKOFF_MIN_MS = 1000;
+const unsigned long WIFI_BACKOFF_MAX_MS = 60000;
+const unsigned long WIFI_NO_DEADLINE = 0xFFFFFFFFUL;
+
+enum WifiLinkState : uint8_t
+{
+    WIFI_LINK_IDLE,       // wifiManagerBegin() belum dipanggil
+    WIFI_LINK_CONNECTING, // Scan / asosiasi
+    WIFI_LINK_ASSOCIATED, // Menunggu DHCP
+    WIFI_LINK_ONLINE,
+    WIFI_LINK_BACKOFF // Menunggu percobaan berikutnya
+};
+
+struct WifiManagerStats
+{
+    unsigned long attempts = 0;        // Panggilan connect()
+    unsigned long cachedAttempts = 0;  // ... dengan BSSID/channel dari cache
+    unsigned long connects = 0;        // Dapat IP
+    unsigned long disconnects = 0;     // Link putus saat online
+    unsigned long timeouts = 0;        // Percobaan tanpa IP sampai timeout
+    unsigned long cacheWrites = 0;     // Write NVS BSSID/channel
+    unsigned long eventsDropped = 0;   // Antrian event penuh
+    unsigned long lastReconnectMs = 0; // Link putus -> IP lagi, terakhir
+    uint8_t lastReason = 0;            // wifi_err_reason_t disconnect terakhir
+};
+
+typedef void (*WifiStateCallback)(bool online);
+
+void wifiManagerBegin(const char *ssid, const char *password, WifiStateCallback onChange);
+void serviceWiFi();                     // loop(): proses event, timeout, backoff
+unsigned long millisUntilWiFiService(); // WIFI_NO_DEADLINE jika hanya menunggu event
+
+WifiLinkState wifiState();
+bool wifiOnline();
+const WifiManagerStats &wifiManagerStats();
+
+// Dari task event WiFi (satu producer); pemanggil membangunkan loop() sendiri
+void wifiLinkConnected(const uint8_t *bssid, uint8_t channel);
+void wifiLinkGotIp();
+void wifiLinkDisconnected(uint8_t reason);
@@ -0,0 +1,60 @@
+/**
+ * @file ws_reassembly.h
+ * @brief Swell Smart Lamp - Penyusunan ulang pesan WebSocket (fragmen / multi-paket)
+ *
+ * WS_EVT_DATA tidak selalu berisi satu pesan utuh: frame besar datang dalam
+ * beberapa paket TCP (AwsFrameInfo::index / len) dan pesan bisa dipecah
+ * jadi beberapa frame (AwsFrameInfo::num / final). Modul ini:
+ *
+ * - pesan satu frame yang datang utuh: diteruskan zero-copy (pointer data
+ *   dari AsyncTCP langsung), tanpa buffer
+ * - selain itu: disusun di slot per client dengan buffer statis
+ *   WS_MESSAGE_MAX_SIZE byte, tanpa heap
+ * - pesan > WS_MESSAGE_MAX_SIZE, potongan yang tidak berurutan, atau tidak
+ *   ada slot kosong: ditolak, sisa potongannya dibuang sampai frame final
+ *
+ * Hanya dipanggil dari task AsyncTCP (satu task), jadi tanpa lock.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+const size_t WS_MESSAGE_MAX_SIZE = 256; // Command terbesar (rtc-calibrate JSON) ~130 byte
+const size_t WS_REASSEMBLY_SLOTS = 4;   // Client yang boleh mengirim pesan terpecah bersamaan
+
+/** @brief Field AwsFrameInfo yang dibutuhkan (hal-independent supaya bisa di-bench) */
+struct WsFragment
+{
+    bool binary;          // message_opcode == WS_BINARY
+    uint32_t frameNumber; // num: 0 = frame pertama pesan
+    bool finalFrame;      // final: frame terakhir pesan
+    uint64_t frameIndex;  // index: offset potongan ini di dalam frame
+    uint64_t frameLength; // len: panjang frame total
+};
+
+enum WsReassemblyResult : uint8_t
+{
+    WS_MESSAGE_INCOMPLETE, // Disimpan, tunggu potongan berikutnya
+    WS_MESSAGE_COMPLETE,   // message/messageLen valid sampai event berikutnya
+    WS_MESSAGE_REJECTED    // Terlalu besar / tidak berurutan / slot penuh
+};
+
+struct WsReassemblyStats
+{
+    unsigned long zeroCopy = 0;    // Pesan utuh dalam satu event
+    unsigned long reassembled = 0; // Pesan yang disusun dari beberapa potongan
+    unsigned long oversized = 0;
+    unsigned long outOfOrder = 0;  // Potongan hilang / pesan terpotong oleh pesan baru
+    unsigned long noSlot = 0;
+    unsigned long bytesDropped = 0;
+    size_t largestMessage = 0;
+};
+
+WsReassemblyResult reassembleWebSocketMessage(uint32_t clientId, const WsFragment &fragment,
+                                              const uint8_t *data, size_t len,
+                                              const uint8_t *&message, size_t &messageLen);
+void releaseWebSocketClient(uint32_t clientId); // WS_EVT_DISCONNECT: buang pesan setengah jadi
+
+const WsReassemblyStats &wsReassemblyStats();
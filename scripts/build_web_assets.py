@@ -0,0 +1,200 @@
+"""
+build_web_assets.py - Swell Smart Lamp
+
+Menyiapkan isi SPIFFS dari folder data/ ke .pio/webdata/ (data_dir PlatformIO):
+
+- HTML/CSS/JS di-minify ringan (hapus komentar & indentasi) lalu di-gzip,
+  hanya file .gz yang ikut di-upload.
+- File biner (png, ...) disalin apa adanya (sudah terkompresi).
+- Referensi asset di HTML/JS diberi ?v=<hash> supaya browser boleh cache
+  selamanya (Cache-Control immutable), HTML sendiri selalu revalidate.
+- /assets.manifest berisi "<path> <gz|raw> <etag>" per baris, dibaca
+  firmware saat boot untuk ETag & 304 Not Modified.
+- .pio/generated/web_assets_embedded.h berisi asset yang sama sebagai
+  tabel const di flash + hash table path, dipakai jika firmware di-build
+  dengan -D SWELL_EMBED_WEB_ASSETS (tanpa SPIFFS sama sekali).
+
+Dijalankan otomatis oleh PlatformIO (extra_scripts = pre:...) sebelum
+buildfs/uploadfs, atau manual: python3 scripts/build_web_assets.py
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+
+TEXT_TYPES = (".html", ".css", ".js")
+# Urutan penting: asset yang direferensikan diproses lebih dulu
+PROCESS_ORDER = (".png", ".jpg", ".ico", ".gif", ".css", ".js", ".html")
+MANIFEST_NAME = "assets.manifest"
+EMBEDDED_HEADER_NAME = "web_assets_embedded.h"
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".png": "image/png",
+    ".jpg": "image/jpeg",
+    ".ico": "image/x-icon",
+    ".gif": "image/gif",
+}
+
+
+def minify_css(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    return "\n".join(line.strip() for line in text.splitlines() if line.strip())
+
+
+def minify_js(text):
+    # Konservatif: hanya komentar satu baris penuh & indentasi, supaya string
+    # seperti 'ws://...' tidak pernah tersentuh
+    lines = []
+    for line in text.splitlines():
+        stripped = line.strip()
+        if not stripped or stripped.startswith("//"):
+            continue
+        lines.append(stripped)
+    return "\n".join(lines)
+
+
+def minify_html(text):
+    text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    return "\n".join(line.strip() for line in text.splitlines() if line.strip())
+
+
+MINIFIERS = {".css": minify_css, ".js": minify_js, ".html": minify_html}
+
+
+def etag_of(payload):
+    return '"%s"' % hashlib.sha1(payload).hexdigest()[:16]
+
+
+def path_hash(path):
+    """FNV-1a 32-bit, harus sama dengan webAssetPathHash() di web_assets.h"""
+    value = 2166136261
+    for byte in path.encode("utf-8"):
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def write_embedded_header(assets, header_path):
+    """assets: list of (path, content_type, payload, etag, gzip)"""
+    slot_count = 1
+    while slot_count < len(assets) * 2:
+        slot_count *= 2
+
+    slots = [0] * slot_count  # 0 = kosong, selain itu index asset + 1
+    for index, asset in enumerate(assets):
+        slot = path_hash(asset[0]) & (slot_count - 1)
+        while slots[slot]:
+            slot = (slot + 1) & (slot_count - 1)
+        slots[slot] = index + 1
+
+    out = [
+        "// AUTO-GENERATED oleh scripts/build_web_assets.py dari data/ - jangan diedit",
+        "#pragma once",
+        "",
+        "#include \"web_assets.h\"",
+        "",
+    ]
+    for index, (path, _, payload, _, _) in enumerate(assets):
+        out.append("// %s (%d bytes)" % (path, len(payload)))
+        out.append("static const uint8_t EMBEDDED_ASSET_%d[] PROGMEM = {" % index)
+        for offset in range(0, len(payload), 24):
+            out.append("    " + ",".join("0x%02x" % b for b in payload[offset:offset + 24]) + ",")
+        out.append("};")
+        out.append("")
+
+    out.append("static const EmbeddedWebAsset EMBEDDED_WEB_ASSETS[] = {")
+    for index, (path, content_type, payload, etag, gzip_encoded) in enumerate(assets):
+        out.append('    {"%s", "%s", EMBEDDED_ASSET_%d, %d, "%s", %s},' % (
+            path, content_type, index, len(payload), etag.replace('"', '\\"'),
+            "true" if gzip_encoded else "false"))
+    out.append("};")
+    out.append("")
+    out.append("static const size_t EMBEDDED_WEB_ASSET_COUNT = %d;" % len(assets))
+    out.append("static const size_t EMBEDDED_WEB_ASSET_SLOT_COUNT = %d; // Pangkat 2" % slot_count)
+    out.append("static const uint8_t EMBEDDED_WEB_ASSET_SLOTS[] = {%s};" % ", ".join(str(v) for v in slots))
+    out.append("")
+
+    with open(header_path, "w") as f:
+        f.write("\n".join(out))
+
+
+def add_versions(text, versions):
+    def replace(match):
+        quote, name = match.group(1), match.group(2)
+        return "%s%s?v=%s%s" % (quote, name, versions[name], quote)
+
+    if not versions:
+        return text
+    names = "|".join(re.escape(name) for name in versions)
+    return re.sub(r"([\"'])(%s)\1" % names, replace, text)
+
+
+def build(source_dir, output_dir, generated_dir):
+    if os.path.isdir(output_dir):
+        shutil.rmtree(output_dir)
+    os.makedirs(output_dir)
+    if not os.path.isdir(generated_dir):
+        os.makedirs(generated_dir)
+
+    names = [n for n in os.listdir(source_dir) if os.path.isfile(os.path.join(source_dir, n))]
+    names.sort(key=lambda n: (PROCESS_ORDER.index(os.path.splitext(n)[1])
+                              if os.path.splitext(n)[1] in PROCESS_ORDER else -1, n))
+
+    versions = {}
+    manifest = []
+    embedded = []
+    raw_total = 0
+    out_total = 0
+
+    for name in names:
+        ext = os.path.splitext(name)[1].lower()
+        with open(os.path.join(source_dir, name), "rb") as f:
+            raw = f.read()
+        raw_total += len(raw)
+
+        if ext in TEXT_TYPES:
+            text = MINIFIERS[ext](raw.decode("utf-8"))
+            if ext != ".css":
+                text = add_versions(text, versions)
+            payload = gzip.compress(text.encode("utf-8"), compresslevel=9, mtime=0)
+            out_name, encoding = name + ".gz", "gz"
+        else:
+            payload = raw
+            out_name, encoding = name, "raw"
+
+        with open(os.path.join(output_dir, out_name), "wb") as f:
+            f.write(payload)
+        out_total += len(payload)
+
+        etag = etag_of(payload)
+        if ext != ".html":
+            versions[name] = etag.strip('"')[:8]
+        manifest.append("/%s %s %s" % (name, encoding, etag))
+        embedded.append(("/" + name, CONTENT_TYPES.get(ext, "text/plain"), payload, etag, encoding == "gz"))
+        print("  /%-28s %7d -> %7d bytes (%s)" % (name, len(raw), len(payload), encoding))
+
+    with open(os.path.join(output_dir, MANIFEST_NAME), "w") as f:
+        f.write("\n".join(manifest) + "\n")
+    write_embedded_header(embedded, os.path.join(generated_dir, EMBEDDED_HEADER_NAME))
+
+    print("Web assets: %d -> %d bytes di %s" % (raw_total, out_total, output_dir))
+
+
+def project_paths(project_dir):
+    return (os.path.join(project_dir, "data"),
+            os.path.join(project_dir, ".pio", "webdata"),
+            os.path.join(project_dir, ".pio", "generated"))
+
+
+try:
+    Import("env")  # noqa: F821 - disediakan SCons saat dijalankan PlatformIO
+    paths = project_paths(env.subst("$PROJECT_DIR"))  # noqa: F821
+    build(*paths)
+    env.Append(CPPPATH=[paths[2]])  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        build(*project_paths(os.path.dirname(os.path.dirname(os.path.abspath(__file__)))))
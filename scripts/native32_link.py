@@ -0,0 +1,10 @@
+"""
+native32_link.py - Swell Smart Lamp
+
+env:native32: build_flags hanya dipakai saat compile, linker juga perlu
+-m32 supaya memakai runtime 32-bit (unsigned long 32-bit seperti ESP32).
+"""
+
+Import("env")  # noqa: F821 (disediakan SCons)
+
+env.Append(LINKFLAGS=["-m32"])  # noqa: F821
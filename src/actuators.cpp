@@ -0,0 +1,100 @@
+/**
+ * @file actuators.cpp
+ * @brief Swell Smart Lamp - Output actuator dengan dirty-check (LED PWM, GPIO aromatherapy)
+ */
+
+#include "actuators.h"
+
+#include "hal.h"
+#include "swell_core.h"
+
+enum ActuatorKind : uint8_t
+{
+    ACTUATOR_PWM,
+    ACTUATOR_GPIO
+};
+
+struct ActuatorInfo
+{
+    const char *name;
+    ActuatorKind kind;
+    uint8_t target; // Channel LEDC atau nomor pin
+};
+
+static const ActuatorInfo ACTUATORS[ACTUATOR_COUNT] = {
+    {"whiteLed", ACTUATOR_PWM, PWM_CHANNEL_WHITE},
+    {"yellowLed", ACTUATOR_PWM, PWM_CHANNEL_YELLOW},
+    {"aromatherapy", ACTUATOR_GPIO, AROMATHERAPY_PIN},
+};
+
+static uint32_t applied[ACTUATOR_COUNT];
+static bool known[ACTUATOR_COUNT]; // false = state hardware belum diketahui
+static ActuatorStats stats;
+
+static bool unchanged(ActuatorOutput output, uint32_t value)
+{
+    if (known[output] && applied[output] == value)
+    {
+        stats.suppressed[output]++;
+        return true;
+    }
+    return false;
+}
+
+static void markApplied(ActuatorOutput output, uint32_t value)
+{
+    applied[output] = value;
+    known[output] = true;
+    stats.writes[output]++;
+}
+
+void setActuator(ActuatorOutput output, uint32_t value)
+{
+    if (unchanged(output, value))
+        return;
+
+    const ActuatorInfo &info = ACTUATORS[output];
+    if (info.kind == ACTUATOR_PWM)
+        hal.pwm->write(info.target, value);
+    else
+        hal.gpio->write(info.target, value != 0);
+
+    markApplied(output, value);
+}
+
+void fadeActuator(ActuatorOutput output, uint32_t value, uint32_t durationMs)
+{
+    const ActuatorInfo &info = ACTUATORS[output];
+    if (info.kind != ACTUATOR_PWM || durationMs == 0)
+    {
+        setActuator(output, value);
+        return;
+    }
+    if (unchanged(output, value))
+        return;
+
+    hal.pwm->fade(info.target, value, durationMs);
+    markApplied(output, value);
+    stats.fades[output]++;
+}
+
+uint32_t actuatorValue(ActuatorOutput output)
+{
+    return applied[output];
+}
+
+void invalidateActuators()
+{
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+        known[i] = false;
+}
+
+const char *actuatorName(ActuatorOutput output)
+{
+    return ACTUATORS[output].name;
+}
+
+const ActuatorStats &actuatorStats()
+{
+    return stats;
+}
@@ -0,0 +1,416 @@
+/**
+ * @file audio_driver.cpp
+ * @brief Swell Smart Lamp - Driver DFPlayer Mini non-blocking (antrian frame UART)
+ */
+
+#include "audio_driver.h"
+
+#include "hal.h"
+#include "metrics.h"
+#include "swell_log.h"
+
+enum AudioOp : uint8_t
+{
+    OP_PLAY,
+    OP_STOP,
+    OP_VOLUME,
+    OP_EQ
+};
+
+struct AudioRequest
+{
+    AudioOp op;
+    uint16_t param;
+};
+
+static const uint8_t OP_COMMANDS[] = {
+    DFPLAYER_CMD_PLAY,
+    DFPLAYER_CMD_STOP,
+    DFPLAYER_CMD_VOLUME,
+    DFPLAYER_CMD_EQ,
+};
+
+// =================================================================
+// DRIVER STATE (hanya disentuh dari loop())
+// =================================================================
+
+static AudioRequest pending[AUDIO_QUEUE_CAPACITY];
+static size_t pendingCount = 0;
+
+static AudioDriverState state = AUDIO_OFFLINE;
+static AudioEventHandler eventHandler = nullptr;
+static AudioDriverStats stats;
+
+static bool inFlight = false;
+static AudioRequest current;
+static unsigned long sentAt = 0;
+static int sendAttempts = 0;
+
+static int initAttempts = 0;
+static unsigned long initStartedAt = 0;
+
+static int playingTrack = 0;    // Track yang (akan) diputar, 0 = idle
+static int ackedVolume = -1;    // Volume terakhir yang di-ACK modul, -1 = tidak diketahui
+
+static uint8_t rxFrame[AUDIO_FRAME_SIZE];
+static size_t rxLength = 0;
+
+// =================================================================
+// FRAME ENCODING
+// =================================================================
+
+void encodeAudioFrame(uint8_t command, uint16_t param, bool ack, uint8_t *frame)
+{
+    frame[0] = 0x7E;
+    frame[1] = 0xFF;
+    frame[2] = 0x06;
+    frame[3] = command;
+    frame[4] = ack ? 0x01 : 0x00;
+    frame[5] = (uint8_t)(param >> 8);
+    frame[6] = (uint8_t)param;
+
+    uint16_t sum = 0;
+    for (int i = 1; i <= 6; i++)
+        sum += frame[i];
+    uint16_t checksum = (uint16_t)(0 - sum);
+
+    frame[7] = (uint8_t)(checksum >> 8);
+    frame[8] = (uint8_t)checksum;
+    frame[9] = 0xEF;
+}
+
+static bool validFrame(const uint8_t *frame)
+{
+    if (frame[0] != 0x7E || frame[2] != 0x06 || frame[9] != 0xEF)
+        return false;
+
+    uint16_t sum = 0;
+    for (int i = 1; i <= 6; i++)
+        sum += frame[i];
+    return (uint16_t)(sum + ((frame[7] << 8) | frame[8])) == 0;
+}
+
+static void sendFrame(uint8_t command, uint16_t param, bool ack)
+{
+    uint8_t frame[AUDIO_FRAME_SIZE];
+    encodeAudioFrame(command, param, ack, frame);
+    hal.audio->write(frame, sizeof(frame));
+    stats.framesSent++;
+}
+
+static void emit(AudioEvent event, int param)
+{
+    if (eventHandler)
+        eventHandler(event, param);
+}
+
+// =================================================================
+// ANTRIAN + COALESCING
+// =================================================================
+
+static int findPending(AudioOp op)
+{
+    for (size_t i = 0; i < pendingCount; i++)
+    {
+        if (pending[i].op == op)
+            return (int)i;
+    }
+    return -1;
+}
+
+/** @brief Buang play/stop yang belum terkirim (digantikan request transport baru) */
+static void dropPendingTransport()
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < pendingCount; i++)
+    {
+        if (pending[i].op == OP_PLAY || pending[i].op == OP_STOP)
+            stats.coalesced++;
+        else
+            pending[kept++] = pending[i];
+    }
+    pendingCount = kept;
+}
+
+static bool push(AudioOp op, uint16_t param)
+{
+    if (state == AUDIO_FAILED)
+        return false;
+
+    if (pendingCount >= AUDIO_QUEUE_CAPACITY)
+    {
+        stats.dropped++;
+        return false;
+    }
+
+    pending[pendingCount].op = op;
+    pending[pendingCount].param = param;
+    pendingCount++;
+    if (pendingCount > stats.highWater)
+        stats.highWater = pendingCount;
+    return true;
+}
+
+bool audioPlay(int track)
+{
+    dropPendingTransport();
+    playingTrack = track;
+    return push(OP_PLAY, (uint16_t)track);
+}
+
+bool audioStop()
+{
+    if (playingTrack == 0)
+    {
+        stats.suppressed++;
+        return true;
+    }
+
+    dropPendingTransport();
+    playingTrack = 0;
+    return push(OP_STOP, 0);
+}
+
+bool audioVolume(int level)
+{
+    if (level < 0)
+        level = 0;
+    if (level > 30)
+        level = 30;
+
+    // Dibandingkan dengan volume yang masih mengantri, atau yang sudah di-ACK.
+    // Frame volume yang sedang terkirim bisa saja timeout: jangan dianggap berlaku.
+    int index = findPending(OP_VOLUME);
+    if (index >= 0)
+    {
+        if (pending[index].param == (uint16_t)level)
+        {
+            stats.suppressed++;
+            return true;
+        }
+        pending[index].param = (uint16_t)level;
+        stats.coalesced++;
+        return true;
+    }
+    if (level == ackedVolume && !(inFlight && current.op == OP_VOLUME))
+    {
+        stats.suppressed++;
+        return true;
+    }
+
+    if (push(OP_VOLUME, (uint16_t)level))
+        return true;
+    ackedVolume = -1;
+    return false;
+}
+
+bool audioEqNormal()
+{
+    if (findPending(OP_EQ) >= 0)
+    {
+        stats.coalesced++;
+        return true;
+    }
+    return push(OP_EQ, 0);
+}
+
+// =================================================================
+// HANDSHAKE
+// =================================================================
+
+static void startHandshake()
+{
+    initAttempts++;
+    initStartedAt = hal.clock->millis();
+    sendFrame(DFPLAYER_CMD_RESET, 0, false);
+}
+
+void audioDriverBegin(AudioEventHandler handler)
+{
+    eventHandler = handler;
+    state = AUDIO_STARTING;
+    initAttempts = 0;
+    inFlight = false;
+    ackedVolume = -1;
+    rxLength = 0;
+
+    hal.audio->begin();
+    startHandshake();
+}
+
+// =================================================================
+// RECEIVE
+// =================================================================
+
+static void handleFrame(uint8_t command, uint16_t param)
+{
+    switch (command)
+    {
+    case DFPLAYER_EVT_ONLINE:
+        if (state == AUDIO_STARTING)
+        {
+            state = AUDIO_READY;
+            emit(AUDIO_EVENT_READY, param);
+        }
+        break;
+
+    case DFPLAYER_EVT_ACK:
+        if (inFlight)
+        {
+            inFlight = false;
+            stats.acked++;
+            if (current.op == OP_VOLUME)
+                ackedVolume = current.param;
+            recordAudioAckLatency(hal.clock->millis() - sentAt);
+        }
+        break;
+
+    case DFPLAYER_EVT_ERROR:
+        // Modul membalas error sebagai pengganti ACK; frame tidak diulang
+        if (inFlight && current.op == OP_VOLUME)
+            ackedVolume = -1;
+        inFlight = false;
+        stats.errors++;
+        emit(AUDIO_EVENT_ERROR, param);
+        break;
+
+    case DFPLAYER_EVT_USB_FINISHED:
+    case DFPLAYER_EVT_TF_FINISHED:
+    case DFPLAYER_EVT_FLASH_FINISHED:
+        // DFPlayer mengirim event ini dua kali; yang kedua (atau event dari
+        // track yang sudah diganti) diabaikan
+        if (playingTrack != 0 && playingTrack == (int)param &&
+            findPending(OP_PLAY) < 0 && !(inFlight && current.op == OP_PLAY))
+        {
+            playingTrack = 0;
+            stats.finished++;
+            emit(AUDIO_EVENT_FINISHED, param);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+static void receiveFrames()
+{
+    int value;
+    while ((value = hal.audio->read()) >= 0)
+    {
+        uint8_t byte = (uint8_t)value;
+        if (rxLength == 0 && byte != 0x7E)
+            continue; // Sinkronisasi ulang ke awal frame
+
+        rxFrame[rxLength++] = byte;
+        if (rxLength < AUDIO_FRAME_SIZE)
+            continue;
+
+        rxLength = 0;
+        if (validFrame(rxFrame))
+            handleFrame(rxFrame[3], (uint16_t)((rxFrame[5] << 8) | rxFrame[6]));
+    }
+}
+
+// =================================================================
+// SERVICE
+// =================================================================
+
+/** @return true jika frame baru dikirim */
+static bool sendNext()
+{
+    if (state != AUDIO_READY || inFlight || pendingCount == 0)
+        return false;
+
+    current = pending[0];
+    pendingCount--;
+    for (size_t i = 0; i < pendingCount; i++)
+        pending[i] = pending[i + 1];
+
+    sendFrame(OP_COMMANDS[current.op], current.param, true);
+    inFlight = true;
+    sendAttempts = 1;
+    sentAt = hal.clock->millis();
+    return true;
+}
+
+void serviceAudio()
+{
+    if (state == AUDIO_OFFLINE || state == AUDIO_FAILED)
+        return;
+
+    receiveFrames();
+    unsigned long now = hal.clock->millis();
+
+    if (state == AUDIO_STARTING)
+    {
+        if (now - initStartedAt < AUDIO_INIT_TIMEOUT_MS)
+            return;
+
+        if (initAttempts < AUDIO_INIT_ATTEMPTS)
+        {
+            SWELL_LOGE(LOG_AUDIO, "❌ DFPlayer percobaan %d gagal, coba lagi...", initAttempts);
+            startHandshake();
+            return;
+        }
+
+        state = AUDIO_FAILED;
+        pendingCount = 0;
+        emit(AUDIO_EVENT_FAILED, initAttempts);
+        return;
+    }
+
+    if (inFlight && now - sentAt >= AUDIO_ACK_TIMEOUT_MS)
+    {
+        if (sendAttempts <= AUDIO_MAX_RETRIES)
+        {
+            sendFrame(OP_COMMANDS[current.op], current.param, true);
+            sendAttempts++;
+            sentAt = now;
+            stats.retries++;
+        }
+        else
+        {
+            SWELL_LOGW(LOG_AUDIO, "⚠️ DFPlayer tidak membalas command 0x%02X, dibuang", OP_COMMANDS[current.op]);
+            inFlight = false;
+            stats.timeouts++;
+            if (current.op == OP_VOLUME)
+                ackedVolume = -1; // Request volume yang sama berikutnya dikirim lagi
+        }
+    }
+
+    // Modul yang cepat (atau fake di env:native) sudah membalas saat
+    // receiveFrames() berikutnya, jadi antrian bisa habis dalam satu panggilan
+    while (sendNext())
+        receiveFrames();
+}
+
+unsigned long millisUntilAudioService()
+{
+    unsigned long now = hal.clock->millis();
+
+    if (state == AUDIO_STARTING)
+    {
+        unsigned long elapsed = now - initStartedAt;
+        return elapsed >= AUDIO_INIT_TIMEOUT_MS ? 0 : AUDIO_INIT_TIMEOUT_MS - elapsed;
+    }
+    if (state != AUDIO_READY)
+        return AUDIO_NO_DEADLINE;
+
+    if (inFlight)
+    {
+        unsigned long elapsed = now - sentAt;
+        return elapsed >= AUDIO_ACK_TIMEOUT_MS ? 0 : AUDIO_ACK_TIMEOUT_MS - elapsed;
+    }
+    return pendingCount > 0 ? 0 : AUDIO_NO_DEADLINE;
+}
+
+AudioDriverState audioDriverState()
+{
+    return state;
+}
+
+const AudioDriverStats &audioDriverStats()
+{
+    return stats;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file binary_protocol.cpp
+ * @brief Swell Smart Lamp - Framing biner untuk command WebSocket
+ */
+
+#include "binary_protocol.h"
+
+#include <string.h>
+
+#include "command_table.h"
+
+static const uint8_t ABSENT = 0xFF; // timer-confirm: field tidak ada
+
+static int16_t optionalByte(uint8_t value)
+{
+    return value == ABSENT ? -1 : value;
+}
+
+static uint8_t optionalField(int16_t value)
+{
+    return value < 0 ? ABSENT : (uint8_t)value;
+}
+
+/** @brief Ukuran payload dari CommandSpec::binarySize; getPlaylist boleh tanpa etag */
+static bool payloadSizeOk(const CommandSpec &spec, size_t payloadSize)
+{
+    return payloadSize == spec.binarySize || (spec.arg == ARG_ETAG && payloadSize == 0);
+}
+
+bool decodeBinaryCommand(const uint8_t *data, size_t len, SwellCommand &command)
+{
+    if (len == 0 || data[0] == CMD_UNKNOWN || data[0] >= COMMAND_TYPE_COUNT)
+        return false;
+
+    const CommandSpec &spec = commandSpec((CommandType)data[0]);
+    const uint8_t *payload = data + 1;
+    size_t payloadSize = len - 1;
+    if (!payloadSizeOk(spec, payloadSize))
+        return false;
+
+    command = SwellCommand();
+    command.type = spec.type;
+
+    switch (spec.arg)
+    {
+    case ARG_NONE:
+        break;
+
+    case ARG_ETAG:
+        memcpy(command.etag, payload, payloadSize); // etag[8] tetap '\0'
+        break;
+
+    case ARG_DATE_TIME:
+        command.year = (int16_t)(payload[0] | payload[1] << 8);
+        command.month = (int8_t)payload[2];
+        command.day = (int8_t)payload[3];
+        command.dayOfWeek = (int8_t)payload[4];
+        command.hour = (int8_t)payload[5];
+        command.minute = (int8_t)payload[6];
+        command.second = (int8_t)payload[7];
+        break;
+
+    case ARG_TIME_RANGE:
+        command.startHour = optionalByte(payload[0]);
+        command.startMinute = optionalByte(payload[1]);
+        command.endHour = optionalByte(payload[2]);
+        command.endMinute = optionalByte(payload[3]);
+        break;
+
+    default:
+    {
+        // ARG_BOOL / ARG_INT / ARG_FIELD: bilangan little-endian selebar payload
+        uint32_t value = 0;
+        for (size_t i = 0; i < payloadSize; i++)
+            value |= (uint32_t)payload[i] << (8 * i);
+        command.value = (int32_t)value;
+        break;
+    }
+    }
+    return validateCommand(command);
+}
+
+size_t encodeBinaryCommand(const SwellCommand &command, uint8_t *out, size_t capacity)
+{
+    if (command.type == CMD_UNKNOWN || command.type >= COMMAND_TYPE_COUNT)
+        return 0;
+
+    const CommandSpec &spec = commandSpec(command.type);
+    size_t payloadSize = spec.binarySize;
+    if (spec.arg == ARG_ETAG && command.etag[0] == '\0')
+        payloadSize = 0;
+    if (capacity < payloadSize + 1)
+        return 0;
+
+    out[0] = command.type;
+    uint8_t *payload = out + 1;
+
+    switch (spec.arg)
+    {
+    case ARG_NONE:
+        break;
+
+    case ARG_ETAG:
+        memcpy(payload, command.etag, payloadSize);
+        break;
+
+    case ARG_DATE_TIME:
+        payload[0] = (uint8_t)command.year;
+        payload[1] = (uint8_t)(command.year >> 8);
+        payload[2] = (uint8_t)command.month;
+        payload[3] = (uint8_t)command.day;
+        payload[4] = (uint8_t)command.dayOfWeek;
+        payload[5] = (uint8_t)command.hour;
+        payload[6] = (uint8_t)command.minute;
+        payload[7] = (uint8_t)command.second;
+        break;
+
+    case ARG_TIME_RANGE:
+        payload[0] = optionalField(command.startHour);
+        payload[1] = optionalField(command.startMinute);
+        payload[2] = optionalField(command.endHour);
+        payload[3] = optionalField(command.endMinute);
+        break;
+
+    default:
+    {
+        uint32_t value = (uint32_t)command.value;
+        for (size_t i = 0; i < payloadSize; i++)
+            payload[i] = (uint8_t)(value >> (8 * i));
+        break;
+    }
+    }
+    return payloadSize + 1;
+}
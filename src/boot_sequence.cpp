@@ -0,0 +1,215 @@
+/**
+ * @file boot_sequence.cpp
+ * @brief Swell Smart Lamp - Boot bertahap: stage init paralel dengan dependensi + timing
+ */
+
+#include "boot_sequence.h"
+
+#include <atomic>
+
+#include "hal.h"
+#include "swell_log.h"
+
+// Sementara bootStageDone() menulis doneMs; pembaca menganggapnya masih RUNNING
+const uint8_t STAGE_CLAIMED = 0xFF;
+
+struct StageSlot
+{
+    std::atomic<uint8_t> state;
+    unsigned long startMs;
+    unsigned long doneMs;
+};
+
+static const BootStage *stages = nullptr;
+static size_t stageCount = 0;
+static StageSlot slots[BOOT_MAX_STAGES];
+static uint32_t reported = 0; // Stage yang durasinya sudah di-log
+static bool complete = false;
+static unsigned long readyMs = 0;
+
+static uint8_t loadState(size_t index)
+{
+    uint8_t state = slots[index].state.load(std::memory_order_acquire);
+    return state == STAGE_CLAIMED ? (uint8_t)BOOT_RUNNING : state;
+}
+
+static bool finished(size_t index)
+{
+    uint8_t state = loadState(index);
+    return state == BOOT_DONE || state == BOOT_FAILED;
+}
+
+/** @brief RUNNING -> DONE / FAILED, sekali saja (task lain bisa berlomba dengan timeout) */
+static bool finish(size_t index, bool ok)
+{
+    uint8_t expected = BOOT_RUNNING;
+    if (!slots[index].state.compare_exchange_strong(expected, STAGE_CLAIMED, std::memory_order_acquire))
+        return false;
+    slots[index].doneMs = hal.clock->millis();
+    slots[index].state.store(ok ? BOOT_DONE : BOOT_FAILED, std::memory_order_release);
+    return true;
+}
+
+static void startStage(size_t index)
+{
+    StageSlot &slot = slots[index];
+    slot.startMs = hal.clock->millis();
+    slot.state.store(BOOT_RUNNING, std::memory_order_release);
+
+    BootStageState result = stages[index].start();
+    if (result != BOOT_RUNNING)
+        finish(index, result == BOOT_DONE);
+}
+
+static bool dependenciesFinished(size_t index)
+{
+    for (size_t i = 0; i < stageCount; i++)
+    {
+        if ((stages[index].after & BOOT_AFTER(i)) && !finished(i))
+            return false;
+    }
+    return true;
+}
+
+static void reportStage(size_t index)
+{
+    const StageSlot &slot = slots[index];
+    unsigned long durationMs = slot.doneMs - slot.startMs;
+    if (loadState(index) == BOOT_DONE)
+        SWELL_LOGI(LOG_SYS, "⏱️ Boot %-10s selesai %5lu ms (mulai +%lu ms)", stages[index].name, durationMs, slot.startMs);
+    else
+        SWELL_LOGW(LOG_SYS, "⚠️ Boot %-10s GAGAL setelah %lu ms", stages[index].name, durationMs);
+}
+
+// =================================================================
+// PUBLIC API
+// =================================================================
+
+void bootBegin(const BootStage *table, size_t count)
+{
+    stages = table;
+    stageCount = count < BOOT_MAX_STAGES ? count : BOOT_MAX_STAGES;
+    reported = 0;
+    complete = false;
+    readyMs = 0;
+    for (size_t i = 0; i < stageCount; i++)
+        slots[i].state.store(BOOT_PENDING, std::memory_order_relaxed);
+
+    serviceBoot();
+}
+
+void serviceBoot()
+{
+    if (!stages || complete)
+        return;
+
+    bool progress = true;
+    while (progress)
+    {
+        progress = false;
+        for (size_t i = 0; i < stageCount; i++)
+        {
+            const BootStage &stage = stages[i];
+            uint8_t state = loadState(i);
+            if (state == BOOT_PENDING && dependenciesFinished(i))
+            {
+                startStage(i);
+                progress = true;
+            }
+            else if (state == BOOT_RUNNING && stage.poll)
+            {
+                BootStageState result = stage.poll();
+                if (result != BOOT_RUNNING)
+                    progress |= finish(i, result == BOOT_DONE);
+            }
+
+            // Jam dibaca ulang: stage bisa saja baru di-start di putaran ini
+            if (loadState(i) == BOOT_RUNNING && stage.timeoutMs &&
+                hal.clock->millis() - slots[i].startMs >= stage.timeoutMs)
+                progress |= finish(i, false);
+        }
+    }
+
+    bool allFinished = true;
+    unsigned long lastDoneMs = 0;
+    for (size_t i = 0; i < stageCount; i++)
+    {
+        if (!finished(i))
+        {
+            allFinished = false;
+            continue;
+        }
+        if (!(reported & BOOT_AFTER(i)))
+        {
+            reported |= BOOT_AFTER(i);
+            reportStage(i);
+        }
+        if ((long)(slots[i].doneMs - lastDoneMs) > 0)
+            lastDoneMs = slots[i].doneMs;
+    }
+
+    if (allFinished)
+    {
+        complete = true;
+        readyMs = lastDoneMs;
+        SWELL_LOGI(LOG_SYS, "🚀 Boot selesai: semua stage siap %lu ms sejak power-on", readyMs);
+    }
+}
+
+unsigned long millisUntilBootService()
+{
+    if (!stages || complete)
+        return BOOT_NO_DEADLINE;
+
+    unsigned long now = hal.clock->millis();
+    unsigned long earliest = BOOT_NO_DEADLINE;
+    for (size_t i = 0; i < stageCount; i++)
+    {
+        if (loadState(i) != BOOT_RUNNING || !stages[i].timeoutMs)
+            continue;
+
+        unsigned long elapsed = now - slots[i].startMs;
+        unsigned long wait = elapsed >= stages[i].timeoutMs ? 0 : stages[i].timeoutMs - elapsed;
+        if (wait < earliest)
+            earliest = wait;
+    }
+    return earliest;
+}
+
+void bootStageDone(size_t index, bool ok)
+{
+    if (index < stageCount)
+        finish(index, ok);
+}
+
+bool bootComplete()
+{
+    return complete;
+}
+
+unsigned long bootReadyMs()
+{
+    return readyMs;
+}
+
+size_t bootStageCount()
+{
+    return stageCount;
+}
+
+const char *bootStageName(size_t index)
+{
+    return index < stageCount ? stages[index].name : "?";
+}
+
+BootStageTiming bootStageTiming(size_t index)
+{
+    BootStageTiming timing = {BOOT_PENDING, 0, 0};
+    if (index >= stageCount)
+        return timing;
+
+    timing.state = (BootStageState)loadState(index);
+    timing.startMs = slots[index].startMs;
+    timing.doneMs = slots[index].doneMs;
+    return timing;
+}
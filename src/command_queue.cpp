@@ -0,0 +1,64 @@
+/**
+ * @file command_queue.cpp
+ * @brief Swell Smart Lamp - Antrian command SPSC (AsyncTCP task -> loop())
+ */
+
+#include "command_queue.h"
+
+#include <atomic>
+
+static_assert((COMMAND_QUEUE_CAPACITY & (COMMAND_QUEUE_CAPACITY - 1)) == 0,
+              "COMMAND_QUEUE_CAPACITY harus pangkat 2");
+
+static SwellCommand slots[COMMAND_QUEUE_CAPACITY];
+static std::atomic<uint32_t> head(0); // Hanya ditulis producer
+static std::atomic<uint32_t> tail(0); // Hanya ditulis consumer
+static CommandQueueStats stats;
+
+bool enqueueCommand(const SwellCommand &command)
+{
+    uint32_t currentHead = head.load(std::memory_order_relaxed);
+    uint32_t depth = currentHead - tail.load(std::memory_order_acquire);
+    if (depth >= COMMAND_QUEUE_CAPACITY)
+    {
+        stats.dropped++;
+        return false;
+    }
+
+    slots[currentHead & (COMMAND_QUEUE_CAPACITY - 1)] = command;
+    head.store(currentHead + 1, std::memory_order_release);
+
+    stats.enqueued++;
+    if (depth + 1 > stats.highWater)
+        stats.highWater = depth + 1;
+    return true;
+}
+
+bool dequeueCommand(SwellCommand &command)
+{
+    uint32_t currentTail = tail.load(std::memory_order_relaxed);
+    if (currentTail == head.load(std::memory_order_acquire))
+        return false;
+
+    command = slots[currentTail & (COMMAND_QUEUE_CAPACITY - 1)];
+    tail.store(currentTail + 1, std::memory_order_release);
+    return true;
+}
+
+const SwellCommand *peekCommand()
+{
+    uint32_t currentTail = tail.load(std::memory_order_relaxed);
+    if (currentTail == head.load(std::memory_order_acquire))
+        return nullptr;
+    return &slots[currentTail & (COMMAND_QUEUE_CAPACITY - 1)];
+}
+
+size_t commandQueueDepth()
+{
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
+
+CommandQueueStats &commandQueueStats()
+{
+    return stats;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file command_table.cpp
+ * @brief Swell Smart Lamp - Tabel command WebSocket (nama, skema argumen, gating)
+ */
+
+#include "command_table.h"
+
+#include <string.h>
+
+// =================================================================
+// ⭐ REGISTRASI COMMAND
+// =================================================================
+
+// X(type, name, arg, field, min, max, binarySize, gate, latestWins)
+// Urutan harus sama dengan CommandType (dicek static_assert di bawah)
+#define SWELL_COMMANDS(X)                                                                              \
+    X(CMD_UNKNOWN, "unknown", ARG_NONE, nullptr, 0, 0, 0, GATE_NONE, false)                            \
+    X(CMD_GET_STATUS, "getStatus", ARG_NONE, nullptr, 0, 0, 0, GATE_NONE, false)                       \
+    X(CMD_GET_PLAYLIST, "getPlaylist", ARG_ETAG, nullptr, 0, 0, 8, GATE_NONE, false)                   \
+    X(CMD_GET_CLOCK_SYNC, "getClockSync", ARG_FIELD, "token", 0, 0, 4, GATE_NONE, false)               \
+    X(CMD_RTC_CALIBRATE, "rtc-calibrate", ARG_DATE_TIME, nullptr, 0, 0, 8, GATE_NONE, false)           \
+    X(CMD_TIMER_TOGGLE, "timer-toggle", ARG_BOOL, nullptr, 0, 1, 1, GATE_NONE, false)                  \
+    X(CMD_TIMER_CONFIRM, "timer-confirm", ARG_TIME_RANGE, nullptr, 0, 0, 4, GATE_TIMER_ON, false)      \
+    X(CMD_LIGHT_INTENSITY, "light-intensity", ARG_INT, nullptr, 0, 100, 1, GATE_TIMER_CONFIRMED, true) \
+    X(CMD_AROMA_TOGGLE, "aroma-toggle", ARG_BOOL, nullptr, 0, 1, 1, GATE_TIMER_CONFIRMED, false)       \
+    X(CMD_ALARM_TOGGLE, "alarm-toggle", ARG_BOOL, nullptr, 0, 1, 1, GATE_TIMER_CONFIRMED, false)       \
+    X(CMD_MUSIC_TOGGLE, "music-toggle", ARG_BOOL, nullptr, 0, 1, 1, GATE_TIMER_CONFIRMED, false)       \
+    X(CMD_MUSIC_TRACK, "music-track", ARG_INT, nullptr, 1, 255, 1, GATE_TIMER_CONFIRMED, false)        \
+    X(CMD_MUSIC_VOLUME, "music-volume", ARG_INT, nullptr, 0, 100, 1, GATE_TIMER_CONFIRMED, true)       \
+    X(CMD_HELLO, "hello", ARG_FIELD, "binary", 0, 0, 1, GATE_NONE, false)                              \
+    X(CMD_GET_LOGS, "getLogs", ARG_FIELD, "since", 0, 0, 4, GATE_NONE, false)                          \
+    X(CMD_GET_METRICS, "getMetrics", ARG_NONE, nullptr, 0, 0, 0, GATE_NONE, false)
+
+#define COMMAND_SPEC_ROW(type, name, arg, field, min, max, binarySize, gate, latestWins) \
+    {type, name, arg, field, min, max, binarySize, gate, latestWins},
+
+static constexpr CommandSpec COMMAND_SPECS[] = {SWELL_COMMANDS(COMMAND_SPEC_ROW)};
+
+constexpr size_t COMMAND_SPEC_COUNT = sizeof(COMMAND_SPECS) / sizeof(COMMAND_SPECS[0]);
+
+constexpr bool specsOrdered(size_t index)
+{
+    return index >= COMMAND_SPEC_COUNT ||
+           (COMMAND_SPECS[index].type == (CommandType)index && specsOrdered(index + 1));
+}
+
+static_assert(COMMAND_SPEC_COUNT == COMMAND_TYPE_COUNT, "Setiap CommandType harus terdaftar di SWELL_COMMANDS");
+static_assert(specsOrdered(0), "Urutan SWELL_COMMANDS harus sama dengan CommandType");
+
+// =================================================================
+// LOOKUP
+// =================================================================
+
+const CommandSpec &commandSpec(CommandType type)
+{
+    return type < COMMAND_TYPE_COUNT ? COMMAND_SPECS[type] : COMMAND_SPECS[CMD_UNKNOWN];
+}
+
+const char *commandName(CommandType type)
+{
+    return commandSpec(type).name;
+}
+
+CommandType lookupCommand(const char *name, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+
+    CommandType type;
+    switch (hash)
+    {
+#define COMMAND_HASH_CASE(commandType, commandNameText, ...) \
+    case commandHash(commandNameText):                       \
+        type = commandType;                                  \
+        break;
+        SWELL_COMMANDS(COMMAND_HASH_CASE)
+#undef COMMAND_HASH_CASE
+    default:
+        return CMD_UNKNOWN;
+    }
+
+    // Hash cocok belum tentu namanya sama
+    const char *expected = COMMAND_SPECS[type].name;
+    return strncmp(expected, name, len) == 0 && expected[len] == '\0' ? type : CMD_UNKNOWN;
+}
+
+static const uint8_t *skipSpaces(const uint8_t *p, const uint8_t *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+        p++;
+    return p;
+}
+
+CommandType scanJsonCommand(const uint8_t *data, size_t len, const char *&name, size_t &nameLen)
+{
+    static const char KEY[] = "command";
+    const size_t keyLen = sizeof(KEY) - 1;
+
+    name = "";
+    nameLen = 0;
+
+    // Urutan key JSON bebas: hanya key "command" di objek level atas yang
+    // dipakai, key sama di objek/array bersarang dilewati. Isi string
+    // dilewati utuh supaya kurung di dalamnya tidak mengubah depth.
+    const uint8_t *end = data + len;
+    const uint8_t *p = data;
+    int depth = 0;
+    while (p < end)
+    {
+        uint8_t c = *p++;
+        if (c == '{' || c == '[')
+            depth++;
+        else if (c == '}' || c == ']')
+            depth--;
+        if (c != '"')
+            continue;
+
+        const uint8_t *start = p;
+        while (p < end && *p != '"')
+            p += (*p == '\\' && p + 1 < end) ? 2 : 1;
+        if (p >= end)
+            return CMD_UNKNOWN; // String tidak ditutup
+        const uint8_t *stringEnd = p++;
+
+        if (depth != 1 || (size_t)(stringEnd - start) != keyLen || memcmp(start, KEY, keyLen) != 0)
+            continue;
+
+        const uint8_t *q = skipSpaces(p, end);
+        if (q == end || *q != ':')
+            continue; // "command" sebagai nilai, bukan key
+
+        q = skipSpaces(q + 1, end);
+        if (q == end || *q != '"')
+            return CMD_UNKNOWN;
+
+        start = ++q;
+        while (q < end && *q != '"' && *q != '\\')
+            q++;
+        if (q == end || *q != '"')
+            return CMD_UNKNOWN; // Nama command tidak pernah butuh escape
+
+        name = (const char *)start;
+        nameLen = (size_t)(q - start);
+        return lookupCommand(name, nameLen);
+    }
+    return CMD_UNKNOWN;
+}
+
+// =================================================================
+// VALIDASI ARGUMEN
+// =================================================================
+
+static bool validTime(int16_t hour, int16_t minute)
+{
+    return (hour == -1 || (hour >= 0 && hour <= 23)) && (minute == -1 || (minute >= 0 && minute <= 59));
+}
+
+bool validateCommand(const SwellCommand &command)
+{
+    const CommandSpec &spec = commandSpec(command.type);
+    switch (spec.arg)
+    {
+    case ARG_BOOL:
+    case ARG_INT:
+        return command.value >= spec.min && command.value <= spec.max;
+
+    case ARG_TIME_RANGE:
+        return validTime(command.startHour, command.startMinute) && validTime(command.endHour, command.endMinute);
+
+    default:
+        // rtc-calibrate divalidasi calibrateRTC() supaya client dapat balasan error
+        return command.type != CMD_UNKNOWN;
+    }
+}
@@ -0,0 +1,274 @@
+/**
+ * @file hal_esp32.cpp
+ * @brief Swell Smart Lamp - Implementasi hal.h untuk ESP32 (firmware)
+ *
+ * Wrapper tipis di atas ledcWrite/digitalWrite, uRTCLib, UART DFPlayer,
+ * Preferences, AsyncWebSocket dan WiFi. Tidak ada logic di sini.
+ */
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <driver/ledc.h>
+#include <uRTCLib.h>
+#include <mutex>
+
+#include "hal.h"
+#include "json_writer.h"
+#include "socket_fanout.h"
+#include "swell_core.h"
+
+// AsyncWebSocket didefinisikan di main.cpp bersama web server
+extern AsyncWebSocket ws;
+void wakeMainLoop(); // main.cpp
+
+// =================================================================
+// PERIPHERAL OBJECTS
+// =================================================================
+
+Preferences preferences;
+uRTCLib rtc(0x68);
+
+HardwareSerial myDFPlayerSerial(2);
+
+// =================================================================
+// ESP32 IMPLEMENTATIONS
+// =================================================================
+
+class LedcPwmOutput : public PwmOutput
+{
+public:
+    void write(uint8_t channel, uint32_t duty) override { ledcWrite(channel, duty); }
+
+    void fade(uint8_t channel, uint32_t duty, uint32_t durationMs) override
+    {
+        // Pemetaan channel ledcSetup() Arduino-ESP32 2.x: 0-7 high speed, 8-15 low speed
+        ledc_mode_t mode = channel < 8 ? LEDC_HIGH_SPEED_MODE : LEDC_LOW_SPEED_MODE;
+        ledc_channel_t ledcChannel = (ledc_channel_t)(channel % 8);
+        if (ledc_set_fade_with_time(mode, ledcChannel, duty, durationMs) == ESP_OK)
+            ledc_fade_start(mode, ledcChannel, LEDC_FADE_NO_WAIT);
+        else
+            ledcWrite(channel, duty);
+    }
+};
+
+class ArduinoDigitalOutput : public DigitalOutput
+{
+public:
+    void write(uint8_t pin, bool high) override { digitalWrite(pin, high ? HIGH : LOW); }
+    bool read(uint8_t pin) override { return digitalRead(pin) == HIGH; }
+};
+
+class Ds3231Clock : public RtcClock
+{
+public:
+    bool refresh() override { return rtc.refresh(); }
+    bool lostPower() override { return rtc.lostPower(); }
+    void lostPowerClear() override { rtc.lostPowerClear(); }
+    void set(uint8_t second, uint8_t minute, uint8_t hour, uint8_t dayOfWeek,
+             uint8_t day, uint8_t month, uint8_t year) override
+    {
+        rtc.set(second, minute, hour, dayOfWeek, day, month, year);
+    }
+    bool enableSecondPulse() override { return rtc.sqwgSetMode(URTCLIB_SQWG_1H); }
+
+    uint8_t year() override { return rtc.year(); }
+    uint8_t month() override { return rtc.month(); }
+    uint8_t day() override { return rtc.day(); }
+    uint8_t dayOfWeek() override { return rtc.dayOfWeek(); }
+    uint8_t hour() override { return rtc.hour(); }
+    uint8_t minute() override { return rtc.minute(); }
+    uint8_t second() override { return rtc.second(); }
+};
+
+class ArduinoSystemClock : public SystemClock
+{
+public:
+    unsigned long millis() override { return ::millis(); }
+    void delay(unsigned long ms) override { ::delay(ms); }
+};
+
+class DfPlayerSerial : public AudioSerial
+{
+public:
+    void begin() override
+    {
+        if (serialStarted)
+            return;
+
+        myDFPlayerSerial.begin(9600, SERIAL_8N1, DFPLAYER_RX_PIN, DFPLAYER_TX_PIN);
+        myDFPlayerSerial.onReceive(wakeMainLoop); // Balasan/event DFPlayer membangunkan loop()
+        serialStarted = true;
+    }
+
+    // Frame 10 byte selalu muat di TX FIFO UART (128 byte)
+    size_t write(const uint8_t *data, size_t len) override { return myDFPlayerSerial.write(data, len); }
+    int read() override { return myDFPlayerSerial.read(); }
+
+private:
+    bool serialStarted = false;
+};
+
+class NvsKeyValueStore : public KeyValueStore
+{
+public:
+    bool begin(const char *name, bool readOnly) override { return preferences.begin(name, readOnly); }
+    void end() override { preferences.end(); }
+    bool isKey(const char *key) override { return preferences.isKey(key); }
+    size_t putBytes(const char *key, const void *value, size_t len) override { return preferences.putBytes(key, value, len); }
+    size_t getBytes(const char *key, void *buf, size_t maxLen) override { return preferences.getBytes(key, buf, maxLen); }
+    bool remove(const char *key) override { return preferences.remove(key); }
+};
+
+/**
+ * Buffer pesan dipakai bersama oleh semua client tujuan (reference-counted
+ * oleh AsyncWebSocket). Selama tidak ada client yang masih mengantri pesan
+ * sebelumnya (use_count() == 1), buffer yang sama dipakai ulang sehingga
+ * pengiriman tidak mengalokasi heap. Jika masih dipakai, dibuat buffer baru.
+ *
+ * Daftar client milik AsyncWebSocket diubah oleh task AsyncTCP, jadi
+ * loop() tidak pernah menelusuri ws.getClients(). Registry id -> client di
+ * bawah ini diisi dari WS_EVT_CONNECT / WS_EVT_DISCONNECT dengan mutex yang
+ * sama: selama loop() memakai pointer client, event disconnect (dan
+ * penghapusan client oleh library sesudahnya) menunggu.
+ */
+class AsyncWebSocketBroadcaster : public SocketBroadcaster
+{
+public:
+    void clientConnected(AsyncWebSocketClient *client)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (registered < SOCKET_MAX_CLIENTS)
+            registry[registered++] = {client->id(), client};
+        // Penuh: client tidak menerima broadcast sampai ws.cleanupClients() menutupnya
+    }
+
+    void clientDisconnected(uint32_t id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < registered; i++)
+        {
+            if (registry[i].id == id)
+            {
+                registry[i] = registry[--registered];
+                break;
+            }
+        }
+    }
+
+    size_t listClients(SocketClientInfo *clients, size_t max) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t count = 0;
+        for (size_t i = 0; i < registered; i++)
+        {
+            AsyncWebSocketClient *client = registry[i].client;
+            if (client->status() != WS_CONNECTED)
+                continue;
+            if (count < max)
+            {
+                clients[count].id = registry[i].id;
+                clients[count].queued = client->queueLen();
+            }
+            count++;
+        }
+        return count;
+    }
+
+    void textTo(const uint32_t *clientIds, size_t count, const char *message, size_t len) override
+    {
+        if (count == 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!pooled || pooled.use_count() > 1)
+        {
+            pooled = std::make_shared<std::vector<uint8_t>>();
+            pooled->reserve(OUTBOUND_JSON_CAPACITY);
+        }
+
+        pooled->assign((const uint8_t *)message, (const uint8_t *)message + len);
+        for (size_t i = 0; i < count; i++)
+        {
+            AsyncWebSocketClient *client = find(clientIds[i]);
+            if (client)
+                client->text(pooled);
+        }
+    }
+
+private:
+    struct RegisteredClient
+    {
+        uint32_t id;
+        AsyncWebSocketClient *client; // Valid sampai clientDisconnected(id)
+    };
+
+    AsyncWebSocketClient *find(uint32_t id)
+    {
+        for (size_t i = 0; i < registered; i++)
+        {
+            if (registry[i].id == id)
+                return registry[i].client;
+        }
+        return nullptr;
+    }
+
+    RegisteredClient registry[SOCKET_MAX_CLIENTS];
+    size_t registered = 0;
+    AsyncWebSocketSharedBuffer pooled;
+    std::mutex mutex; // Registry + pooled
+};
+
+class StationWifiLink : public WifiLink
+{
+public:
+    void begin() override
+    {
+        WiFi.persistent(false);       // Kredensial dari firmware, tidak perlu ditulis ke NVS tiap begin()
+        WiFi.setAutoReconnect(false); // Reconnect diatur wifi_manager.cpp (backoff + cache BSSID)
+        WiFi.mode(WIFI_STA);
+    }
+    void connect(const char *ssid, const char *password, const uint8_t *bssid, uint8_t channel) override
+    {
+        WiFi.begin(ssid, password, channel, bssid);
+    }
+    void disconnect() override { WiFi.disconnect(); }
+    int rssi() override { return WiFi.isConnected() ? WiFi.RSSI() : 0; }
+};
+
+// =================================================================
+// HAL INSTANCE
+// =================================================================
+
+static LedcPwmOutput pwmOutput;
+static ArduinoDigitalOutput digitalOutput;
+static Ds3231Clock rtcClock;
+static ArduinoSystemClock systemClock;
+static DfPlayerSerial audioSerial;
+static NvsKeyValueStore keyValueStore;
+static AsyncWebSocketBroadcaster socketBroadcaster;
+static StationWifiLink wifiLink;
+
+Hal hal = {
+    &pwmOutput,
+    &digitalOutput,
+    &rtcClock,
+    &systemClock,
+    &audioSerial,
+    &keyValueStore,
+    &socketBroadcaster,
+    &wifiLink,
+};
+
+// Dari onEvent() di main.cpp (task AsyncTCP)
+void webSocketClientConnected(AsyncWebSocketClient *client)
+{
+    socketBroadcaster.clientConnected(client);
+}
+
+void webSocketClientDisconnected(uint32_t id)
+{
+    socketBroadcaster.clientDisconnected(id);
+}
@@ -0,0 +1,318 @@
+/**
+ * @file hal_native.cpp
+ * @brief Swell Smart Lamp - Fake hal.h untuk env:native (Linux)
+ */
+
+#ifndef ARDUINO
+
+#include "hal_native.h"
+
+#include <string.h>
+
+#include "audio_driver.h"
+#include "wall_clock.h"
+#include "wifi_manager.h"
+
+bool swellNativeLogEnabled = false;
+
+NativeFakes nativeFakes;
+
+Hal hal = {
+    &nativeFakes.pwm,
+    &nativeFakes.gpio,
+    &nativeFakes.rtc,
+    &nativeFakes.clock,
+    &nativeFakes.audio,
+    &nativeFakes.store,
+    &nativeFakes.sockets,
+    &nativeFakes.wifi,
+};
+
+// =================================================================
+// PWM & GPIO
+// =================================================================
+
+void FakePwmOutput::checkIdle(uint8_t channel)
+{
+    if ((long)(clock.millis() - fadeEnd[channel]) < 0)
+        conflicts++;
+}
+
+void FakePwmOutput::write(uint8_t channel, uint32_t value)
+{
+    if (channel < sizeof(duty) / sizeof(duty[0]))
+    {
+        checkIdle(channel);
+        duty[channel] = value;
+    }
+    writes++;
+}
+
+void FakePwmOutput::fade(uint8_t channel, uint32_t value, uint32_t durationMs)
+{
+    if (channel < sizeof(duty) / sizeof(duty[0]))
+    {
+        checkIdle(channel);
+        duty[channel] = value;
+        fadeEnd[channel] = clock.millis() + durationMs;
+    }
+    writes++;
+    fades++;
+}
+
+void FakeDigitalOutput::write(uint8_t pin, bool high)
+{
+    if (pin < sizeof(level))
+        level[pin] = high;
+    writes++;
+}
+
+bool FakeDigitalOutput::read(uint8_t pin)
+{
+    return pin < sizeof(level) ? level[pin] : false;
+}
+
+// =================================================================
+// RTC (kalender dari wall_clock.cpp)
+// =================================================================
+
+bool FakeRtcClock::refresh()
+{
+    refreshes++;
+
+    long long elapsedMs = (long long)(clock.now - nowAtSet);
+    long long now = epochAtSet + (elapsedMs + elapsedMs * driftPpm / 1000000) / 1000;
+    long long days = now / 86400;
+    long seconds = (long)(now % 86400);
+
+    int y;
+    unsigned m, d;
+    civilFromDays(days, y, m, d);
+
+    yearValue = (uint8_t)(y - 2000);
+    monthValue = (uint8_t)m;
+    dayValue = (uint8_t)d;
+    dayOfWeekValue = (uint8_t)((days + 6) % 7 + 1); // 2000-01-01 = Sabtu (7)
+    hourValue = (uint8_t)(seconds / 3600);
+    minuteValue = (uint8_t)(seconds / 60 % 60);
+    secondValue = (uint8_t)(seconds % 60);
+    return true;
+}
+
+void FakeRtcClock::set(uint8_t second, uint8_t minute, uint8_t hour, uint8_t dayOfWeek,
+                       uint8_t day, uint8_t month, uint8_t year)
+{
+    (void)dayOfWeek;
+    epochAtSet = daysFromCivil(2000 + year, month, day) * 86400 + hour * 3600L + minute * 60L + second;
+    nowAtSet = clock.now;
+    refresh();
+}
+
+// =================================================================
+// AUDIO
+// =================================================================
+
+size_t FakeAudioSerial::write(const uint8_t *data, size_t len)
+{
+    if (!present || len != AUDIO_FRAME_SIZE)
+        return len;
+
+    uint8_t command = data[3];
+    uint16_t param = (uint16_t)((data[5] << 8) | data[6]);
+
+    switch (command)
+    {
+    case DFPLAYER_CMD_RESET:
+        playing = false;
+        reply(DFPLAYER_EVT_ONLINE, 0x02); // TF card online
+        return len;
+    case DFPLAYER_CMD_PLAY:
+        track = param;
+        playing = true;
+        break;
+    case DFPLAYER_CMD_STOP:
+        playing = false;
+        break;
+    case DFPLAYER_CMD_VOLUME:
+        level = param;
+        break;
+    default:
+        break;
+    }
+
+    commands++;
+    if (data[4])
+        reply(DFPLAYER_EVT_ACK, 0);
+    return len;
+}
+
+int FakeAudioSerial::read()
+{
+    if (rx.empty())
+        return -1;
+
+    uint8_t value = rx.front();
+    rx.pop_front();
+    return value;
+}
+
+void FakeAudioSerial::reply(uint8_t command, uint16_t param)
+{
+    uint8_t frame[AUDIO_FRAME_SIZE];
+    encodeAudioFrame(command, param, false, frame);
+    rx.insert(rx.end(), frame, frame + sizeof(frame));
+}
+
+// =================================================================
+// KEY-VALUE STORE
+// =================================================================
+
+bool FakeKeyValueStore::begin(const char *name, bool ro)
+{
+    ns = name;
+    opened = true;
+    readOnly = ro;
+    return true;
+}
+
+bool FakeKeyValueStore::isKey(const char *key)
+{
+    return opened && entries.count(ns + "/" + key) != 0;
+}
+
+size_t FakeKeyValueStore::putBytes(const char *key, const void *value, size_t len)
+{
+    if (!opened || readOnly || failWrites)
+        return 0;
+
+    const uint8_t *bytes = static_cast<const uint8_t *>(value);
+    entries[ns + "/" + key].assign(bytes, bytes + len);
+    writes++;
+    bytesWritten += len;
+    return len;
+}
+
+size_t FakeKeyValueStore::getBytes(const char *key, void *buf, size_t maxLen)
+{
+    if (!opened)
+        return 0;
+
+    auto it = entries.find(ns + "/" + key);
+    if (it == entries.end() || it->second.size() > maxLen)
+        return 0;
+
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+bool FakeKeyValueStore::remove(const char *key)
+{
+    if (!opened || readOnly)
+        return false;
+    return entries.erase(ns + "/" + key) != 0;
+}
+
+// =================================================================
+// WEBSOCKET
+// =================================================================
+
+size_t FakeSocketBroadcaster::listClients(SocketClientInfo *out, size_t max)
+{
+    for (size_t i = 0; i < clients.size() && i < max; i++)
+    {
+        out[i].id = clients[i].id;
+        out[i].queued = clients[i].queued;
+    }
+    return clients.size();
+}
+
+void FakeSocketBroadcaster::textTo(const uint32_t *clientIds, size_t count, const char *message, size_t len)
+{
+    if (count == 0)
+        return;
+
+    if (keepLastMessage)
+        lastMessage.assign(message, len);
+    messages++;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        for (FakeSocketClient &client : clients)
+        {
+            if (client.id != clientIds[i])
+                continue;
+            if (client.drainPerSecond > 0)
+                client.queued++; // 0 = antrian langsung kosong
+            client.received++;
+            deliveries++;
+            bytesSent += len;
+        }
+    }
+}
+
+void FakeSocketBroadcaster::drain(unsigned long elapsedMs)
+{
+    for (FakeSocketClient &client : clients)
+    {
+        if (client.drainPerSecond == 0)
+        {
+            client.queued = 0;
+            continue;
+        }
+
+        client.drainCredit += elapsedMs * client.drainPerSecond;
+        size_t sent = client.drainCredit / 1000;
+        client.drainCredit -= sent * 1000;
+        client.queued -= sent < client.queued ? sent : client.queued;
+        if (client.queued == 0)
+            client.drainCredit = 0;
+    }
+}
+
+// =================================================================
+// WIFI
+// =================================================================
+
+// wifi_err_reason_t ESP-IDF
+const uint8_t REASON_ASSOC_LEAVE = 8;
+const uint8_t REASON_BEACON_TIMEOUT = 200;
+const uint8_t REASON_NO_AP_FOUND = 201;
+
+void FakeWifiLink::connect(const char *, const char *, const uint8_t *bssid, uint8_t channel)
+{
+    if (bssid)
+        directJoins++;
+    else
+        scans++;
+
+    bool sameAp = !bssid || (memcmp(bssid, accessPointBssid, sizeof(accessPointBssid)) == 0 && channel == accessPointChannel);
+    if (!accessPointUp || !sameAp)
+    {
+        wifiLinkDisconnected(REASON_NO_AP_FOUND);
+        return;
+    }
+
+    linked = true;
+    wifiLinkConnected(accessPointBssid, accessPointChannel);
+    wifiLinkGotIp();
+}
+
+void FakeWifiLink::disconnect()
+{
+    if (!linked)
+        return;
+    linked = false;
+    wifiLinkDisconnected(REASON_ASSOC_LEAVE);
+}
+
+void FakeWifiLink::setAccessPoint(bool up)
+{
+    accessPointUp = up;
+    if (!up && linked)
+    {
+        linked = false;
+        wifiLinkDisconnected(REASON_BEACON_TIMEOUT);
+    }
+}
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ * @file json_writer.cpp
+ * @brief Swell Smart Lamp - Serializer JSON streaming ke buffer tetap (tanpa heap)
+ */
+
+#include "json_writer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "socket_fanout.h"
+#include "swell_log.h"
+
+JsonWriter::JsonWriter(char *buffer, size_t capacity)
+    : buffer(buffer), capacity(capacity)
+{
+    if (capacity == 0)
+        overflow = true;
+    else
+        buffer[0] = '\0';
+}
+
+// =================================================================
+// LOW-LEVEL OUTPUT
+// =================================================================
+
+void JsonWriter::putRaw(const char *text, size_t count)
+{
+    if (overflow)
+        return;
+
+    // Sisakan 1 byte untuk terminator
+    if (len + count + 1 > capacity)
+    {
+        overflow = true;
+        return;
+    }
+
+    memcpy(buffer + len, text, count);
+    len += count;
+    buffer[len] = '\0';
+}
+
+void JsonWriter::putChar(char c)
+{
+    putRaw(&c, 1);
+}
+
+void JsonWriter::putString(const char *text)
+{
+    putChar('"');
+    for (const char *p = text ? text : ""; *p; p++)
+    {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\')
+        {
+            char escaped[2] = {'\\', (char)c};
+            putRaw(escaped, 2);
+        }
+        else if (c < 0x20)
+        {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            putRaw(escaped, 6);
+        }
+        else
+        {
+            putChar((char)c);
+        }
+    }
+    putChar('"');
+}
+
+void JsonWriter::separator(const char *key)
+{
+    if (depth > 0)
+    {
+        if (hasItems[depth - 1])
+            putChar(',');
+        hasItems[depth - 1] = true;
+    }
+
+    if (key)
+    {
+        putString(key);
+        putChar(':');
+    }
+}
+
+void JsonWriter::open(char bracket, const char *key)
+{
+    separator(key);
+    if (depth >= JSON_WRITER_MAX_DEPTH)
+    {
+        overflow = true;
+        return;
+    }
+
+    putChar(bracket);
+    hasItems[depth++] = false;
+}
+
+void JsonWriter::close(char bracket)
+{
+    if (depth == 0)
+    {
+        overflow = true;
+        return;
+    }
+
+    depth--;
+    putChar(bracket);
+}
+
+// =================================================================
+// PUBLIC API
+// =================================================================
+
+JsonWriter &JsonWriter::beginObject(const char *key)
+{
+    open('{', key);
+    return *this;
+}
+
+JsonWriter &JsonWriter::endObject()
+{
+    close('}');
+    return *this;
+}
+
+JsonWriter &JsonWriter::beginArray(const char *key)
+{
+    open('[', key);
+    return *this;
+}
+
+JsonWriter &JsonWriter::endArray()
+{
+    close(']');
+    return *this;
+}
+
+JsonWriter &JsonWriter::add(const char *key, const char *value)
+{
+    separator(key);
+    putString(value);
+    return *this;
+}
+
+JsonWriter &JsonWriter::add(const char *key, bool value)
+{
+    separator(key);
+    if (value)
+        putRaw("true", 4);
+    else
+        putRaw("false", 5);
+    return *this;
+}
+
+JsonWriter &JsonWriter::add(const char *key, int value)
+{
+    return add(key, (long)value);
+}
+
+JsonWriter &JsonWriter::add(const char *key, unsigned int value)
+{
+    return add(key, (unsigned long)value);
+}
+
+JsonWriter &JsonWriter::add(const char *key, long value)
+{
+    char number[24];
+    int count = snprintf(number, sizeof(number), "%ld", value);
+    separator(key);
+    putRaw(number, (size_t)count);
+    return *this;
+}
+
+JsonWriter &JsonWriter::add(const char *key, unsigned long value)
+{
+    char number[24];
+    int count = snprintf(number, sizeof(number), "%lu", value);
+    separator(key);
+    putRaw(number, (size_t)count);
+    return *this;
+}
+
+JsonWriter &JsonWriter::add(const char *key, long long value)
+{
+    char number[24];
+    int count = snprintf(number, sizeof(number), "%lld", value);
+    separator(key);
+    putRaw(number, (size_t)count);
+    return *this;
+}
+
+// =================================================================
+// KIRIM (BROADCAST / BALASAN KE SATU CLIENT)
+// =================================================================
+
+void sendJson(const JsonWriter &json, uint32_t clientId)
+{
+    if (json.overflowed())
+    {
+        SWELL_LOGE(LOG_WS, "❌ Pesan JSON melebihi buffer (%u byte), tidak dikirim", (unsigned)OUTBOUND_JSON_CAPACITY);
+        return;
+    }
+
+    sendToClients(clientId, json.c_str(), json.length());
+}
+
+void broadcastJson(const JsonWriter &json)
+{
+    sendJson(json, SOCKET_ALL_CLIENTS);
+}
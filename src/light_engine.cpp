@@ -0,0 +1,210 @@
+/**
+ * @file light_engine.cpp
+ * @brief Swell Smart Lamp - Lampu LED: dimming perseptual + fade di hardware LEDC
+ */
+
+#include "light_engine.h"
+
+#include <stddef.h>
+
+#include "actuators.h"
+#include "hal.h"
+#include "swell_core.h"
+
+static_assert(PWM_RESOLUTION >= 8 && PWM_RESOLUTION <= 16, "Tabel gamma memakai duty 16 bit");
+
+// =================================================================
+// ⭐ TABEL GAMMA (CIE 1931 L*, dihitung saat compile)
+// =================================================================
+
+constexpr uint32_t PWM_MAX_DUTY = (1UL << PWM_RESOLUTION) - 1;
+constexpr uint32_t LIGHT_MAX_DUTY = PWM_MAX_DUTY * SWELL_LED_MAX_DUTY_8BIT / 255;
+
+static_assert(SWELL_LED_MAX_DUTY_8BIT >= 1 && SWELL_LED_MAX_DUTY_8BIT <= 255, "SWELL_LED_MAX_DUTY_8BIT: 1-255");
+
+// Lightness L* (0-100) -> luminance relatif Y (0-1)
+constexpr double cieLuminance(double lightness)
+{
+    return lightness <= 8.0 ? lightness / 903.3
+                            : ((lightness + 16.0) / 116.0) * ((lightness + 16.0) / 116.0) * ((lightness + 16.0) / 116.0);
+}
+
+constexpr uint16_t gammaDuty(size_t level)
+{
+    // Level > 0 minimal duty 1 supaya lampu tidak mati di ujung redup
+    return level == 0 ? 0
+           : cieLuminance(level * 100.0 / LIGHT_LEVEL_MAX) * LIGHT_MAX_DUTY < 1.0
+               ? 1
+               : (uint16_t)(cieLuminance(level * 100.0 / LIGHT_LEVEL_MAX) * LIGHT_MAX_DUTY + 0.5);
+}
+
+template <size_t... Levels>
+struct LevelList
+{
+};
+
+template <size_t N, size_t... Levels>
+struct MakeLevelList : MakeLevelList<N - 1, N - 1, Levels...>
+{
+};
+
+template <size_t... Levels>
+struct MakeLevelList<0, Levels...>
+{
+    typedef LevelList<Levels...> type;
+};
+
+struct GammaTable
+{
+    uint16_t duty[LIGHT_LEVEL_MAX + 1];
+};
+
+template <size_t... Levels>
+constexpr GammaTable makeGammaTable(LevelList<Levels...>)
+{
+    return GammaTable{{gammaDuty(Levels)...}};
+}
+
+static constexpr GammaTable GAMMA = makeGammaTable(MakeLevelList<LIGHT_LEVEL_MAX + 1>::type());
+
+constexpr bool gammaMonotonic(size_t level)
+{
+    return level >= LIGHT_LEVEL_MAX || (GAMMA.duty[level] <= GAMMA.duty[level + 1] && gammaMonotonic(level + 1));
+}
+
+static_assert(GAMMA.duty[LIGHT_LEVEL_MAX] == LIGHT_MAX_DUTY, "Level maksimum harus tepat LIGHT_MAX_DUTY");
+static_assert(gammaMonotonic(0), "Tabel gamma harus naik monoton");
+
+uint16_t lightLevelForIntensity(int percent)
+{
+    if (percent <= 0)
+        return 0;
+    if (percent >= 100)
+        return LIGHT_LEVEL_MAX;
+    return (uint16_t)((percent * LIGHT_LEVEL_MAX + 50) / 100);
+}
+
+uint32_t lightDuty(uint16_t level)
+{
+    return GAMMA.duty[level > LIGHT_LEVEL_MAX ? LIGHT_LEVEL_MAX : level];
+}
+
+// =================================================================
+// FADE PER CHANNEL
+// =================================================================
+
+struct LightState
+{
+    uint16_t level = 0;      // Level di akhir segmen terakhir (LEDC mulai dari duty 0)
+    uint16_t fromLevel = 0;  // Awal fade yang sedang berjalan
+    uint16_t target = 0;
+    unsigned long fadeStart = 0;
+    unsigned long fadeMs = 0;
+    unsigned long busyUntil = 0; // Segmen hardware berjalan sampai
+};
+
+static const ActuatorOutput LIGHT_OUTPUTS[LIGHT_CHANNEL_COUNT] = {ACTUATOR_WHITE_LED, ACTUATOR_YELLOW_LED};
+
+static LightState channels[LIGHT_CHANNEL_COUNT];
+static LightStats stats;
+
+static bool segmentRunning(const LightState &state, unsigned long now)
+{
+    return (long)(now - state.busyUntil) < 0;
+}
+
+static void serviceChannel(LightChannel channel, unsigned long now)
+{
+    LightState &state = channels[channel];
+    if (state.level == state.target || segmentRunning(state, now))
+        return;
+
+    unsigned long elapsed = now - state.fadeStart;
+    if (elapsed >= state.fadeMs)
+    {
+        // Fade instan (atau waktunya sudah habis): langsung ke target
+        state.level = state.target;
+        setActuator(LIGHT_OUTPUTS[channel], lightDuty(state.level));
+        return;
+    }
+
+    unsigned long segmentMs = state.fadeMs - elapsed;
+    if (segmentMs > LIGHT_FADE_SEGMENT_MS)
+        segmentMs = LIGHT_FADE_SEGMENT_MS;
+
+    // Interpolasi di domain perseptual, linear (duty) hanya di dalam segmen
+    long span = (long)state.target - (long)state.fromLevel;
+    state.level = (uint16_t)(state.fromLevel + span * (long)(elapsed + segmentMs) / (long)state.fadeMs);
+    state.busyUntil = now + segmentMs;
+    stats.segments++;
+    fadeActuator(LIGHT_OUTPUTS[channel], lightDuty(state.level), segmentMs);
+}
+
+static bool setTarget(LightChannel channel, uint16_t level, unsigned long fadeMs, unsigned long now)
+{
+    LightState &state = channels[channel];
+    if (level > LIGHT_LEVEL_MAX)
+        level = LIGHT_LEVEL_MAX;
+    if (state.target == level)
+        return false;
+
+    bool running = segmentRunning(state, now);
+    if (running)
+        stats.deferred++;
+
+    state.fromLevel = state.level;
+    state.target = level;
+    state.fadeStart = running ? state.busyUntil : now;
+    state.fadeMs = fadeMs;
+    return true;
+}
+
+// =================================================================
+// PUBLIC API
+// =================================================================
+
+void setLightScene(uint16_t whiteLevel, uint16_t yellowLevel, unsigned long fadeMs)
+{
+    unsigned long now = hal.clock->millis();
+    bool changed = setTarget(LIGHT_WHITE, whiteLevel, fadeMs, now);
+    changed = setTarget(LIGHT_YELLOW, yellowLevel, fadeMs, now) || changed;
+    if (!changed)
+        return;
+
+    stats.scenes++;
+    serviceLight();
+}
+
+uint16_t lightLevel(LightChannel channel)
+{
+    return channels[channel].target;
+}
+
+void serviceLight()
+{
+    unsigned long now = hal.clock->millis();
+    for (int i = 0; i < LIGHT_CHANNEL_COUNT; i++)
+        serviceChannel((LightChannel)i, now);
+}
+
+unsigned long millisUntilLightService()
+{
+    unsigned long now = hal.clock->millis();
+    unsigned long earliest = LIGHT_NO_DEADLINE;
+    for (int i = 0; i < LIGHT_CHANNEL_COUNT; i++)
+    {
+        const LightState &state = channels[i];
+        if (state.level == state.target)
+            continue;
+
+        unsigned long wait = segmentRunning(state, now) ? state.busyUntil - now : 0;
+        if (wait < earliest)
+            earliest = wait;
+    }
+    return earliest;
+}
+
+const LightStats &lightStats()
+{
+    return stats;
+}
@@ -15,6 +15,31 @@
  * - Website sebagai setting skenario, bukan trigger sensor
  * - User bisa set toggle kapan saja, hardware mengikuti schedule otomatis
  *
+ * Struktur source:
+ * - main.cpp       : WiFi, web server, SPIFFS, setup() & loop()
+ * - swell_core.cpp : Settings, scheduler, music/aroma/alarm, command path
+ * - settings_store.cpp   : Persistence UserSettings (write-behind, record ber-CRC)
+ * - status_broadcast.cpp : Broadcast status (statusUpdate / statusPatch)
+ * - json_writer.cpp      : Serializer JSON ke buffer tetap untuk pesan keluar
+ * - command_queue.cpp    : Antrian command AsyncTCP -> loop() (lock-free SPSC)
+ * - command_table.cpp    : Tabel command (nama, skema argumen, gating), lookup hash O(1)
+ * - audio_driver.cpp     : Driver DFPlayer non-blocking (antrian frame, ACK/timeout)
+ * - actuators.cpp        : LED PWM + GPIO aromatherapy, hanya ditulis saat berubah
+ * - light_engine.cpp     : Dimming gamma CIE L* + fade sunset/sunrise di unit fade LEDC
+ * - wall_clock.cpp       : Jam software (millis + anchor), didisiplinkan DS3231
+ * - binary_protocol.cpp  : Framing biner opsional untuk command WebSocket
+ * - ws_reassembly.cpp    : Susun ulang pesan WebSocket terpecah (buffer statis, dibatasi)
+ * - socket_fanout.cpp    : Balasan ke client penanya, batas antrian kirim per client
+ * - swell_log.cpp        : Log berlevel ke ring buffer, dikuras ke Serial oleh task sendiri
+ * - metrics.cpp          : Counter/histogram runtime untuk GET /metrics dan getMetrics
+ * - boot_sequence.cpp    : Stage boot paralel (WiFi, SPIFFS, DFPlayer, ...) + durasi per stage
+ * - wifi_manager.cpp     : Koneksi WiFi event-driven, reconnect + backoff, cache BSSID/channel
+ * - hal_esp32.cpp  : Implementasi hal.h untuk ESP32 (LEDC, DS3231, DFPlayer, NVS)
+ * - hal_native.cpp : Fake hal.h untuk env:native (Linux, benchmark/profiling)
+ *
+ * Web assets (data/) diproses scripts/build_web_assets.py: gzip + ETag di
+ * SPIFFS, atau di-embed ke flash dengan -D SWELL_EMBED_WEB_ASSETS.
+ *
  * =================================================================
  */
 
@@ -25,11 +50,30 @@
 #include <WiFi.h>
 #include <ESPAsyncWebServer.h>
 #include <ArduinoJson.h>
-#include <Preferences.h>
 #include <SPIFFS.h>
-#include <DFRobotDFPlayerMini.h>
-#include <uRTCLib.h>
 #include <Wire.h>
+#include <driver/ledc.h>
+
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+#include "audio_driver.h"
+#include "boot_sequence.h"
+#include "light_engine.h"
+#include "metrics.h"
+#include "settings_store.h"
+#include "status_broadcast.h"
+#include "swell_core.h"
+#include "swell_log.h"
+#include "wall_clock.h"
+#include "web_assets.h"
+#include "wifi_manager.h"
+#include "ws_reassembly.h"
+
+#ifdef SWELL_EMBED_WEB_ASSETS
+#include "web_assets_embedded.h" // Dihasilkan scripts/build_web_assets.py
+#endif
 
 // =================================================================
 // KONFIGURASI SISTEM
@@ -38,1126 +82,640 @@
 const char *ssid = "hosssposs";
 const char *password = "semogalancarTA";
 
-const int WHITE_LED_PIN = 12;
-const int YELLOW_LED_PIN = 14;
-const int AROMATHERAPY_PIN = 4;
-const int DFPLAYER_RX_PIN = 16;
-const int DFPLAYER_TX_PIN = 17;
-
-const int PWM_CHANNEL_WHITE = 0;
-const int PWM_CHANNEL_YELLOW = 1;
-const int PWM_FREQUENCY = 100;
-const int PWM_RESOLUTION = 8;
-
-// =================================================================
-// FIXED PLAYLIST CONFIGURATION
-// =================================================================
-
-struct MusicTrack
-{
-    int trackNumber;
-    String title;
-    String filename;
-};
-
-const MusicTrack RELAX_PLAYLIST[] = {
-    {1, "AYAT KURSI", "0001_Relax_AYAT_KURSI.mp3"},
-    {2, "FAN", "0002_Relax_FAN.mp3"},
-    {3, "FROG", "0003_Relax_FROG.mp3"},
-    {4, "OCEAN WAVES", "0004_Relax_OCEAN_WAVES.mp3"},
-    {6, "RAINDROP", "0006_Relax_RAINDROP.mp3"},
-    {7, "RIVER", "0007_Relax_RIVER.mp3"},
-    {8, "VACUUM CLEANER", "0008_Relax_VACUM_CLEANER.mp3"},
-};
-
-const int RELAX_PLAYLIST_SIZE = sizeof(RELAX_PLAYLIST) / sizeof(RELAX_PLAYLIST[0]);
-const int ALARM_TRACK_NUMBER = 5;
-
 // =================================================================
 // GLOBAL OBJECTS & VARIABLES
 // =================================================================
 
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
-Preferences preferences;
-uRTCLib rtc(0x68);
-
-HardwareSerial myDFPlayerSerial(2);
-DFRobotDFPlayerMini myDFPlayer;
-bool dfPlayerInitialized = false;
-
-// =================================================================
-// ⭐ FIXED: NEW SETTINGS STRUCTURE - SEPARATED USER CONFIG & EXECUTION STATE
-// =================================================================
-
-/**
- * @brief User Settings - Persistent configuration yang disimpan di flash
- * @note Ini adalah konfigurasi user yang TIDAK berubah otomatis oleh scheduler
- */
-struct UserSettings
-{
-    struct Timer
-    {
-        bool on = false;        // Timer toggle ON/OFF
-        bool confirmed = false; // Timer sudah dikonfirmasi
-        int startHour = 21;     // Jam mulai sleep phase
-        int startMinute = 0;    // Menit mulai sleep phase
-        int endHour = 4;        // Jam selesai sleep phase
-        int endMinute = 0;      // Menit selesai sleep phase
-    } timer;
-
-    struct Light
-    {
-        int intensity = 50; // Yellow light intensity 0-100%
-    } light;
-
-    // ⭐ FIXED: User scenario settings (TIDAK auto-disable)
-    struct Aromatherapy
-    {
-        bool enabled = false; // User setting: apakah aromatherapy akan aktif saat timer?
-    } aromatherapy;
-
-    struct Alarm
-    {
-        bool enabled = false;                 // User setting: apakah alarm akan aktif?
-        const int track = ALARM_TRACK_NUMBER; // Fixed ke track 5
-    } alarm;
-
-    struct Music
-    {
-        bool enabled = false; // User setting: apakah music akan aktif saat timer?
-        int track = 1;        // Selected track
-        int volume = 15;      // Volume level 0-30
-    } music;
-};
-
-/**
- * @brief Execution State - Runtime status hardware (TIDAK disimpan di flash)
- * @note Ini adalah status real-time hardware yang berubah sesuai schedule
- */
-struct ExecutionState
-{
-    // Hardware execution status (real-time, tidak persistent)
-    bool aromatherapyActive = false; // Apakah aromatherapy sedang jalan sekarang?
-    bool musicActive = false;        // Apakah music sedang play sekarang?
-    bool alarmActive = false;        // Apakah alarm sedang bunyi sekarang?
-
-    // Timing states
-    bool inTimerWindow = false;       // Apakah sekarang dalam timer window?
-    bool inMusicWindow = false;       // Apakah sekarang dalam music window (1 jam pertama)?
-    unsigned long musicStartTime = 0; // Kapan music mulai play
-    unsigned long aromaStartTime = 0; // Kapan aromatherapy mulai
-};
-
-// ⭐ FIXED: Global instances
-UserSettings userSettings;     // User configuration (persistent)
-ExecutionState executionState; // Hardware state (runtime only)
 
 // =================================================================
 // TIMING & STATE MANAGEMENT VARIABLES
 // =================================================================
 
-unsigned long lastAromatherapyCheck = 0;
-unsigned long aromatherapyOnTime = 0;
-bool isAromatherapySpraying = false;
-unsigned long lastAromatherapySprayStart = 0;
-
-unsigned long lastTimeCheck = 0;
 unsigned long lastStatusBroadcast = 0;
 const unsigned long STATUS_BROADCAST_INTERVAL = 60000;
+const unsigned long LOOP_MAX_SLEEP_MS = 10000; // ws.cleanupClients() tetap jalan berkala
 
-unsigned long lastRTCBroadcast = 0;
-const unsigned long RTC_BROADCAST_INTERVAL = 30000;
-
-unsigned long alarmStopTime = 0;
-bool isAlarmPlaying = false;
-
-bool isMusicPaused = false;
-bool previousMusicState = false;
-unsigned long musicStartTime = 0;
-const unsigned long MUSIC_GRACE_PERIOD = 5000;
-unsigned long musicPlayStartTime = 0;
-const unsigned long MUSIC_MAX_DURATION = 3600000;
+// loop() tidur di ulTaskNotifyTake() sampai deadline berikutnya,
+// wakeMainLoop() (dari task AsyncTCP) membangunkannya lebih awal
+TaskHandle_t mainLoopTask = nullptr;
 
-// RTC timing variables
-unsigned long rtcTimeOffset = 0;
-unsigned long rtcTimeReceived = 0;
-unsigned long rtcTimeReceivedAt = 0;
+// Automatic light sleep butuh LEDC dengan clock yang tetap jalan saat sleep
+// (RTC8M, terlalu lambat untuk 1 kHz x 16 bit), jadi default hanya DFS (CPU turun ke 80 MHz saat idle)
+#ifndef SWELL_LIGHT_SLEEP
+#define SWELL_LIGHT_SLEEP 0
+#endif
 
 // =================================================================
-// COMPILE-TIME FUNCTIONS UNTUK RTC SETUP
+// STATIC ROUTE TABLE
 // =================================================================
 
-int getCompileDayOfWeek(const char *ts)
+struct StaticRoute
 {
-    if (ts[0] == 'S' && ts[1] == 'u')
-        return 1; // Sunday
-    if (ts[0] == 'M' && ts[1] == 'o')
-        return 2; // Monday
-    if (ts[0] == 'T' && ts[1] == 'u')
-        return 3; // Tuesday
-    if (ts[0] == 'W' && ts[1] == 'e')
-        return 4; // Wednesday
-    if (ts[0] == 'T' && ts[1] == 'h')
-        return 5; // Thursday
-    if (ts[0] == 'F' && ts[1] == 'r')
-        return 6; // Friday
-    if (ts[0] == 'S' && ts[1] == 'a')
-        return 7; // Saturday
-    return 0;
-}
+    const char *url;         // URL yang diminta browser
+    const char *path;        // Asset di SPIFFS / tabel embedded
+    const char *contentType; // MIME type
+};
 
-int getCompileMonth(const char *date)
+// ⚠️ Harus urut berdasarkan url (strcmp), dicari dengan binary search
+const StaticRoute STATIC_ROUTES[] = {
+    {"/", "/index.html", "text/html"},
+    {"/index.html", "/index.html", "text/html"},
+    {"/logo.png", "/logo.png", "image/png"},
+    {"/swell-device-detail.html", "/swell-device-detail.html", "text/html"},
+    {"/swell-homepage.html", "/swell-homepage.html", "text/html"},
+    {"/swell-script.js", "/swell-script.js", "application/javascript"},
+    {"/swell-styles.css", "/swell-styles.css", "text/css"},
+};
+
+const int STATIC_ROUTE_COUNT = sizeof(STATIC_ROUTES) / sizeof(STATIC_ROUTES[0]);
+
+/** @brief Hasil resolve saat boot + counter per route */
+struct StaticRouteState
 {
-    if (date[0] == 'J' && date[1] == 'a' && date[2] == 'n')
-        return 1;
-    if (date[0] == 'F' && date[1] == 'e' && date[2] == 'b')
-        return 2;
-    if (date[0] == 'M' && date[1] == 'a' && date[2] == 'r')
-        return 3;
-    if (date[0] == 'A' && date[1] == 'p' && date[2] == 'r')
-        return 4;
-    if (date[0] == 'M' && date[1] == 'a' && date[2] == 'y')
-        return 5;
-    if (date[0] == 'J' && date[1] == 'u' && date[2] == 'n')
-        return 6;
-    if (date[0] == 'J' && date[1] == 'u' && date[2] == 'l')
-        return 7;
-    if (date[0] == 'A' && date[1] == 'u' && date[2] == 'g')
-        return 8;
-    if (date[0] == 'S' && date[1] == 'e' && date[2] == 'p')
-        return 9;
-    if (date[0] == 'O' && date[1] == 'c' && date[2] == 't')
-        return 10;
-    if (date[0] == 'N' && date[1] == 'o' && date[2] == 'v')
-        return 11;
-    if (date[0] == 'D' && date[1] == 'e' && date[2] == 'c')
-        return 12;
-    return 0;
-}
+    bool available;
+    bool gzip;     // Tersimpan sebagai <path>.gz
+    char etag[24]; // Termasuk tanda kutip, kosong jika tanpa manifest
+#ifdef SWELL_EMBED_WEB_ASSETS
+    const EmbeddedWebAsset *embedded;
+#endif
+    unsigned long hits;
+    unsigned long notModified; // Dibalas 304
+};
+
+StaticRouteState staticRouteStates[STATIC_ROUTE_COUNT];
+unsigned long staticNotFound = 0;
 
-#define CONV_STR2DEC_2(str, i) ((str[i] - '0') * 10 + (str[i + 1] - '0'))
-#define __TIME_SECONDS__ CONV_STR2DEC_2(__TIME__, 6)
-#define __TIME_MINUTES__ CONV_STR2DEC_2(__TIME__, 3)
-#define __TIME_HOURS__ CONV_STR2DEC_2(__TIME__, 0)
-#define __TIME_DOW__ getCompileDayOfWeek(__TIMESTAMP__)
-#define __TIME_DAYS__ CONV_STR2DEC_2(__DATE__, 4)
-#define __TIME_MONTH__ getCompileMonth(__DATE__)
-#define __TIME_YEARS__ (2000 + CONV_STR2DEC_2(__DATE__, 9))
+const char *CACHE_IMMUTABLE = "public, max-age=31536000, immutable"; // URL dengan ?v=<hash> yang masih berlaku
+const char *CACHE_REVALIDATE = "no-cache";                            // Selalu cek ETag (304)
+const size_t ASSET_VERSION_LENGTH = 8; // ?v= = 8 hex pertama ETag (add_versions() di build_web_assets.py)
 
 // =================================================================
 // FUNCTION DECLARATIONS
 // =================================================================
 
-// ⭐ FIXED: Settings management dengan user settings
-void saveUserSettings();
-void loadUserSettings();
-
-// Hardware initialization
-void checkAndSetRTC();
-bool initializeDFPlayer();
-
-// Music system
-void generateAndSendPlaylist();
-int getValidMusicTrackNumber(int requestedTrack);
-void playMusicTrack(int trackNumber);
-void stopMusic();
-void setMusicVolume(int volume);
-
-// ⭐ FIXED: Scheduling system dengan execution state
-void checkAndApplySchedules();
-bool calculateInTimerWindow(int currentTime, int startTime, int endTime);
-bool isInMusicTimeWindow(int currentTimeInMinutes, int startTimeInMinutes);
-bool hasReached1HourLimit();
-
-// Aromatherapy system
-void handleAromatherapyExecution();
-void resetAromatherapy();
-
-// RTC system
-void sendRTCTime();
-bool calibrateRTC(JsonObject calibrationData);
-void broadcastRTCTime();
-
 // WebSocket communication
-void handleWebSocketMessage(void *arg, uint8_t *data, size_t len);
 void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
-void notifyClients();
+void webSocketClientConnected(AsyncWebSocketClient *client); // hal_esp32.cpp, registry hal.sockets
+void webSocketClientDisconnected(uint32_t id);
 
 // File serving
-String getContentType(String filename);
-void serveFileFromSPIFFS(AsyncWebServerRequest *request, String filename);
+int findStaticRoute(const char *url);
+void markStaticAsset(const char *path, bool gzip, const char *etag);
+bool loadAssetManifest();
+bool initializeWebAssets();
+bool replyNotModified(AsyncWebServerRequest *request, const char *etag, const char *cacheControl);
+const char *cacheControlFor(AsyncWebServerRequest *request, const StaticRoute &route, const StaticRouteState &state);
+void serveStaticRoute(AsyncWebServerRequest *request);
+void writePlatformMetrics(MetricsWriter &out);
 void setupWebServerRoutes();
-void initializeSPIFFS();
+bool initializeSPIFFS();
 
-// =================================================================
-// ⭐ FIXED: USER SETTINGS MANAGEMENT FUNCTIONS
-// =================================================================
-
-void saveUserSettings()
-{
-    preferences.begin("swell-app", false);
-    preferences.putBytes("userSettings", &userSettings, sizeof(userSettings));
-    preferences.end();
-    Serial.println("📁 User settings saved to flash memory.");
-}
-
-void loadUserSettings()
-{
-    preferences.begin("swell-app", true);
-
-    if (preferences.isKey("userSettings"))
-    {
-        preferences.getBytes("userSettings", &userSettings, sizeof(userSettings));
-        Serial.println("📁 User settings loaded from flash memory.");
-
-        // Validate settings
-        userSettings.music.track = getValidMusicTrackNumber(userSettings.music.track);
-        if (userSettings.music.volume > 30)
-            userSettings.music.volume = 15;
-        if (userSettings.music.volume < 0)
-            userSettings.music.volume = 5;
-    }
-    else
-    {
-        Serial.println("📁 No saved settings found, using defaults.");
-    }
-
-    preferences.end();
-}
+// Power management
+void wakeMainLoop();
+void configurePowerManagement();
 
 // =================================================================
-// HARDWARE INITIALIZATION FUNCTIONS
+// ⭐ FIXED: WEBSOCKET EVENT HANDLER
 // =================================================================
 
-void checkAndSetRTC()
+void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type,
+             void *arg, uint8_t *data, size_t len)
 {
-    rtc.refresh();
-    bool needsSetting = false;
-
-    if (rtc.lostPower())
-    {
-        Serial.println("⚠️ INFO: RTC kehilangan daya. Waktu akan diatur ulang ke compile time.");
-        rtc.lostPowerClear();
-        needsSetting = true;
-    }
-
-    uint8_t compileYear = (uint8_t)(__TIME_YEARS__ - 2000);
-    if (rtc.day() != __TIME_DAYS__ || rtc.month() != __TIME_MONTH__ || rtc.year() != compileYear)
-    {
-        Serial.println("⚠️ INFO: Tanggal RTC tidak akurat. Waktu akan dikalibrasi ke compile time.");
-        needsSetting = true;
-    }
-
-    if (needsSetting)
+    if (type == WS_EVT_CONNECT)
     {
-        rtc.set(__TIME_SECONDS__, __TIME_MINUTES__, __TIME_HOURS__, __TIME_DOW__,
-                __TIME_DAYS__, __TIME_MONTH__, compileYear);
-        Serial.println("✅ OK: Waktu RTC berhasil disetel ke compile time.");
+        SWELL_LOGI(LOG_WS, "🔗 WebSocket klien #%u terhubung", (unsigned)client->id());
+        webSocketClientConnected(client);
+        // Client sendiri yang meminta getStatus / getClockSync setelah connect
     }
-    else
+    else if (type == WS_EVT_DISCONNECT)
     {
-        Serial.println("✅ OK: Waktu RTC sudah akurat.");
+        SWELL_LOGI(LOG_WS, "🔌 WebSocket klien #%u terputus", (unsigned)client->id());
+        webSocketClientDisconnected(client->id()); // Sebelum library menghapus objek client
+        releaseWebSocketClient(client->id());
     }
-}
-
-bool initializeDFPlayer()
-{
-    Serial.println("=== DFPlayer Mini Initialization ===");
-    myDFPlayerSerial.begin(9600, SERIAL_8N1, DFPLAYER_RX_PIN, DFPLAYER_TX_PIN);
-    Serial.println("🔊 Menginisialisasi DFPlayer Mini... Mohon tunggu!");
-
-    int retryCount = 0;
-    while (retryCount < 3)
+    else if (type == WS_EVT_DATA)
     {
-        if (myDFPlayer.begin(myDFPlayerSerial))
+        // Pesan bisa datang terpecah (multi-paket / multi-frame): susun dulu,
+        // dengan batas WS_MESSAGE_MAX_SIZE per pesan
+        AwsFrameInfo *info = (AwsFrameInfo *)arg;
+        WsFragment fragment;
+        fragment.binary = info->message_opcode == WS_BINARY;
+        fragment.frameNumber = info->num;
+        fragment.finalFrame = info->final;
+        fragment.frameIndex = info->index;
+        fragment.frameLength = info->len;
+
+        const uint8_t *message;
+        size_t messageLen;
+        WsReassemblyResult result = reassembleWebSocketMessage(client->id(), fragment, data, len, message, messageLen);
+        if (result == WS_MESSAGE_INCOMPLETE)
+            return;
+        if (result == WS_MESSAGE_REJECTED)
         {
-            Serial.println("✅ DFPlayer Mini berhasil diinisialisasi!");
-            myDFPlayer.setTimeOut(500);
-            myDFPlayer.volume(userSettings.music.volume);
-            myDFPlayer.EQ(DFPLAYER_EQ_NORMAL);
-
-            Serial.printf("📻 DFPlayer Settings:\n");
-            Serial.printf("   - Volume: %d/30\n", userSettings.music.volume);
-            Serial.printf("   - Fixed playlist: %d relax tracks + 1 alarm track\n", RELAX_PLAYLIST_SIZE);
-            Serial.printf("   - Mode: NO REPEAT, MAX 1 HOUR\n");
-
-            dfPlayerInitialized = true;
-            return true;
+            SWELL_LOGW(LOG_WS, "⚠️ Pesan dari klien #%u dibuang (> %u byte / potongan tidak berurutan)",
+                       (unsigned)client->id(), (unsigned)WS_MESSAGE_MAX_SIZE);
+            return;
         }
 
-        retryCount++;
-        Serial.printf("❌ Percobaan %d gagal, coba lagi...\n", retryCount);
-        delay(1000);
+        // ⭐ Task AsyncTCP hanya parse + enqueue; state diubah oleh loop()
+        if (!queueWebSocketMessage(message, messageLen, fragment.binary, client->id()))
+        {
+            SWELL_LOGW(LOG_CMD, "⚠️ Command dari klien #%u ditolak (tidak valid / antrian penuh)", (unsigned)client->id());
+        }
+        wakeMainLoop();
     }
-
-    Serial.println("❌ KRITIS: DFPlayer Mini gagal diinisialisasi setelah 3 percobaan!");
-    dfPlayerInitialized = false;
-    return false;
 }
 
 // =================================================================
-// RTC SYSTEM FUNCTIONS
+// ⭐ POWER MANAGEMENT (IDLE SAMPAI DEADLINE BERIKUTNYA)
 // =================================================================
 
-void sendRTCTime()
+#ifdef SWELL_RTC_SQW_PIN
+void IRAM_ATTR onRtcSecondPulse()
 {
-    rtc.refresh();
-
-    JsonDocument rtcDoc;
-    rtcDoc["type"] = "rtcTime";
-    rtcDoc["rtc"]["year"] = rtc.year() + 2000;
-    rtcDoc["rtc"]["month"] = rtc.month();
-    rtcDoc["rtc"]["day"] = rtc.day();
-    rtcDoc["rtc"]["dayOfWeek"] = rtc.dayOfWeek();
-    rtcDoc["rtc"]["hour"] = rtc.hour();
-    rtcDoc["rtc"]["minute"] = rtc.minute();
-    rtcDoc["rtc"]["second"] = rtc.second();
-
-    String response;
-    serializeJson(rtcDoc, response);
-    ws.textAll(response);
-
-    Serial.printf("🕐 RTC Time sent: %02d/%02d/%04d %02d:%02d:%02d\n",
-                  rtc.day(), rtc.month(), rtc.year() + 2000,
-                  rtc.hour(), rtc.minute(), rtc.second());
+    wallClockSecondEdge(millis());
 }
+#endif
 
-bool calibrateRTC(JsonObject calibrationData)
+void wakeMainLoop()
 {
-    try
-    {
-        int year = calibrationData["year"];
-        int month = calibrationData["month"];
-        int day = calibrationData["day"];
-        int dayOfWeek = calibrationData["dayOfWeek"];
-        int hour = calibrationData["hour"];
-        int minute = calibrationData["minute"];
-        int second = calibrationData["second"];
-
-        if (year < 2020 || year > 2099 ||
-            month < 1 || month > 12 ||
-            day < 1 || day > 31 ||
-            dayOfWeek < 1 || dayOfWeek > 7 ||
-            hour < 0 || hour > 23 ||
-            minute < 0 || minute > 59 ||
-            second < 0 || second > 59)
-        {
-            Serial.println("❌ RTC Calibration: Invalid time data received");
-            return false;
-        }
-
-        Serial.printf("🕐 RTC Calibration: Setting time to %02d/%02d/%04d %02d:%02d:%02d\n",
-                      day, month, year, hour, minute, second);
-
-        rtc.set(second, minute, hour, dayOfWeek, day, month, year - 2000);
-
-        delay(100);
-        rtc.refresh();
-        Serial.println("✅ RTC Calibration: Successfully calibrated with browser time");
-        return true;
-    }
-    catch (...)
-    {
-        Serial.println("❌ RTC Calibration: Exception occurred during calibration");
-        return false;
-    }
+    if (mainLoopTask)
+        xTaskNotifyGive(mainLoopTask);
 }
 
-void broadcastRTCTime()
+void configurePowerManagement()
 {
-    unsigned long currentMillis = millis();
-    if (currentMillis - lastRTCBroadcast >= RTC_BROADCAST_INTERVAL)
-    {
-        sendRTCTime();
-        lastRTCBroadcast = currentMillis;
-    }
+#if CONFIG_PM_ENABLE
+    esp_pm_config_esp32_t pmConfig = {};
+    pmConfig.max_freq_mhz = 240;
+    pmConfig.min_freq_mhz = 80;
+    pmConfig.light_sleep_enable = SWELL_LIGHT_SLEEP;
+    if (esp_pm_configure(&pmConfig) == ESP_OK)
+        SWELL_LOGI(LOG_SYS, "💤 Power management aktif (DFS 80-240 MHz, light sleep: %s)", SWELL_LIGHT_SLEEP ? "ON" : "OFF");
+    else
+        SWELL_LOGW(LOG_SYS, "⚠️ esp_pm_configure gagal, CPU tetap 240 MHz saat idle");
+#else
+    SWELL_LOGI(LOG_SYS, "💤 CONFIG_PM_ENABLE tidak aktif: CPU idle di FreeRTOS idle task tanpa DFS");
+#endif
 }
 
 // =================================================================
-// MUSIC SYSTEM FUNCTIONS
+// ⭐ FIXED: FILE SERVING FUNCTIONS - TANPA FALLBACK
 // =================================================================
 
-void playMusicTrack(int trackNumber)
+int findStaticRoute(const char *url)
 {
-    if (!dfPlayerInitialized)
+    int low = 0;
+    int high = STATIC_ROUTE_COUNT - 1;
+    while (low <= high)
     {
-        Serial.println("❌ DFPlayer tidak tersedia untuk memutar musik");
-        return;
+        int mid = (low + high) / 2;
+        int cmp = strcmp(url, STATIC_ROUTES[mid].url);
+        if (cmp == 0)
+            return mid;
+        if (cmp < 0)
+            high = mid - 1;
+        else
+            low = mid + 1;
     }
-
-    Serial.printf("🎵 Playing track %d (NO REPEAT - Max 1 hour)\n", trackNumber);
-    myDFPlayer.play(trackNumber);
-
-    musicStartTime = millis();
-    musicPlayStartTime = millis();
-    Serial.printf("🎵 Music started at: %lu ms\n", musicStartTime);
-}
-
-void stopMusic()
-{
-    if (!dfPlayerInitialized)
-        return;
-
-    Serial.println("🎵 Music stopped");
-    myDFPlayer.stop();
-    isMusicPaused = false;
-    musicStartTime = 0;
-    musicPlayStartTime = 0;
+    return -1;
 }
 
-void setMusicVolume(int volume)
+/**
+ * @brief Isi StaticRouteState untuk semua route yang memakai `path`
+ */
+void markStaticAsset(const char *path, bool gzip, const char *etag)
 {
-    if (!dfPlayerInitialized)
-        return;
+    for (int i = 0; i < STATIC_ROUTE_COUNT; i++)
+    {
+        if (strcmp(STATIC_ROUTES[i].path, path) != 0)
+            continue;
 
-    volume = constrain(volume, 0, 30);
-    Serial.printf("🎵 Volume set to: %d/30\n", volume);
-    myDFPlayer.volume(volume);
+        StaticRouteState &state = staticRouteStates[i];
+        state.available = true;
+        state.gzip = gzip;
+        snprintf(state.etag, sizeof(state.etag), "%s", etag);
+    }
 }
 
-// =================================================================
-// PLAYLIST MANAGEMENT FUNCTIONS
-// =================================================================
-
-void generateAndSendPlaylist()
+/**
+ * @brief Baca /assets.manifest: satu asset per baris "<path> <gz|raw> <etag>"
+ * @return false jika manifest tidak ada
+ */
+bool loadAssetManifest()
 {
-    Serial.printf("📻 Mengirim fixed playlist dengan %d lagu relax music.\n", RELAX_PLAYLIST_SIZE);
-
-    JsonDocument playlistDoc;
-    playlistDoc["type"] = "playlist";
-    JsonArray playlistArray = playlistDoc["playlist"].to<JsonArray>();
-
-    for (int i = 0; i < RELAX_PLAYLIST_SIZE; i++)
+    File manifest = SPIFFS.open("/assets.manifest", "r");
+    if (!manifest)
     {
-        JsonObject trackObject = playlistArray.add<JsonObject>();
-        trackObject["trackNumber"] = RELAX_PLAYLIST[i].trackNumber;
-        trackObject["title"] = RELAX_PLAYLIST[i].title;
-        trackObject["filename"] = RELAX_PLAYLIST[i].filename;
+        SWELL_LOGW(LOG_WEB, "⚠️ assets.manifest tidak ada - file dilayani tanpa gzip/ETag");
+        return false;
     }
 
-    String response;
-    serializeJson(playlistDoc, response);
-    ws.textAll(response);
-    Serial.println("✅ Fixed playlist berhasil dikirim ke frontend.");
-}
-
-int getValidMusicTrackNumber(int requestedTrack)
-{
-    for (int i = 0; i < RELAX_PLAYLIST_SIZE; i++)
+    int assetCount = 0;
+    while (manifest.available())
     {
-        if (RELAX_PLAYLIST[i].trackNumber == requestedTrack)
-        {
-            return requestedTrack;
-        }
+        String line = manifest.readStringUntil('\n');
+        char path[32];
+        char encoding[4];
+        char etag[24];
+        if (sscanf(line.c_str(), "%31s %3s %23s", path, encoding, etag) != 3)
+            continue;
+
+        markStaticAsset(path, strcmp(encoding, "gz") == 0, etag);
+        assetCount++;
     }
+    manifest.close();
 
-    Serial.printf("⚠️ Track %d tidak valid, menggunakan track %d\n",
-                  requestedTrack, RELAX_PLAYLIST[0].trackNumber);
-    return RELAX_PLAYLIST[0].trackNumber;
+    SWELL_LOGI(LOG_WEB, "✅ Asset manifest: %d file (gzip + ETag)", assetCount);
+    return true;
 }
 
-// =================================================================
-// ⭐ FIXED: TIMING & SCHEDULING FUNCTIONS
-// =================================================================
-
-bool calculateInTimerWindow(int currentTime, int startTime, int endTime)
+#ifdef SWELL_EMBED_WEB_ASSETS
+const EmbeddedWebAsset *findEmbeddedWebAsset(const char *path)
 {
-    if (startTime > endTime)
+    size_t slot = webAssetPathHash(path) & (EMBEDDED_WEB_ASSET_SLOT_COUNT - 1);
+    while (EMBEDDED_WEB_ASSET_SLOTS[slot])
     {
-        // Timer melewati midnight
-        return (currentTime >= startTime) || (currentTime < endTime);
-    }
-    else
-    {
-        // Timer dalam hari yang sama
-        return (currentTime >= startTime) && (currentTime < endTime);
+        const EmbeddedWebAsset &asset = EMBEDDED_WEB_ASSETS[EMBEDDED_WEB_ASSET_SLOTS[slot] - 1];
+        if (strcmp(asset.path, path) == 0)
+            return &asset;
+        slot = (slot + 1) & (EMBEDDED_WEB_ASSET_SLOT_COUNT - 1);
     }
+    return nullptr;
 }
+#endif
 
-bool isInMusicTimeWindow(int currentTimeInMinutes, int startTimeInMinutes)
+/**
+ * @brief Resolve semua route sekali saat boot (SPIFFS + manifest, atau
+ *        tabel embedded), sehingga request tidak pernah memanggil exists()
+ * @return false jika SPIFFS gagal di-mount
+ */
+bool initializeWebAssets()
 {
-    int musicEndTimeInMinutes = (startTimeInMinutes + 60) % 1440;
-
-    bool inMusicTime;
-    if (startTimeInMinutes + 60 >= 1440)
+    bool mounted = true;
+#ifdef SWELL_EMBED_WEB_ASSETS
+    SWELL_LOGI(LOG_WEB, "📦 Web assets di-embed di flash (%u file), SPIFFS tidak di-mount",
+               (unsigned)EMBEDDED_WEB_ASSET_COUNT);
+    for (int i = 0; i < STATIC_ROUTE_COUNT; i++)
     {
-        inMusicTime = (currentTimeInMinutes >= startTimeInMinutes) || (currentTimeInMinutes < musicEndTimeInMinutes);
+        const EmbeddedWebAsset *asset = findEmbeddedWebAsset(STATIC_ROUTES[i].path);
+        staticRouteStates[i].embedded = asset;
+        if (asset)
+            markStaticAsset(asset->path, asset->gzip, asset->etag);
     }
-    else
+#else
+    mounted = initializeSPIFFS();
+    if (!loadAssetManifest())
     {
-        inMusicTime = (currentTimeInMinutes >= startTimeInMinutes) && (currentTimeInMinutes < musicEndTimeInMinutes);
+        // data/ di-upload mentah: layani file apa adanya, tanpa ETag
+        for (int i = 0; i < STATIC_ROUTE_COUNT; i++)
+        {
+            if (SPIFFS.exists(STATIC_ROUTES[i].path))
+                markStaticAsset(STATIC_ROUTES[i].path, false, "");
+        }
     }
+#endif
 
-    return inMusicTime;
+    SWELL_LOGI(LOG_WEB, "🔍 Checking required files:");
+    for (int i = 0; i < STATIC_ROUTE_COUNT; i++)
+    {
+        const StaticRouteState &state = staticRouteStates[i];
+        if (state.available)
+            SWELL_LOGI(LOG_WEB, "   ✅ %s%s", STATIC_ROUTES[i].path, state.gzip ? " (gzip)" : "");
+        else
+            SWELL_LOGE(LOG_WEB, "   ❌ %s MISSING!", STATIC_ROUTES[i].path);
+    }
+    return mounted;
 }
 
-bool hasReached1HourLimit()
+/**
+ * @brief Kirim 304 jika If-None-Match sama dengan ETag asset
+ * @return true jika sudah dibalas 304
+ */
+bool replyNotModified(AsyncWebServerRequest *request, const char *etag, const char *cacheControl)
 {
-    if (musicPlayStartTime == 0)
+    if (!etag[0] || !request->hasHeader("If-None-Match") || request->header("If-None-Match") != etag)
         return false;
-    return (millis() - musicPlayStartTime >= MUSIC_MAX_DURATION);
+
+    AsyncWebServerResponse *response = request->beginResponse(304);
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", cacheControl);
+    request->send(response);
+    return true;
 }
 
 /**
- * ⭐ FIXED: Main scheduler function - TIDAK MENGUBAH USER SETTINGS
+ * @brief immutable hanya untuk asset non-HTML yang ?v= nya sama dengan hash
+ *        isi sekarang. HTML selalu revalidate; ?v= lama (dari HTML yang
+ *        masih di-cache) tidak boleh mengunci isi baru selamanya.
  */
-void checkAndApplySchedules()
+const char *cacheControlFor(AsyncWebServerRequest *request, const StaticRoute &route, const StaticRouteState &state)
 {
-    // Jika timer belum dikonfirmasi, reset execution state saja
-    if (!userSettings.timer.confirmed)
+    if (!state.etag[0] || strcmp(route.contentType, "text/html") == 0 || !request->hasParam("v"))
+        return CACHE_REVALIDATE;
+
+    const String &version = request->getParam("v")->value();
+    if (version.length() != ASSET_VERSION_LENGTH || strncmp(state.etag + 1, version.c_str(), ASSET_VERSION_LENGTH) != 0)
+        return CACHE_REVALIDATE;
+    return CACHE_IMMUTABLE;
+}
+
+/**
+ * @brief Satu lookup: route -> MIME, ETag dan lokasi asset (file/flash)
+ */
+void serveStaticRoute(AsyncWebServerRequest *request)
+{
+    int index = findStaticRoute(request->url().c_str());
+    if (index < 0 || !staticRouteStates[index].available)
     {
-        executionState.aromatherapyActive = false;
-        executionState.musicActive = false;
-        executionState.inTimerWindow = false;
-        executionState.inMusicWindow = false;
-
-        // Matikan hardware
-        ledcWrite(PWM_CHANNEL_WHITE, 0);
-        ledcWrite(PWM_CHANNEL_YELLOW, 0);
-        digitalWrite(AROMATHERAPY_PIN, LOW);
-        stopMusic();
+        // ⭐ FIXED: Tidak ada lagi fallback folder reference
+        staticNotFound++;
+        SWELL_LOGD(LOG_WEB, "❌ Not found: %s", request->url().c_str());
+        request->send(404, "text/plain", "File Not Found");
         return;
     }
 
-    // Get current time
-    rtc.refresh();
-    int currentTimeInMinutes = rtc.hour() * 60 + rtc.minute();
-    int startTimeInMinutes = userSettings.timer.startHour * 60 + userSettings.timer.startMinute;
-    int endTimeInMinutes = userSettings.timer.endHour * 60 + userSettings.timer.endMinute;
+    const StaticRoute &route = STATIC_ROUTES[index];
+    StaticRouteState &state = staticRouteStates[index];
+    state.hits++;
 
-    // ⭐ FIXED: Update execution state flags saja
-    executionState.inTimerWindow = calculateInTimerWindow(currentTimeInMinutes, startTimeInMinutes, endTimeInMinutes);
-    executionState.inMusicWindow = isInMusicTimeWindow(currentTimeInMinutes, startTimeInMinutes);
+    const char *cacheControl = cacheControlFor(request, route, state);
 
-    // =================================================================
-    // ADAPTIVE LIGHTING
-    // =================================================================
-    if (executionState.inTimerWindow)
-    {
-        int yellowBrightness = map(userSettings.light.intensity, 0, 100, 0, 10);
-        ledcWrite(PWM_CHANNEL_YELLOW, yellowBrightness);
-        ledcWrite(PWM_CHANNEL_WHITE, 0);
-    }
-    else
+    if (replyNotModified(request, state.etag, cacheControl))
     {
-        ledcWrite(PWM_CHANNEL_WHITE, 10);
-        ledcWrite(PWM_CHANNEL_YELLOW, 0);
+        state.notModified++;
+        SWELL_LOGD(LOG_WEB, "✅ Not modified: %s (hit #%lu)", route.url, state.hits);
+        return;
     }
 
-    // =================================================================
-    // ⭐ FIXED: AROMATHERAPY EXECUTION - TIDAK MENGUBAH USER SETTING
-    // =================================================================
-    if (userSettings.aromatherapy.enabled && executionState.inMusicWindow)
-    {
-        // User enabled + in window → execute
-        if (!executionState.aromatherapyActive)
-        {
-            executionState.aromatherapyActive = true;
-            executionState.aromaStartTime = millis();
-            Serial.println("💨 Aromatherapy: EXECUTION started (user enabled + in window)");
-        }
-        handleAromatherapyExecution();
-    }
-    else
-    {
-        // Outside window or disabled → stop execution BUT DON'T CHANGE USER SETTING
-        if (executionState.aromatherapyActive)
-        {
-            executionState.aromatherapyActive = false;
-            digitalWrite(AROMATHERAPY_PIN, LOW);
-            isAromatherapySpraying = false;
-            Serial.println("💨 Aromatherapy: EXECUTION stopped (outside window or user disabled)");
-            // ⭐ CRITICAL: userSettings.aromatherapy.enabled TIDAK DIUBAH
-        }
+#ifdef SWELL_EMBED_WEB_ASSETS
+    // Langsung dari flash (AsyncProgmemResponse, tanpa salinan)
+    const EmbeddedWebAsset *asset = state.embedded;
+    AsyncWebServerResponse *response = request->beginResponse(200, route.contentType, asset->data, asset->length);
+    if (asset->gzip)
+        response->addHeader("Content-Encoding", "gzip");
+#else
+    char storedPath[40];
+    snprintf(storedPath, sizeof(storedPath), "%s%s", route.path, state.gzip ? ".gz" : "");
+    File file = SPIFFS.open(storedPath, "r");
+    if (!file)
+    {
+        SWELL_LOGE(LOG_WEB, "❌ Gagal membuka %s", storedPath);
+        request->send(500, "text/plain", "File Read Error");
+        return;
     }
 
-    // =================================================================
-    // ⭐ FIXED: MUSIC EXECUTION - TIDAK MENGUBAH USER SETTING
-    // =================================================================
-    bool shouldMusicPlay = userSettings.music.enabled &&
-                           executionState.inMusicWindow &&
-                           !hasReached1HourLimit();
+    // File bernama *.gz untuk path tanpa .gz: AsyncFileResponse menambahkan
+    // "Content-Encoding: gzip" sendiri
+    AsyncWebServerResponse *response = request->beginResponse(file, String(route.path), route.contentType);
+#endif
 
-    if (shouldMusicPlay && !executionState.musicActive)
-    {
-        // Start music execution
-        executionState.musicActive = true;
-        if (dfPlayerInitialized)
-        {
-            setMusicVolume(userSettings.music.volume);
-            playMusicTrack(userSettings.music.track);
-            Serial.println("🎵 Music: EXECUTION started (user enabled + in window)");
-        }
-    }
-    else if (!shouldMusicPlay && executionState.musicActive)
-    {
-        // Stop music execution
-        executionState.musicActive = false;
-        stopMusic();
-        if (hasReached1HourLimit())
-        {
-            Serial.println("🎵 Music: EXECUTION stopped (1 hour limit reached)");
-        }
-        else
-        {
-            Serial.println("🎵 Music: EXECUTION stopped (outside window)");
-        }
-        // ⭐ CRITICAL: userSettings.music.enabled TIDAK DIUBAH
-    }
+    if (state.etag[0])
+        response->addHeader("ETag", state.etag);
+    response->addHeader("Cache-Control", cacheControl);
+    request->send(response);
 
-    // =================================================================
-    // ALARM EXECUTION
-    // =================================================================
-    if (userSettings.alarm.enabled && !isAlarmPlaying && !executionState.musicActive)
+    SWELL_LOGD(LOG_WEB, "✅ Serving %s -> %s%s (hit #%lu)", route.url, route.path, state.gzip ? ".gz" : "", state.hits);
+}
+
+/**
+ * @brief Satu handler untuk semua GET statis (menggantikan satu lambda per file)
+ */
+class StaticAssetHandler : public AsyncWebHandler
+{
+public:
+    bool canHandle(AsyncWebServerRequest *request) const override
     {
-        if (rtc.hour() == userSettings.timer.endHour && rtc.minute() == userSettings.timer.endMinute)
-        {
-            Serial.printf("🔔 ALARM: Waktunya bangun! Memutar track %d\n", ALARM_TRACK_NUMBER);
-
-            if (dfPlayerInitialized)
-            {
-                myDFPlayer.volume(30);
-                playMusicTrack(ALARM_TRACK_NUMBER);
-                isAlarmPlaying = true;
-                alarmStopTime = millis() + 300000; // 5 minutes
-            }
-        }
+        return request->method() == HTTP_GET;
     }
 
-    // Stop alarm setelah 5 menit
-    if (isAlarmPlaying && millis() >= alarmStopTime)
+    void handleRequest(AsyncWebServerRequest *request) override
     {
-        Serial.println("🔔 ALARM: Durasi 5 menit selesai.");
-        stopMusic();
-        isAlarmPlaying = false;
-
-        // Resume relax music jika user enabled
-        if (userSettings.music.enabled && dfPlayerInitialized)
-        {
-            int validTrack = getValidMusicTrackNumber(userSettings.music.track);
-            setMusicVolume(userSettings.music.volume);
-            playMusicTrack(validTrack);
-        }
+        serveStaticRoute(request);
     }
-}
+};
+
+StaticAssetHandler staticAssetHandler;
 
 // =================================================================
-// AROMATHERAPY SYSTEM FUNCTIONS
+// METRICS (GET /metrics)
 // =================================================================
 
-void handleAromatherapyExecution()
+/** @brief Metric yang hanya ada di firmware: heap, WiFi, request HTTP per route */
+void writePlatformMetrics(MetricsWriter &out)
 {
-    unsigned long currentMillis = millis();
+    out.gauge("swell_heap_free_bytes", "Heap bebas", (long)ESP.getFreeHeap());
+    out.gauge("swell_heap_min_free_bytes", "Heap bebas terendah sejak boot", (long)ESP.getMinFreeHeap());
+    out.gauge("swell_heap_largest_block_bytes", "Blok heap terbesar (fragmentasi)", (long)ESP.getMaxAllocHeap());
 
-    // Handle spray duration (5 detik ON)
-    if (isAromatherapySpraying)
-    {
-        if (currentMillis - aromatherapyOnTime >= 5000) // 5 detik spray
-        {
-            digitalWrite(AROMATHERAPY_PIN, LOW);
-            isAromatherapySpraying = false;
-            lastAromatherapySprayStart = currentMillis;
-            Serial.println("💨 Aromatherapy: Semprotan selesai (5 detik)");
-        }
-        return;
-    }
+    for (int i = 0; i < STATIC_ROUTE_COUNT; i++)
+        out.counter("swell_http_requests_total", "Request asset statis per route",
+                    staticRouteStates[i].hits, "route", STATIC_ROUTES[i].url);
+    for (int i = 0; i < STATIC_ROUTE_COUNT; i++)
+        out.counter("swell_http_not_modified_total", "Request dibalas 304 per route",
+                    staticRouteStates[i].notModified, "route", STATIC_ROUTES[i].url);
+    out.counter("swell_http_not_found_total", "Request dibalas 404", staticNotFound);
+}
+
+static void writeToStream(void *context, const char *text, size_t len)
+{
+    ((AsyncResponseStream *)context)->write((const uint8_t *)text, len);
+}
 
-    // Handle spray interval (5 menit OFF)
-    unsigned long timeSinceLastSpray = currentMillis - lastAromatherapySprayStart;
-    bool timeToSpray = false;
+void setupWebServerRoutes()
+{
+    ws.onEvent(onEvent);
+    server.addHandler(&ws);
 
-    if (lastAromatherapySprayStart == 0)
-    {
-        timeToSpray = true;
-        Serial.println("💨 Aromatherapy: Semprotan pertama kali");
-    }
-    else if (timeSinceLastSpray >= 300000) // 5 menit
-    {
-        timeToSpray = true;
-        Serial.printf("💨 Aromatherapy: 5 menit berlalu (%.1f menit), semprot lagi\n",
-                      timeSinceLastSpray / 60000.0);
-    }
+    // Format teks Prometheus; dirender di task AsyncTCP, counter dibaca tanpa lock
+    server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request)
+              {
+        AsyncResponseStream *response = request->beginResponseStream("text/plain; version=0.0.4");
+        writeMetricsText(writeToStream, response);
+        request->send(response); });
 
-    if (timeToSpray)
-    {
-        digitalWrite(AROMATHERAPY_PIN, HIGH);
-        isAromatherapySpraying = true;
-        aromatherapyOnTime = currentMillis;
-        Serial.println("💨 Aromatherapy: Mulai semprot");
-    }
+    // Setelah ws: semua GET lain dicari di STATIC_ROUTES, selain itu 404
+    server.addHandler(&staticAssetHandler);
+
+    server.onNotFound([](AsyncWebServerRequest *request)
+                      {
+        staticNotFound++;
+        SWELL_LOGD(LOG_WEB, "❌ Not found: %s", request->url().c_str());
+        request->send(404, "text/plain", "File Not Found"); });
+
+    server.begin();
+    SWELL_LOGI(LOG_WEB, "✅ Web server started successfully");
 }
 
-void resetAromatherapy()
+bool initializeSPIFFS()
 {
-    if (digitalRead(AROMATHERAPY_PIN) == HIGH)
+    if (!SPIFFS.begin(true))
     {
-        digitalWrite(AROMATHERAPY_PIN, LOW);
+        SWELL_LOGE(LOG_WEB, "❌ KRITIS: Gagal me-mount SPIFFS file system!");
+        return false;
     }
+    SWELL_LOGI(LOG_WEB, "✅ SPIFFS file system mounted successfully.");
 
-    isAromatherapySpraying = false;
-    lastAromatherapySprayStart = 0;
-    Serial.println("💨 Aromatherapy: Reset semua state");
+    SWELL_LOGI(LOG_WEB, "📁 Available files in SPIFFS root:");
+    File root = SPIFFS.open("/");
+    File file = root.openNextFile();
+    while (file)
+    {
+        SWELL_LOGI(LOG_WEB, "   - %s (%u bytes)", file.name(), (unsigned)file.size());
+        file = root.openNextFile();
+    }
+    return true;
 }
 
 // =================================================================
-// ⭐ FIXED: WEBSOCKET COMMUNICATION FUNCTIONS
+// ⭐ BOOT STAGES (PARALEL, LIHAT boot_sequence.h)
 // =================================================================
 
-/**
- * ⭐ FIXED: Handle WebSocket messages - UPDATE USER SETTINGS SAJA
- */
-void handleWebSocketMessage(void *arg, uint8_t *data, size_t len)
+// Urutan = urutan start untuk stage yang siap bersamaan
+enum BootStageIndex
 {
-    JsonDocument doc;
-    deserializeJson(doc, (char *)data);
-    String command = doc["command"];
-    Serial.printf("📨 Command diterima: %s\n", command.c_str());
-
-    bool changed = false;
-
-    // =================================================================
-    // QUERY COMMANDS
-    // =================================================================
-    if (command == "getStatus")
-    {
-        notifyClients();
-        return;
-    }
-    if (command == "getPlaylist")
-    {
-        generateAndSendPlaylist();
-        return;
-    }
-    if (command == "getRTC")
-    {
-        sendRTCTime();
-        return;
-    }
-
-    // =================================================================
-    // RTC CALIBRATION COMMAND
-    // =================================================================
-    if (command == "rtc-calibrate")
-    {
-        JsonObject calibrationData = doc["value"];
-        bool calibrationSuccess = calibrateRTC(calibrationData);
+    BOOT_STAGE_WIFI,
+    BOOT_STAGE_FILESYSTEM,
+    BOOT_STAGE_RTC,
+    BOOT_STAGE_SETTINGS,
+    BOOT_STAGE_AUDIO,
+    BOOT_STAGE_WEB,
+    BOOT_STAGE_COUNT
+};
 
-        JsonDocument responseDoc;
-        responseDoc["type"] = "rtcCalibrated";
-        responseDoc["success"] = calibrationSuccess;
-        if (!calibrationSuccess)
-        {
-            responseDoc["error"] = "Failed to calibrate RTC";
-        }
+const unsigned long BOOT_WIFI_TIMEOUT_MS = 10000; // Hanya laporan boot; wifi_manager terus mencoba
 
-        String response;
-        serializeJson(responseDoc, response);
-        ws.textAll(response);
+/** @brief Dari task lain: tandai selesai lalu bangunkan loop() untuk stage berikutnya */
+void finishBootStage(size_t stage, bool ok)
+{
+    bootStageDone(stage, ok);
+    wakeMainLoop();
+}
 
-        if (calibrationSuccess)
-        {
-            delay(200);
-            sendRTCTime();
-        }
+/** @brief Task event WiFi: hanya diantrikan, state machine jalan di loop() (serviceWiFi) */
+void onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info)
+{
+    switch (event)
+    {
+    case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+        wifiLinkConnected(info.wifi_sta_connected.bssid, info.wifi_sta_connected.channel);
+        break;
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+        wifiLinkGotIp();
+        break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+        wifiLinkDisconnected(info.wifi_sta_disconnected.reason);
+        break;
+    default:
         return;
     }
+    wakeMainLoop();
+}
 
-    // =================================================================
-    // TIMER COMMANDS
-    // =================================================================
-    if (command == "timer-toggle")
-    {
-        userSettings.timer.on = doc["value"];
-
-        if (!userSettings.timer.on)
-        {
-            userSettings.timer.confirmed = false;
-            // Reset execution state, not user settings
-            executionState.aromatherapyActive = false;
-            executionState.musicActive = false;
-            resetAromatherapy();
-        }
-        changed = true;
-    }
-    else if (command == "timer-confirm")
-    {
-        if (userSettings.timer.on)
-        {
-            userSettings.timer.confirmed = true;
-            sscanf(doc["value"]["start"], "%d:%d", &userSettings.timer.startHour, &userSettings.timer.startMinute);
-            sscanf(doc["value"]["end"], "%d:%d", &userSettings.timer.endHour, &userSettings.timer.endMinute);
-            changed = true;
-        }
-    }
-
-    // =================================================================
-    // ⭐ FIXED: FEATURE COMMANDS - UPDATE USER SETTINGS SAJA
-    // =================================================================
-    else if (userSettings.timer.confirmed)
-    {
-        if (command == "light-intensity")
-        {
-            userSettings.light.intensity = doc["value"];
-            Serial.printf("💡 Light intensity USER SETTING: %d%%\n", userSettings.light.intensity);
-            changed = true;
-        }
-        else if (command == "aroma-toggle")
-        {
-            // ⭐ FIXED: Update user setting, bukan execution state
-            userSettings.aromatherapy.enabled = doc["value"];
-            Serial.printf("💨 Aromatherapy USER SETTING: %s\n",
-                          userSettings.aromatherapy.enabled ? "ENABLED" : "DISABLED");
-
-            // Reset execution state jika user disable
-            if (!userSettings.aromatherapy.enabled && executionState.aromatherapyActive)
-            {
-                executionState.aromatherapyActive = false;
-                resetAromatherapy();
-            }
-            changed = true;
-        }
-        else if (command == "alarm-toggle")
-        {
-            userSettings.alarm.enabled = doc["value"];
-            Serial.printf("🔔 Alarm USER SETTING: %s (fixed track %d)\n",
-                          userSettings.alarm.enabled ? "ENABLED" : "DISABLED", ALARM_TRACK_NUMBER);
-            changed = true;
-        }
-        else if (command == "music-toggle")
-        {
-            // ⭐ FIXED: Update user setting, bukan execution state
-            userSettings.music.enabled = doc["value"];
-            Serial.printf("🎵 Music USER SETTING: %s\n",
-                          userSettings.music.enabled ? "ENABLED" : "DISABLED");
-
-            // Reset execution state jika user disable
-            if (!userSettings.music.enabled && executionState.musicActive)
-            {
-                executionState.musicActive = false;
-                stopMusic();
-            }
-            changed = true;
-        }
-        else if (command == "music-track")
-        {
-            int requestedTrack = doc["value"];
-            int validTrack = getValidMusicTrackNumber(requestedTrack);
-            userSettings.music.track = validTrack;
-
-            // Jika musik sedang active, ganti track langsung
-            if (executionState.musicActive && dfPlayerInitialized)
-            {
-                playMusicTrack(validTrack);
-                Serial.printf("🎵 Music track changed to: %d (NO REPEAT)\n", validTrack);
-            }
-            changed = true;
-        }
-        else if (command == "music-volume")
-        {
-            int frontendVolume = doc["value"];
-            frontendVolume = (frontendVolume / 10) * 10;
-            int dfPlayerVolume = map(frontendVolume, 0, 100, 0, 30);
-            userSettings.music.volume = dfPlayerVolume;
-
-            if (dfPlayerInitialized)
-            {
-                setMusicVolume(dfPlayerVolume);
-            }
-            Serial.printf("🎵 Music volume USER SETTING: %d%% (DFPlayer: %d/30)\n", frontendVolume, dfPlayerVolume);
-            changed = true;
-        }
-    }
-    else
-    {
-        Serial.printf("⚠️ Perintah '%s' diabaikan, timer belum dikonfirmasi.\n", command.c_str());
-    }
+/** @brief Dari loop() setiap kali IP didapat / link putus */
+void onWiFiStateChange(bool online)
+{
+    if (!online)
+        return; // Web server tetap listen; bisa diakses lagi begitu IP kembali
 
-    // =================================================================
-    // SAVE & NOTIFY JIKA ADA PERUBAHAN
-    // =================================================================
-    if (changed)
-    {
-        Serial.printf("✅ Perintah '%s' diterima dan diproses.\n", command.c_str());
-        saveUserSettings();       // ⭐ Save user settings
-        checkAndApplySchedules(); // Apply ke hardware execution
-        notifyClients();          // ⭐ Broadcast user settings + execution state
-    }
+    SWELL_LOGI(LOG_NET, "✅ WiFi terhubung! IP Address: %s", WiFi.localIP().toString().c_str());
+    SWELL_LOGI(LOG_WEB, "🌐 Web Interface: http://%s", WiFi.localIP().toString().c_str());
+    SWELL_LOGI(LOG_WEB, "📈 Metrics: http://%s/metrics", WiFi.localIP().toString().c_str());
 }
 
-void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type,
-             void *arg, uint8_t *data, size_t len)
+BootStageState startWiFi()
 {
-    if (type == WS_EVT_CONNECT)
-    {
-        Serial.printf("🔗 WebSocket klien #%u terhubung\n", client->id());
-        sendRTCTime();
-    }
-    else if (type == WS_EVT_DISCONNECT)
-    {
-        Serial.printf("🔌 WebSocket klien #%u terputus\n", client->id());
-    }
-    else if (type == WS_EVT_DATA)
-    {
-        handleWebSocketMessage(arg, data, len);
-    }
+    // Pertama di tabel: asosiasi berjalan di task WiFi selama stage lain jalan
+    WiFi.onEvent(onWiFiEvent);
+    wifiManagerBegin(ssid, password, onWiFiStateChange);
+    return BOOT_RUNNING;
 }
 
-/**
- * ⭐ FIXED: Notify clients - KIRIM USER SETTINGS + EXECUTION STATE INFO
- */
-void notifyClients()
+BootStageState pollWiFi()
 {
-    JsonDocument doc;
-    doc["type"] = "statusUpdate";
-
-    // ⭐ FIXED: Send user settings (persistent config yang bisa di-set user)
-    doc["state"]["timer"]["on"] = userSettings.timer.on;
-    doc["state"]["timer"]["confirmed"] = userSettings.timer.confirmed;
-
-    char startTimeStr[6];
-    char endTimeStr[6];
-    sprintf(startTimeStr, "%02d:%02d", userSettings.timer.startHour, userSettings.timer.startMinute);
-    sprintf(endTimeStr, "%02d:%02d", userSettings.timer.endHour, userSettings.timer.endMinute);
-    doc["state"]["timer"]["start"] = startTimeStr;
-    doc["state"]["timer"]["end"] = endTimeStr;
-
-    // ⭐ FIXED: Feature user settings (yang akan di-reflect di toggle)
-    doc["state"]["aromatherapy"]["enabled"] = userSettings.aromatherapy.enabled;
-    doc["state"]["music"]["enabled"] = userSettings.music.enabled;
-    doc["state"]["alarm"]["enabled"] = userSettings.alarm.enabled;
-
-    doc["state"]["music"]["track"] = userSettings.music.track;
-    doc["state"]["music"]["volume"] = map(userSettings.music.volume, 0, 30, 0, 100);
-    doc["state"]["light"]["intensity"] = userSettings.light.intensity;
-
-    // ⭐ ADDITIONAL: Send execution state untuk info (optional)
-    doc["executionState"]["aromatherapyActive"] = executionState.aromatherapyActive;
-    doc["executionState"]["musicActive"] = executionState.musicActive;
-    doc["executionState"]["inTimerWindow"] = executionState.inTimerWindow;
-    doc["executionState"]["inMusicWindow"] = executionState.inMusicWindow;
-
-    String jsonString;
-    serializeJson(doc, jsonString);
-    ws.textAll(jsonString);
+    return wifiOnline() ? BOOT_DONE : BOOT_RUNNING;
 }
 
-// =================================================================
-// ⭐ FIXED: FILE SERVING FUNCTIONS - TANPA FALLBACK
-// =================================================================
+void filesystemTask(void *)
+{
+    finishBootStage(BOOT_STAGE_FILESYSTEM, initializeWebAssets());
+    vTaskDelete(nullptr);
+}
 
-String getContentType(String filename)
+BootStageState startFilesystem()
 {
-    if (filename.endsWith(".html"))
-        return "text/html";
-    else if (filename.endsWith(".css"))
-        return "text/css";
-    else if (filename.endsWith(".js"))
-        return "application/javascript";
-    else if (filename.endsWith(".png"))
-        return "image/png";
-    else if (filename.endsWith(".jpg"))
-        return "image/jpeg";
-    else if (filename.endsWith(".ico"))
-        return "image/x-icon";
-    else if (filename.endsWith(".gif"))
-        return "image/gif";
-    return "text/plain";
+    // Mount + listing SPIFFS di core 0, paralel dengan RTC/NVS/DFPlayer di core 1
+    if (xTaskCreatePinnedToCore(filesystemTask, "swellFs", 6144, nullptr, 1, nullptr, 0) == pdPASS)
+        return BOOT_RUNNING;
+    return initializeWebAssets() ? BOOT_DONE : BOOT_FAILED;
 }
 
-void serveFileFromSPIFFS(AsyncWebServerRequest *request, String filename)
+BootStageState startRtc()
 {
-    String contentType = getContentType(filename);
+    bool ok = hal.rtc->refresh();
+    if (!ok)
+    {
+        SWELL_LOGE(LOG_CLOCK, "❌ KRITIS: RTC DS3231 tidak dapat dibaca!");
+    }
+    checkAndSetRTC();
 
-    if (SPIFFS.exists(filename))
+#ifdef SWELL_RTC_SQW_PIN
+    // Tepi detik dari DS3231 untuk sinkronisasi fase jam software
+    if (hal.rtc->enableSecondPulse())
     {
-        Serial.printf("✅ Serving file: %s (Type: %s)\n", filename.c_str(), contentType.c_str());
-        request->send(SPIFFS, filename, contentType);
-        return;
+        pinMode(SWELL_RTC_SQW_PIN, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(SWELL_RTC_SQW_PIN), onRtcSecondPulse, FALLING);
+        SWELL_LOGI(LOG_CLOCK, "🕐 DS3231 SQW 1 Hz aktif di GPIO %d", SWELL_RTC_SQW_PIN);
     }
+#endif
 
-    // ⭐ FIXED: Tidak ada lagi fallback folder reference
-    Serial.printf("❌ File not found: %s\n", filename.c_str());
-    request->send(404, "text/plain", "File Not Found");
+    WallClockTime now;
+    wallClockNow(now);
+    SWELL_LOGI(LOG_CLOCK, "🕐 Initial RTC Time: %02d/%02d/%04d %02d:%02d:%02d",
+               now.day, now.month, now.year, now.hour, now.minute, now.second);
+    return ok ? BOOT_DONE : BOOT_FAILED;
 }
 
-void setupWebServerRoutes()
+BootStageState startSettings()
 {
-    ws.onEvent(onEvent);
-    server.addHandler(&ws);
-
-    server.on("/", HTTP_GET, [](AsyncWebServerRequest *request)
-              { serveFileFromSPIFFS(request, "/index.html"); });
-
-    server.on("/index.html", HTTP_GET, [](AsyncWebServerRequest *request)
-              { serveFileFromSPIFFS(request, "/index.html"); });
-
-    server.on("/swell-homepage.html", HTTP_GET, [](AsyncWebServerRequest *request)
-              { serveFileFromSPIFFS(request, "/swell-homepage.html"); });
-
-    server.on("/swell-device-detail.html", HTTP_GET, [](AsyncWebServerRequest *request)
-              { serveFileFromSPIFFS(request, "/swell-device-detail.html"); });
-
-    server.on("/swell-styles.css", HTTP_GET, [](AsyncWebServerRequest *request)
-              { serveFileFromSPIFFS(request, "/swell-styles.css"); });
-
-    server.on("/swell-script.js", HTTP_GET, [](AsyncWebServerRequest *request)
-              { serveFileFromSPIFFS(request, "/swell-script.js"); });
-
-    server.on("/logo.png", HTTP_GET, [](AsyncWebServerRequest *request)
-              { serveFileFromSPIFFS(request, "/logo.png"); });
-
-    server.onNotFound([](AsyncWebServerRequest *request)
-                      {
-        String path = request->url();
-        Serial.printf("📄 Requested: %s\n", path.c_str());
-        serveFileFromSPIFFS(request, path); });
-
-    server.serveStatic("/", SPIFFS, "/").setDefaultFile("index.html");
-    server.begin();
-    Serial.println("✅ Web server started successfully");
+    // ⭐ FIXED: Load user settings
+    loadUserSettings();
+    return BOOT_DONE;
 }
 
-void initializeSPIFFS()
+BootStageState startAudio()
 {
-    if (!SPIFFS.begin(true))
-    {
-        Serial.println("❌ KRITIS: Gagal me-mount SPIFFS file system!");
-        return;
-    }
-    Serial.println("✅ SPIFFS file system mounted successfully.");
-
-    Serial.println("📁 Available files in SPIFFS root:");
-    File root = SPIFFS.open("/");
-    File file = root.openNextFile();
-    while (file)
-    {
-        Serial.printf("   - %s (%d bytes)\n", file.name(), file.size());
-        file = root.openNextFile();
-    }
+    initializeDFPlayer(); // Handshake dikerjakan serviceAudio() di loop()
+    return BOOT_RUNNING;
+}
 
-    String requiredFiles[] = {
-        "/index.html",
-        "/swell-homepage.html",
-        "/swell-device-detail.html",
-        "/swell-styles.css",
-        "/swell-script.js",
-        "/logo.png"};
+BootStageState pollAudio()
+{
+    AudioDriverState state = audioDriverState();
+    if (state == AUDIO_READY)
+        return BOOT_DONE;
+    return state == AUDIO_FAILED ? BOOT_FAILED : BOOT_RUNNING;
+}
 
-    Serial.println("🔍 Checking required files:");
-    for (String filename : requiredFiles)
-    {
-        if (SPIFFS.exists(filename))
-        {
-            Serial.printf("   ✅ %s\n", filename.c_str());
-        }
-        else
-        {
-            Serial.printf("   ❌ %s MISSING!\n", filename.c_str());
-        }
-    }
+BootStageState startWebServer()
+{
+    // Listen di semua interface sejak sekarang (netif sudah dibuat WiFi.mode()),
+    // jadi halaman pertama bisa dilayani begitu IP didapat
+    setupWebServerRoutes();
+    return BOOT_DONE;
 }
 
+const BootStage BOOT_STAGES[BOOT_STAGE_COUNT] = {
+    {"wifi", 0, startWiFi, pollWiFi, BOOT_WIFI_TIMEOUT_MS},
+    {"filesystem", 0, startFilesystem, nullptr, 0},
+    {"rtc", 0, startRtc, nullptr, 0},
+    {"settings", 0, startSettings, nullptr, 0},
+    {"audio", BOOT_AFTER(BOOT_STAGE_SETTINGS), startAudio, pollAudio, 0}, // Volume dari settings
+    {"web", BOOT_AFTER(BOOT_STAGE_FILESYSTEM), startWebServer, nullptr, 0}, // Route butuh hasil resolve asset
+};
+
 // =================================================================
 // MAIN SETUP & LOOP FUNCTIONS
 // =================================================================
@@ -1165,7 +723,11 @@ void initializeSPIFFS()
 void setup()
 {
     Serial.begin(115200);
-    Serial.println("\n=== SWELL SMART LAMP STARTUP - FIXED VERSION ===");
+    logBegin(); // Sebelum log pertama: Serial hanya ditulis task log
+    SWELL_LOGI(LOG_SYS, "=== SWELL SMART LAMP STARTUP - FIXED VERSION ===");
+
+    mainLoopTask = xTaskGetCurrentTaskHandle();
+    setPlatformMetrics(writePlatformMetrics);
 
     Wire.begin();
 
@@ -1177,80 +739,71 @@ void setup()
     ledcSetup(PWM_CHANNEL_YELLOW, PWM_FREQUENCY, PWM_RESOLUTION);
     ledcAttachPin(WHITE_LED_PIN, PWM_CHANNEL_WHITE);
     ledcAttachPin(YELLOW_LED_PIN, PWM_CHANNEL_YELLOW);
+    ledc_fade_func_install(0); // Fade sunset/sunrise berjalan di hardware (hal.pwm->fade)
 
-    // Initialize RTC
-    if (!rtc.refresh())
-    {
-        Serial.println("❌ KRITIS: RTC DS3231 tidak dapat dibaca!");
-    }
-    checkAndSetRTC();
-
-    rtc.refresh();
-    Serial.printf("🕐 Initial RTC Time: %02d/%02d/%04d %02d:%02d:%02d\n",
-                  rtc.day(), rtc.month(), rtc.year() + 2000,
-                  rtc.hour(), rtc.minute(), rtc.second());
-
-    // ⭐ FIXED: Load user settings
-    loadUserSettings();
-
-    initializeDFPlayer();
-
-    // File system initialization
-    initializeSPIFFS();
-
-    // Network initialization
-    Serial.printf("📡 Connecting to WiFi: %s", ssid);
-    WiFi.begin(ssid, password);
-
-    int wifiTimeout = 20;
-    while (WiFi.status() != WL_CONNECTED && wifiTimeout > 0)
-    {
-        delay(500);
-        Serial.print(".");
-        wifiTimeout--;
-    }
+    // ⭐ WiFi, SPIFFS, RTC, settings, DFPlayer dan web server lewat BOOT_STAGES;
+    // yang lama (asosiasi, handshake, mount) lanjut di background saat loop() jalan
+    bootBegin(BOOT_STAGES, BOOT_STAGE_COUNT);
 
-    if (WiFi.status() == WL_CONNECTED)
-    {
-        Serial.println("\n✅ WiFi terhubung!");
-        Serial.printf("📍 IP Address: %s\n", WiFi.localIP().toString().c_str());
-    }
-    else
-    {
-        Serial.println("\n❌ KRITIS: WiFi gagal terhubung!");
-        return;
-    }
+    SWELL_LOGI(LOG_SYS, "=== SWELL SMART LAMP CONTROL LOOP READY - FIXED VERSION ===");
+    SWELL_LOGI(LOG_SYS, "⭐ FIXED: User settings separated from execution state");
+    SWELL_LOGI(LOG_SYS, "⭐ Users can now configure scenarios anytime!");
+    SWELL_LOGI(LOG_MUSIC, "📻 Relax Music: %d tracks available (NO REPEAT MODE)", RELAX_PLAYLIST_SIZE);
+    SWELL_LOGI(LOG_ALARM, "🔔 Alarm Track: Fixed to #%d", ALARM_TRACK_NUMBER);
 
-    // Setup web server
-    setupWebServerRoutes();
-
-    Serial.println("\n=== SWELL SMART LAMP READY - FIXED VERSION ===");
-    Serial.println("⭐ FIXED: User settings separated from execution state");
-    Serial.println("⭐ Users can now configure scenarios anytime!");
-    Serial.printf("📻 Relax Music: %d tracks available (NO REPEAT MODE)\n", RELAX_PLAYLIST_SIZE);
-    Serial.printf("🔔 Alarm Track: Fixed to #%d\n", ALARM_TRACK_NUMBER);
-    Serial.printf("🎵 DFPlayer Status: %s\n", dfPlayerInitialized ? "OK" : "ERROR");
-    Serial.printf("🌐 Web Interface: http://%s\n", WiFi.localIP().toString().c_str());
+    configurePowerManagement();
 }
 
 void loop()
 {
+    unsigned long wakeUs = micros();
     ws.cleanupClients();
 
-    if (millis() - lastTimeCheck >= 1000)
-    {
-        checkAndApplySchedules();
-        lastTimeCheck = millis();
-    }
+    // Event WiFi dari task event; reconnect + backoff tanpa menunggu
+    serviceWiFi();
+
+    // ⭐ Semua command WebSocket di-apply di sini (satu pemilik state)
+    processCommandQueue();
+
+    // Jam software dibaca ulang dari DS3231 jika sudah >= WALL_CLOCK_RESYNC_MS
+    // (menumpang wakeup lain; scheduler bangun minimal tiap 10 menit)
+    serviceWallClock();
+    serviceClockSync(); // clockSync hanya di-push jika jam device melompat
+
+    // ⭐ Scheduler hanya jalan saat ada transisi (atau diminta command)
+    serviceSchedules();
 
     if (millis() - lastStatusBroadcast >= STATUS_BROADCAST_INTERVAL)
     {
-        Serial.println("📡 Periodic status broadcast to frontend...");
+        SWELL_LOGD(LOG_WS, "📡 Periodic status broadcast to frontend (delta)...");
         notifyClients();
         lastStatusBroadcast = millis();
     }
 
-    broadcastRTCTime();
+    serviceUserSettingsPersistence();
+
+    // ⭐ Frame DFPlayer dikirim di sini, tanpa menunggu ACK
+    serviceAudio();
+
+    // Segmen fade LED berikutnya (fade-nya sendiri berjalan di LEDC)
+    serviceLight();
+
+    // Stage boot yang dependensinya baru selesai (setelah serviceAudio: handshake DFPlayer)
+    serviceBoot();
+
+    // Tidur sampai deadline terdekat; command WebSocket membangunkan lebih awal
+    unsigned long sleepMs = LOOP_MAX_SLEEP_MS;
+    sleepMs = min(sleepMs, millisUntilNextSchedule());
+    sleepMs = min(sleepMs, millisUntilUserSettingsFlush());
+    sleepMs = min(sleepMs, millisUntilAudioService());
+    sleepMs = min(sleepMs, millisUntilLightService());
+    sleepMs = min(sleepMs, millisUntilBootService());
+    sleepMs = min(sleepMs, millisUntilWiFiService());
+    sleepMs = min(sleepMs, STATUS_BROADCAST_INTERVAL - min(STATUS_BROADCAST_INTERVAL, millis() - lastStatusBroadcast));
+    if (commandQueueDepth() > 0)
+        sleepMs = 0; // Command masuk setelah processCommandQueue()
 
-    delay(10);
+    recordLoopIteration(micros() - wakeUs); // Waktu kerja saja, tanpa tidur
+    if (sleepMs > 0)
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleepMs));
 }
\ No newline at end of file
@@ -0,0 +1,354 @@
+/**
+ * @file metrics.cpp
+ * @brief Swell Smart Lamp - Instrumentasi runtime (GET /metrics + command getMetrics)
+ */
+
+#include "metrics.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "audio_driver.h"
+#include "boot_sequence.h"
+#include "command_queue.h"
+#include "hal.h"
+#include "json_writer.h"
+#include "light_engine.h"
+#include "settings_store.h"
+#include "socket_fanout.h"
+#include "status_broadcast.h"
+#include "swell_core.h"
+#include "swell_log.h"
+#include "wall_clock.h"
+#include "wifi_manager.h"
+#include "ws_reassembly.h"
+
+// =================================================================
+// HISTOGRAM
+// =================================================================
+
+Histogram::Histogram(const uint32_t *bounds, size_t boundCount)
+    : bounds(bounds), boundCount(boundCount < HISTOGRAM_MAX_BOUNDS ? boundCount : HISTOGRAM_MAX_BOUNDS)
+{
+}
+
+void Histogram::record(uint32_t value)
+{
+    size_t bucket = 0;
+    while (bucket < boundCount && value > bounds[bucket])
+        bucket++;
+    buckets[bucket]++;
+    count++;
+    sum += value;
+}
+
+static const uint32_t LOOP_US_BOUNDS[] = {100, 500, 1000, 5000, 20000, 100000, 500000};
+static const uint32_t AUDIO_ACK_MS_BOUNDS[] = {10, 20, 40, 80, 120, 160, 200};
+static const uint32_t WIFI_RECONNECT_MS_BOUNDS[] = {500, 1000, 2000, 5000, 10000, 30000, 60000, 300000};
+
+static Histogram loopIteration(LOOP_US_BOUNDS, sizeof(LOOP_US_BOUNDS) / sizeof(LOOP_US_BOUNDS[0]));
+static Histogram audioAck(AUDIO_ACK_MS_BOUNDS, sizeof(AUDIO_ACK_MS_BOUNDS) / sizeof(AUDIO_ACK_MS_BOUNDS[0]));
+static Histogram wifiReconnect(WIFI_RECONNECT_MS_BOUNDS, sizeof(WIFI_RECONNECT_MS_BOUNDS) / sizeof(WIFI_RECONNECT_MS_BOUNDS[0]));
+
+// Ditulis task AsyncTCP (queueWebSocketMessage) atau loop() di env:native
+static unsigned long wsMessagesIn = 0;
+static unsigned long wsBytesIn = 0;
+static unsigned long wsInvalid = 0;
+
+static MetricsSection platformSection = nullptr;
+
+void recordLoopIteration(unsigned long busyUs)
+{
+    loopIteration.record((uint32_t)busyUs);
+}
+
+void recordAudioAckLatency(unsigned long ms)
+{
+    audioAck.record((uint32_t)ms);
+}
+
+void recordWifiReconnect(unsigned long ms)
+{
+    wifiReconnect.record((uint32_t)ms);
+}
+
+void recordWebSocketIn(size_t len, bool parsed)
+{
+    wsMessagesIn++;
+    wsBytesIn += len;
+    if (!parsed)
+        wsInvalid++;
+}
+
+void setPlatformMetrics(MetricsSection section)
+{
+    platformSection = section;
+}
+
+// =================================================================
+// ⭐ DAFTAR METRIC
+// =================================================================
+
+void writeMetrics(MetricsWriter &out)
+{
+    out.gauge("swell_uptime_seconds", "Detik sejak boot", (long)(hal.clock->millis() / 1000));
+    out.histogram("swell_loop_iteration_microseconds", "Waktu kerja satu iterasi loop()", loopIteration);
+
+    // -1 = stage belum selesai
+    for (size_t i = 0; i < bootStageCount(); i++)
+    {
+        BootStageTiming timing = bootStageTiming(i);
+        bool done = timing.state == BOOT_DONE || timing.state == BOOT_FAILED;
+        out.gauge("swell_boot_stage_milliseconds", "Durasi stage boot", done ? (long)(timing.doneMs - timing.startMs) : -1,
+                  "stage", bootStageName(i));
+    }
+    out.gauge("swell_boot_ready_milliseconds", "Semua stage boot selesai sejak power-on", (long)bootReadyMs());
+
+    const WifiManagerStats &wifi = wifiManagerStats();
+    out.gauge("swell_wifi_online", "WiFi terhubung dan punya IP", wifiOnline() ? 1 : 0);
+    out.gauge("swell_wifi_rssi_dbm", "Kekuatan sinyal WiFi", (long)hal.wifi->rssi());
+    out.counter("swell_wifi_connect_attempts_total", "Percobaan connect WiFi", wifi.cachedAttempts, "kind", "cached");
+    out.counter("swell_wifi_connect_attempts_total", "Percobaan connect WiFi", wifi.attempts - wifi.cachedAttempts,
+                "kind", "scan");
+    out.counter("swell_wifi_connect_timeouts_total", "Percobaan tanpa IP sampai timeout", wifi.timeouts);
+    out.counter("swell_wifi_connects_total", "WiFi mendapat IP", wifi.connects);
+    out.counter("swell_wifi_disconnects_total", "Link WiFi putus saat online", wifi.disconnects);
+    out.histogram("swell_wifi_reconnect_milliseconds", "Link putus -> IP lagi", wifiReconnect);
+
+    SocketClientInfo clients[SOCKET_MAX_CLIENTS];
+    out.gauge("swell_ws_clients", "Client WebSocket terhubung",
+              (long)hal.sockets->listClients(clients, SOCKET_MAX_CLIENTS));
+    out.counter("swell_ws_messages_in_total", "Pesan WebSocket masuk (utuh)", wsMessagesIn);
+    out.counter("swell_ws_bytes_in_total", "Byte pesan WebSocket masuk", wsBytesIn);
+    out.counter("swell_ws_messages_invalid_total", "Pesan masuk yang gagal di-parse", wsInvalid);
+    out.counter("swell_ws_reassembly_dropped_bytes_total", "Byte fragmen yang dibuang",
+                wsReassemblyStats().bytesDropped);
+
+    const SocketFanoutStats &fanout = socketFanoutStats();
+    out.counter("swell_ws_messages_out_total", "Pesan WebSocket keluar", fanout.broadcasts, "kind", "broadcast");
+    out.counter("swell_ws_messages_out_total", "Pesan WebSocket keluar", fanout.replies, "kind", "reply");
+    out.counter("swell_ws_deliveries_total", "Pesan x client tujuan", fanout.deliveries);
+    out.counter("swell_ws_bytes_out_total", "Byte payload x client tujuan", fanout.bytesOut);
+    out.counter("swell_ws_dropped_total", "Pesan dibuang karena antrian client penuh", fanout.dropped);
+    out.counter("swell_ws_status_skipped_total", "Status dilewati untuk client lambat", fanout.statusSkipped);
+    out.gauge("swell_ws_queue_high_water", "Antrian kirim client terpanjang", (long)fanout.queueHighWater);
+
+    CommandQueueStats &commands = commandQueueStats();
+    out.counter("swell_commands_queued_total", "Command masuk antrian", commands.enqueued);
+    out.counter("swell_commands_dropped_total", "Command dibuang (antrian penuh)", commands.dropped);
+    out.counter("swell_commands_coalesced_total", "Command slider yang digabung", commands.coalesced);
+
+    const StatusBroadcastStats &status = statusBroadcastStats();
+    out.counter("swell_status_messages_total", "Broadcast status", status.fullUpdates, "kind", "full");
+    out.counter("swell_status_messages_total", "Broadcast status", status.patches, "kind", "patch");
+    out.counter("swell_status_messages_total", "Broadcast status", status.heartbeats, "kind", "heartbeat");
+    out.counter("swell_schedule_runs_total", "Evaluasi scheduler", scheduleStats().runs);
+
+    const SettingsPersistenceStats &settings = userSettingsPersistenceStats();
+    out.counter("swell_settings_changes_total", "Perubahan user settings", settings.changeRequests);
+    out.counter("swell_nvs_writes_total", "Write NVS user settings", settings.flashWrites);
+    out.counter("swell_nvs_write_failures_total", "Write NVS user settings yang gagal", settings.writeFailures);
+    out.counter("swell_nvs_compat_writes_total", "Write NVS ke key settingsCompat (record versi lebih baru di flash)",
+                settings.compatWrites);
+
+    const AudioDriverStats &audio = audioDriverStats();
+    out.counter("swell_audio_frames_total", "Frame UART ke DFPlayer", audio.framesSent);
+    out.counter("swell_audio_retries_total", "Frame DFPlayer yang dikirim ulang", audio.retries);
+    out.counter("swell_audio_timeouts_total", "Frame DFPlayer tanpa ACK", audio.timeouts);
+    out.counter("swell_audio_errors_total", "Balasan error DFPlayer", audio.errors);
+    out.histogram("swell_audio_ack_milliseconds", "Latensi command -> ACK DFPlayer", audioAck);
+
+    const WallClockStats &clock = wallClockStats();
+    out.counter("swell_rtc_reads_total", "Pembacaan DS3231", clock.syncs);
+    out.counter("swell_clock_steps_total", "Koreksi fase jam software", clock.steps);
+    out.gauge("swell_clock_drift_ppb", "Koreksi laju millis()", clock.driftPpb);
+
+    out.counter("swell_light_fade_segments_total", "Segmen fade LEDC", lightStats().segments);
+
+    const LogStats &log = logStats();
+    out.counter("swell_log_lines_total", "Baris log", log.written);
+    out.counter("swell_log_lost_total", "Baris log tertimpa sebelum dikuras", log.lost);
+
+    if (platformSection)
+        platformSection(out);
+}
+
+// =================================================================
+// PROMETHEUS TEXT
+// =================================================================
+
+class PrometheusWriter : public MetricsWriter
+{
+public:
+    PrometheusWriter(MetricsTextSink sink, void *context) : sink(sink), context(context) {}
+
+    void counter(const char *name, const char *help, unsigned long value,
+                 const char *label, const char *labelValue) override
+    {
+        header(name, help, "counter");
+        series(name, "", label, labelValue, "%lu", value);
+    }
+
+    void gauge(const char *name, const char *help, long value, const char *label, const char *labelValue) override
+    {
+        header(name, help, "gauge");
+        series(name, "", label, labelValue, "%ld", value);
+    }
+
+    void histogram(const char *name, const char *help, const Histogram &histogram) override
+    {
+        header(name, help, "histogram");
+        unsigned long cumulative = 0;
+        char bound[12];
+        for (size_t i = 0; i < histogram.boundCount; i++)
+        {
+            cumulative += histogram.buckets[i];
+            snprintf(bound, sizeof(bound), "%lu", (unsigned long)histogram.bounds[i]);
+            series(name, "_bucket", "le", bound, "%lu", cumulative);
+        }
+        series(name, "_bucket", "le", "+Inf", "%lu", histogram.count);
+        series(name, "_sum", nullptr, nullptr, "%llu", (unsigned long long)histogram.sum);
+        series(name, "_count", nullptr, nullptr, "%lu", histogram.count);
+    }
+
+private:
+    void emit(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char line[160];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        if (len > 0)
+            sink(context, line, (size_t)len < sizeof(line) ? (size_t)len : sizeof(line) - 1);
+    }
+
+    // HELP/TYPE sekali per nama, seri berlabel berikutnya hanya nilainya
+    void header(const char *name, const char *help, const char *type)
+    {
+        if (lastName && strcmp(lastName, name) == 0)
+            return;
+        lastName = name;
+        emit("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    }
+
+    template <typename T>
+    void series(const char *name, const char *suffix, const char *label, const char *labelValue,
+                const char *format, T value)
+    {
+        char text[24];
+        snprintf(text, sizeof(text), format, value);
+        if (label)
+            emit("%s%s{%s=\"%s\"} %s\n", name, suffix, label, labelValue, text);
+        else
+            emit("%s%s %s\n", name, suffix, text);
+    }
+
+    MetricsTextSink sink;
+    void *context;
+    const char *lastName = nullptr;
+};
+
+void writeMetricsText(MetricsTextSink sink, void *context)
+{
+    PrometheusWriter writer(sink, context);
+    writeMetrics(writer);
+}
+
+struct TextBuffer
+{
+    char *buffer;
+    size_t capacity;
+    size_t len;
+    bool overflow;
+};
+
+static void appendText(void *context, const char *text, size_t len)
+{
+    TextBuffer &out = *(TextBuffer *)context;
+    if (out.overflow || out.len + len >= out.capacity)
+    {
+        out.overflow = true;
+        return;
+    }
+    memcpy(out.buffer + out.len, text, len);
+    out.len += len;
+    out.buffer[out.len] = '\0';
+}
+
+size_t writeMetricsText(char *buffer, size_t capacity)
+{
+    if (capacity == 0)
+        return 0;
+    TextBuffer out = {buffer, capacity, 0, false};
+    buffer[0] = '\0';
+    writeMetricsText(appendText, &out);
+    return out.overflow ? 0 : out.len;
+}
+
+// =================================================================
+// JSON (getMetrics)
+// =================================================================
+
+class JsonMetricsWriter : public MetricsWriter
+{
+public:
+    explicit JsonMetricsWriter(JsonWriter &json) : json(json) {}
+
+    void counter(const char *name, const char *, unsigned long value,
+                 const char *label, const char *labelValue) override
+    {
+        json.add(key(name, label, labelValue), value);
+    }
+
+    void gauge(const char *name, const char *, long value, const char *label, const char *labelValue) override
+    {
+        json.add(key(name, label, labelValue), value);
+    }
+
+    void histogram(const char *name, const char *, const Histogram &histogram) override
+    {
+        json.beginObject(name).beginArray("le");
+        for (size_t i = 0; i < histogram.boundCount; i++)
+            json.add(nullptr, (unsigned long)histogram.bounds[i]);
+        json.endArray().beginArray("buckets"); // Kumulatif seperti Prometheus, tanpa +Inf
+        unsigned long cumulative = 0;
+        for (size_t i = 0; i < histogram.boundCount; i++)
+        {
+            cumulative += histogram.buckets[i];
+            json.add(nullptr, cumulative);
+        }
+        json.endArray()
+            .add("sum", (long long)histogram.sum)
+            .add("count", histogram.count)
+            .endObject();
+    }
+
+private:
+    // "nama" atau "nama{label=nilai}"
+    const char *key(const char *name, const char *label, const char *labelValue)
+    {
+        if (!label)
+            return name;
+        snprintf(keyBuffer, sizeof(keyBuffer), "%s{%s=%s}", name, label, labelValue);
+        return keyBuffer;
+    }
+
+    JsonWriter &json;
+    char keyBuffer[80];
+};
+
+void sendMetrics(uint32_t clientId)
+{
+    // Static: terlalu besar untuk stack loop(), hanya dipakai dari loop()
+    static char buffer[METRICS_JSON_CAPACITY];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject().add("type", "metrics").beginObject("metrics");
+
+    JsonMetricsWriter writer(json);
+    writeMetrics(writer);
+
+    json.endObject().endObject();
+    sendJson(json, clientId);
+}
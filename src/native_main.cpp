@@ -0,0 +1,214 @@
+/**
+ * @file native_main.cpp
+ * @brief Swell Smart Lamp - Host simulator untuk env:native
+ *
+ * Menjalankan scheduler dan command path di Linux dengan fake hardware,
+ * waktu disimulasikan (--ticks = detik simulasi, loop melompat dari
+ * deadline ke deadline seperti loop() di ESP32). Dipakai untuk profiling:
+ *
+ *   pio run -e native
+ *   .pio/build/native/program --ticks 5000000
+ *   .pio/build/native/program --rtc-drift-ppm 40   (uji estimasi drift jam software)
+ *   pio run -e native32 && .pio/build/native32/program --ticks 5000000 --rtc-drift-ppm 20
+ *                                                  (millis() 32-bit seperti ESP32, lewat wrap 49,7 hari)
+ *   .pio/build/native/program --metrics            (cetak teks GET /metrics di akhir)
+ *   .pio/build/native/program --wifi-outage 3600,300 (router mati detik 3600 selama 300 s)
+ *   perf record .pio/build/native/program
+ *   valgrind --tool=callgrind .pio/build/native/program --ticks 100000
+ */
+
+#if !defined(ARDUINO) && !defined(PIO_UNIT_TESTING) // pio test punya main() sendiri
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "actuators.h"
+#include "audio_driver.h"
+#include "boot_sequence.h"
+#include "hal_native.h"
+#include "light_engine.h"
+#include "metrics.h"
+#include "settings_store.h"
+#include "swell_core.h"
+#include "swell_log.h"
+#include "wall_clock.h"
+#include "wifi_manager.h"
+
+static void printText(void *, const char *text, size_t len)
+{
+    fwrite(text, 1, len, stdout);
+}
+
+// Subset boot ESP32 yang punya fake (tanpa SPIFFS / web server)
+static BootStageState startWiFi()
+{
+    wifiManagerBegin("swell-sim", "", nullptr);
+    return BOOT_RUNNING;
+}
+
+static BootStageState pollWiFi()
+{
+    return wifiOnline() ? BOOT_DONE : BOOT_RUNNING;
+}
+
+static BootStageState startSettings()
+{
+    loadUserSettings();
+    return BOOT_DONE;
+}
+
+static BootStageState startAudio()
+{
+    initializeDFPlayer();
+    return BOOT_RUNNING;
+}
+
+static BootStageState pollAudio()
+{
+    AudioDriverState state = audioDriverState();
+    if (state == AUDIO_READY)
+        return BOOT_DONE;
+    return state == AUDIO_FAILED ? BOOT_FAILED : BOOT_RUNNING;
+}
+
+static const BootStage BOOT_STAGES[] = {
+    {"wifi", 0, startWiFi, pollWiFi, 10000},
+    {"settings", 0, startSettings, nullptr, 0},
+    {"audio", BOOT_AFTER(1), startAudio, pollAudio, 0},
+};
+
+static void sendCommand(const char *json)
+{
+    handleWebSocketMessage(reinterpret_cast<const uint8_t *>(json), strlen(json));
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long ticks = 1000000;
+    bool printMetrics = false;
+    unsigned long outageStartS = 0, outageS = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+            ticks = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--rtc-drift-ppm") == 0 && i + 1 < argc)
+            nativeFakes.rtc.driftPpm = strtol(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "-v") == 0)
+            swellNativeLogEnabled = true;
+        else if (strcmp(argv[i], "--metrics") == 0)
+            printMetrics = true;
+        else if (strcmp(argv[i], "--wifi-outage") == 0 && i + 1 < argc)
+            sscanf(argv[++i], "%lu,%lu", &outageStartS, &outageS);
+    }
+
+    // Mulai 1 jam sebelum timer window (21:00) supaya semua transisi terlewati
+    hal.rtc->set(0, 0, 20, 2, 5, 1, 26);
+    wallClockSync(true);
+
+    bootBegin(BOOT_STAGES, sizeof(BOOT_STAGES) / sizeof(BOOT_STAGES[0]));
+    serviceAudio(); // Fake DFPlayer langsung membalas handshake
+    serviceBoot();
+
+    sendCommand("{\"command\":\"timer-toggle\",\"value\":true}");
+    sendCommand("{\"command\":\"timer-confirm\",\"value\":{\"start\":\"21:00\",\"end\":\"04:00\"}}");
+    sendCommand("{\"command\":\"music-toggle\",\"value\":true}");
+    sendCommand("{\"command\":\"aroma-toggle\",\"value\":true}");
+    sendCommand("{\"command\":\"alarm-toggle\",\"value\":true}");
+
+    nativeFakes.sockets.keepLastMessage = false;
+
+    // Router mati/hidup di waktu simulasi absolut (detik sejak boot)
+    unsigned long long outageEdges[2] = {outageStartS * 1000ULL, (outageStartS + outageS) * 1000ULL};
+    size_t nextEdge = outageS ? 0 : 2;
+
+    // Seperti loop(): lompat langsung ke deadline berikutnya, bukan polling 1 Hz
+    unsigned long wakeups = 0;
+    unsigned long long remainingMs = (unsigned long long)ticks * 1000ULL;
+    auto started = std::chrono::steady_clock::now();
+    while (remainingMs > 0)
+    {
+        unsigned long sleepMs = millisUntilNextSchedule();
+        unsigned long flushMs = millisUntilUserSettingsFlush();
+        if (flushMs < sleepMs)
+            sleepMs = flushMs;
+        unsigned long audioMs = millisUntilAudioService();
+        if (audioMs < sleepMs)
+            sleepMs = audioMs;
+        unsigned long lightMs = millisUntilLightService();
+        if (lightMs < sleepMs)
+            sleepMs = lightMs;
+        unsigned long bootMs = millisUntilBootService();
+        if (bootMs < sleepMs)
+            sleepMs = bootMs;
+        unsigned long wifiMs = millisUntilWiFiService();
+        if (wifiMs < sleepMs)
+            sleepMs = wifiMs;
+        if (nextEdge < 2)
+        {
+            unsigned long long now = nativeFakes.clock.now;
+            unsigned long long edgeMs = outageEdges[nextEdge] > now ? outageEdges[nextEdge] - now : 0;
+            if (edgeMs < sleepMs)
+                sleepMs = (unsigned long)edgeMs;
+        }
+        if (sleepMs > remainingMs)
+            sleepMs = (unsigned long)remainingMs;
+
+        nativeFakes.clock.advance(sleepMs);
+        remainingMs -= sleepMs;
+        auto wake = std::chrono::steady_clock::now();
+        if (nextEdge < 2 && nativeFakes.clock.now >= outageEdges[nextEdge])
+            nativeFakes.wifi.setAccessPoint(nextEdge++ != 0);
+        serviceWiFi();
+        serviceWallClock();
+        serviceSchedules();
+        serviceUserSettingsPersistence();
+        serviceAudio();
+        serviceLight();
+        serviceBoot();
+        recordLoopIteration((unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+                                std::chrono::steady_clock::now() - wake)
+                                .count());
+        wakeups++;
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    printf("simulated time      : %lu s (%.1f days)\n", ticks, ticks / 86400.0);
+    printf("wall time           : %.3f s\n", elapsed);
+    printf("loop wakeups        : %lu (%.2f per simulated hour)\n", wakeups, ticks ? wakeups * 3600.0 / ticks : 0.0);
+    printf("scheduler runs      : %lu\n", scheduleStats().runs);
+    printf("boot ready          : %lu ms simulated (%s)\n", bootReadyMs(), bootComplete() ? "all stages" : "INCOMPLETE");
+    const LightStats &light = lightStats();
+    printf("pwm writes          : %lu (%lu hardware fades, %lu while fading)\n",
+           nativeFakes.pwm.writes, nativeFakes.pwm.fades, nativeFakes.pwm.conflicts);
+    printf("light scenes        : %lu (%lu fade segments, %lu deferred)\n", light.scenes, light.segments, light.deferred);
+    printf("gpio writes         : %lu\n", nativeFakes.gpio.writes);
+    const ActuatorStats &actuators = actuatorStats();
+    for (int i = 0; i < ACTUATOR_COUNT; i++)
+        printf("  %-17s : %lu written (%lu fades), %lu suppressed\n", actuatorName((ActuatorOutput)i),
+               actuators.writes[i], actuators.fades[i], actuators.suppressed[i]);
+    const WallClockStats &clock = wallClockStats();
+    printf("rtc refreshes       : %lu (%lu phase steps, last %ld ms, drift %.2f ppm)\n",
+           nativeFakes.rtc.refreshes, clock.steps, clock.lastStepMs, clock.driftPpb / 1000.0);
+    const AudioDriverStats &audio = audioDriverStats();
+    printf("audio commands      : %lu (%lu coalesced, %lu suppressed, %lu retries)\n",
+           nativeFakes.audio.commands, audio.coalesced, audio.suppressed, audio.retries);
+    printf("nvs writes          : %lu (%lu bytes, %lu failed), %lu setting changes\n",
+           nativeFakes.store.writes, nativeFakes.store.bytesWritten, userSettingsPersistenceStats().writeFailures,
+           userSettingsPersistenceStats().changeRequests);
+    printf("ws messages         : %lu (%lu bytes)\n", nativeFakes.sockets.messages, nativeFakes.sockets.bytesSent);
+    const WifiManagerStats &wifi = wifiManagerStats();
+    printf("wifi                : %lu connects, %lu drops, %lu attempts (%lu cached BSSID, %lu scans), last reconnect %lu ms\n",
+           wifi.connects, wifi.disconnects, wifi.attempts, nativeFakes.wifi.directJoins, nativeFakes.wifi.scans,
+           wifi.lastReconnectMs);
+
+    if (printMetrics)
+    {
+        printf("\n");
+        writeMetricsText(printText, nullptr);
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,377 @@
+/**
+ * @file settings_store.cpp
+ * @brief Swell Smart Lamp - Write-behind persistence untuk UserSettings
+ */
+
+#include "settings_store.h"
+
+#include <string.h>
+
+#include "swell_core.h"
+#include "swell_log.h"
+
+static const char *SETTINGS_NAMESPACE = "swell-app";
+static const char *SETTINGS_KEY = "settings";
+static const char *SETTINGS_COMPAT_KEY = "settingsCompat"; // Record versi ini saat SETTINGS_KEY berisi versi lebih baru
+static const char *LEGACY_SETTINGS_KEY = "userSettings"; // Format v1 (raw struct)
+
+/**
+ * @brief Layout v1: dump mentah UserSettings lama (termasuk padding dan
+ *        field const alarm.track). Hanya dipakai untuk migrasi.
+ */
+struct LegacyUserSettingsV1
+{
+    struct
+    {
+        bool on;
+        bool confirmed;
+        int startHour;
+        int startMinute;
+        int endHour;
+        int endMinute;
+    } timer;
+    struct
+    {
+        int intensity;
+    } light;
+    struct
+    {
+        bool enabled;
+    } aromatherapy;
+    struct
+    {
+        bool enabled;
+        int track;
+    } alarm;
+    struct
+    {
+        bool enabled;
+        int track;
+        int volume;
+    } music;
+};
+
+// =================================================================
+// PERSISTENCE STATE
+// =================================================================
+
+static bool dirty = false;
+static unsigned long firstDirtyAt = 0;
+static unsigned long lastChangeAt = 0;
+
+// Record terakhir yang ada di flash, untuk skip write jika tidak berubah
+static uint8_t persistedRecord[SETTINGS_RECORD_MAX_SIZE];
+static size_t persistedRecordSize = 0;
+static bool newerRecordStored = false; // SETTINGS_KEY dari firmware lebih baru: simpan ke SETTINGS_COMPAT_KEY
+static bool legacyKeyStored = false;   // Key v1 dihapus setelah record baru pasti tersimpan
+
+static SettingsPersistenceStats stats;
+
+// =================================================================
+// RECORD CODEC
+// =================================================================
+
+uint16_t settingsCrc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+size_t encodeSettingsRecord(const UserSettings &settings, uint8_t *out, size_t capacity)
+{
+    const size_t size = SETTINGS_RECORD_HEADER_SIZE + SETTINGS_PAYLOAD_SIZE + SETTINGS_RECORD_CRC_SIZE;
+    if (capacity < size)
+        return 0;
+
+    out[0] = 'S';
+    out[1] = 'W';
+    out[2] = SETTINGS_RECORD_VERSION;
+    out[3] = SETTINGS_PAYLOAD_SIZE;
+
+    uint8_t *payload = out + SETTINGS_RECORD_HEADER_SIZE;
+    payload[FIELD_FLAGS] = (settings.timer.on ? 0x01 : 0) |
+                           (settings.timer.confirmed ? 0x02 : 0) |
+                           (settings.aromatherapy.enabled ? 0x04 : 0) |
+                           (settings.alarm.enabled ? 0x08 : 0) |
+                           (settings.music.enabled ? 0x10 : 0);
+    payload[FIELD_TIMER_START_HOUR] = (uint8_t)settings.timer.startHour;
+    payload[FIELD_TIMER_START_MINUTE] = (uint8_t)settings.timer.startMinute;
+    payload[FIELD_TIMER_END_HOUR] = (uint8_t)settings.timer.endHour;
+    payload[FIELD_TIMER_END_MINUTE] = (uint8_t)settings.timer.endMinute;
+    payload[FIELD_LIGHT_INTENSITY] = (uint8_t)settings.light.intensity;
+    payload[FIELD_MUSIC_TRACK] = (uint8_t)settings.music.track;
+    payload[FIELD_MUSIC_VOLUME] = (uint8_t)settings.music.volume;
+
+    uint16_t crc = settingsCrc16(out, SETTINGS_RECORD_HEADER_SIZE + SETTINGS_PAYLOAD_SIZE);
+    out[size - 2] = (uint8_t)(crc & 0xFF);
+    out[size - 1] = (uint8_t)(crc >> 8);
+    return size;
+}
+
+/**
+ * @brief Decode + validasi satu kali jalan. Field yang tidak ada di record
+ *        atau di luar range memakai default, field lain tetap dipakai.
+ */
+SettingsDecodeResult decodeSettingsRecord(const uint8_t *data, size_t len, UserSettings &settings)
+{
+    if (len < SETTINGS_RECORD_HEADER_SIZE + SETTINGS_RECORD_CRC_SIZE)
+        return SETTINGS_DECODE_TRUNCATED;
+    if (data[0] != 'S' || data[1] != 'W')
+        return SETTINGS_DECODE_BAD_MAGIC;
+
+    uint8_t version = data[2];
+    size_t payloadSize = data[3];
+    if (len != SETTINGS_RECORD_HEADER_SIZE + payloadSize + SETTINGS_RECORD_CRC_SIZE)
+        return SETTINGS_DECODE_TRUNCATED;
+
+    uint16_t storedCrc = (uint16_t)(data[len - 2] | (data[len - 1] << 8));
+    if (settingsCrc16(data, len - SETTINGS_RECORD_CRC_SIZE) != storedCrc)
+        return SETTINGS_DECODE_BAD_CRC;
+    if (version > SETTINGS_RECORD_VERSION)
+        return SETTINGS_DECODE_NEWER_VERSION; // Posisi field bisa sudah berarti lain
+    if (version < SETTINGS_RECORD_VERSION)
+        return SETTINGS_DECODE_BAD_VERSION;
+
+    const uint8_t *payload = data + SETTINGS_RECORD_HEADER_SIZE;
+    const UserSettings defaults;
+    UserSettings decoded;
+
+    auto field = [&](SettingsField index, int fallback, int low, int high) -> int
+    {
+        if (index >= payloadSize)
+            return fallback;
+        int value = payload[index];
+        return (value < low || value > high) ? fallback : value;
+    };
+
+    uint8_t flags = (uint8_t)field(FIELD_FLAGS, 0, 0, 0xFF);
+    decoded.timer.on = flags & 0x01;
+    decoded.timer.confirmed = (flags & 0x02) && decoded.timer.on;
+    decoded.aromatherapy.enabled = flags & 0x04;
+    decoded.alarm.enabled = flags & 0x08;
+    decoded.music.enabled = flags & 0x10;
+
+    decoded.timer.startHour = field(FIELD_TIMER_START_HOUR, defaults.timer.startHour, 0, 23);
+    decoded.timer.startMinute = field(FIELD_TIMER_START_MINUTE, defaults.timer.startMinute, 0, 59);
+    decoded.timer.endHour = field(FIELD_TIMER_END_HOUR, defaults.timer.endHour, 0, 23);
+    decoded.timer.endMinute = field(FIELD_TIMER_END_MINUTE, defaults.timer.endMinute, 0, 59);
+    decoded.light.intensity = field(FIELD_LIGHT_INTENSITY, defaults.light.intensity, 0, 100);
+    decoded.music.track = getValidMusicTrackNumber(field(FIELD_MUSIC_TRACK, defaults.music.track, 0, 0xFF));
+    decoded.music.volume = field(FIELD_MUSIC_VOLUME, defaults.music.volume, 0, 30);
+
+    settings = decoded;
+    return SETTINGS_DECODE_OK;
+}
+
+/**
+ * @brief Konversi dump v1 ke UserSettings dengan validasi range yang sama
+ */
+static bool migrateLegacySettings(UserSettings &settings)
+{
+    LegacyUserSettingsV1 legacy;
+    if (hal.store->getBytes(LEGACY_SETTINGS_KEY, &legacy, sizeof(legacy)) != sizeof(legacy))
+        return false;
+
+    auto inRange = [](int value, int low, int high, int fallback)
+    { return (value < low || value > high) ? fallback : value; };
+
+    const UserSettings defaults;
+    settings.timer.on = legacy.timer.on;
+    settings.timer.confirmed = legacy.timer.confirmed && legacy.timer.on;
+    settings.timer.startHour = inRange(legacy.timer.startHour, 0, 23, defaults.timer.startHour);
+    settings.timer.startMinute = inRange(legacy.timer.startMinute, 0, 59, defaults.timer.startMinute);
+    settings.timer.endHour = inRange(legacy.timer.endHour, 0, 23, defaults.timer.endHour);
+    settings.timer.endMinute = inRange(legacy.timer.endMinute, 0, 59, defaults.timer.endMinute);
+    settings.light.intensity = inRange(legacy.light.intensity, 0, 100, defaults.light.intensity);
+    settings.aromatherapy.enabled = legacy.aromatherapy.enabled;
+    settings.alarm.enabled = legacy.alarm.enabled;
+    settings.music.enabled = legacy.music.enabled;
+    settings.music.track = getValidMusicTrackNumber(legacy.music.track);
+    settings.music.volume = inRange(legacy.music.volume, 0, 30, defaults.music.volume);
+    return true;
+}
+
+// =================================================================
+// ⭐ FIXED: USER SETTINGS MANAGEMENT FUNCTIONS
+// =================================================================
+
+bool saveUserSettings()
+{
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    size_t size = encodeSettingsRecord(userSettings, record, sizeof(record));
+
+    const char *key = newerRecordStored ? SETTINGS_COMPAT_KEY : SETTINGS_KEY;
+    bool ok = hal.store->begin(SETTINGS_NAMESPACE, false) && hal.store->putBytes(key, record, size) == size;
+    if (ok && legacyKeyStored)
+        legacyKeyStored = !hal.store->remove(LEGACY_SETTINGS_KEY);
+    hal.store->end();
+
+    if (!ok)
+    {
+        // Tetap dirty: dicoba lagi di deadline flush berikutnya, persistedRecord tetap isi flash lama
+        unsigned long now = hal.clock->millis();
+        dirty = true;
+        firstDirtyAt = now;
+        lastChangeAt = now;
+        stats.writeFailures++;
+        SWELL_LOGW(LOG_SETTINGS, "⚠️ Gagal menulis user settings ke flash (%lu kali), dicoba lagi.", stats.writeFailures);
+        return false;
+    }
+
+    memcpy(persistedRecord, record, size);
+    persistedRecordSize = size;
+    dirty = false;
+    stats.flashWrites++;
+    if (newerRecordStored)
+        stats.compatWrites++;
+    SWELL_LOGI(LOG_SETTINGS, "📁 User settings saved to flash memory (%u bytes, v%u).",
+               (unsigned)size, SETTINGS_RECORD_VERSION);
+    return true;
+}
+
+void loadUserSettings()
+{
+    hal.store->begin(SETTINGS_NAMESPACE, true);
+
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    size_t size = hal.store->isKey(SETTINGS_KEY) ? hal.store->getBytes(SETTINGS_KEY, record, sizeof(record)) : 0;
+    bool hasLegacy = hal.store->isKey(LEGACY_SETTINGS_KEY);
+
+    UserSettings loaded;
+    bool migrated = false;
+    persistedRecordSize = 0;
+    newerRecordStored = false;
+
+    if (size > 0)
+    {
+        SettingsDecodeResult result = decodeSettingsRecord(record, size, loaded);
+        if (result == SETTINGS_DECODE_OK)
+        {
+            userSettings = loaded;
+            memcpy(persistedRecord, record, size);
+            persistedRecordSize = size;
+            SWELL_LOGI(LOG_SETTINGS, "📁 User settings loaded from flash memory (v%u).", record[2]);
+        }
+        else if (result == SETTINGS_DECODE_NEWER_VERSION)
+        {
+            // Record versi baru tidak disentuh; perubahan di firmware ini tetap
+            // tersimpan, di key terpisah
+            newerRecordStored = true;
+            uint8_t version = record[2];
+            size = hal.store->isKey(SETTINGS_COMPAT_KEY) ? hal.store->getBytes(SETTINGS_COMPAT_KEY, record, sizeof(record)) : 0;
+            if (size > 0 && decodeSettingsRecord(record, size, loaded) == SETTINGS_DECODE_OK)
+            {
+                userSettings = loaded;
+                memcpy(persistedRecord, record, size);
+                persistedRecordSize = size;
+            }
+            SWELL_LOGW(LOG_SETTINGS, "⚠️ Settings record v%u dari firmware lebih baru (tidak ditimpa), %s; perubahan disimpan di key \"%s\".",
+                       version, persistedRecordSize ? "memakai settings tersimpan" : "menggunakan defaults", SETTINGS_COMPAT_KEY);
+        }
+        else
+        {
+            SWELL_LOGW(LOG_SETTINGS, "⚠️ Settings record rusak (error %d), menggunakan defaults.", (int)result);
+        }
+    }
+    else if (hasLegacy && migrateLegacySettings(loaded))
+    {
+        userSettings = loaded;
+        migrated = true;
+        SWELL_LOGI(LOG_SETTINGS, "📁 Legacy settings (v1) ditemukan, migrasi ke format baru.");
+    }
+    else
+    {
+        SWELL_LOGI(LOG_SETTINGS, "📁 No saved settings found, using defaults.");
+    }
+
+    hal.store->end();
+
+    legacyKeyStored = migrated;
+    if (migrated)
+        saveUserSettings(); // Gagal: tetap dirty, key v1 dihapus saat flush berikutnya berhasil
+}
+
+// =================================================================
+// WRITE-BEHIND (COALESCED) PERSISTENCE
+// =================================================================
+
+void markUserSettingsDirty()
+{
+    unsigned long now = hal.clock->millis();
+    stats.changeRequests++;
+
+    if (dirty)
+    {
+        stats.writesCoalesced++;
+    }
+    else
+    {
+        dirty = true;
+        firstDirtyAt = now;
+    }
+    lastChangeAt = now;
+}
+
+void serviceUserSettingsPersistence()
+{
+    if (!dirty)
+        return;
+
+    unsigned long now = hal.clock->millis();
+    if (now - lastChangeAt >= SETTINGS_FLUSH_QUIET_MS || now - firstDirtyAt >= SETTINGS_FLUSH_DEADLINE_MS)
+    {
+        flushUserSettings();
+    }
+}
+
+unsigned long millisUntilUserSettingsFlush()
+{
+    if (!dirty)
+        return SETTINGS_NO_FLUSH_PENDING;
+
+    unsigned long now = hal.clock->millis();
+    unsigned long sinceChange = now - lastChangeAt;
+    unsigned long sinceFirst = now - firstDirtyAt;
+    if (sinceChange >= SETTINGS_FLUSH_QUIET_MS || sinceFirst >= SETTINGS_FLUSH_DEADLINE_MS)
+        return 0;
+
+    unsigned long quietLeft = SETTINGS_FLUSH_QUIET_MS - sinceChange;
+    unsigned long deadlineLeft = SETTINGS_FLUSH_DEADLINE_MS - sinceFirst;
+    return quietLeft < deadlineLeft ? quietLeft : deadlineLeft;
+}
+
+void flushUserSettings()
+{
+    if (!dirty)
+        return;
+
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    size_t size = encodeSettingsRecord(userSettings, record, sizeof(record));
+    if (size == persistedRecordSize && memcmp(record, persistedRecord, size) == 0)
+    {
+        dirty = false;
+        stats.writesSkippedUnchanged++;
+        SWELL_LOGD(LOG_SETTINGS, "📁 User settings unchanged, flash write skipped.");
+        return;
+    }
+
+    if (saveUserSettings())
+        SWELL_LOGI(LOG_SETTINGS, "📁 %lu flash writes for %lu setting changes",
+                   stats.flashWrites, stats.changeRequests);
+}
+
+bool userSettingsDirty()
+{
+    return dirty;
+}
+
+const SettingsPersistenceStats &userSettingsPersistenceStats()
+{
+    return stats;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file socket_fanout.cpp
+ * @brief Swell Smart Lamp - Pengiriman WebSocket per client (balasan terarah + backpressure)
+ */
+
+#include "socket_fanout.h"
+
+#include "hal.h"
+#include "json_writer.h"
+#include "swell_log.h"
+
+static SocketFanoutStats stats;
+
+// Client yang melewatkan status dan menunggu snapshot
+static uint32_t staleClients[SOCKET_MAX_CLIENTS];
+static size_t staleCount = 0;
+
+static size_t listClients(SocketClientInfo *clients)
+{
+    size_t count = hal.sockets->listClients(clients, SOCKET_MAX_CLIENTS);
+    if (count > SOCKET_MAX_CLIENTS)
+        count = SOCKET_MAX_CLIENTS;
+
+    size_t deepest = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (clients[i].queued > deepest)
+            deepest = clients[i].queued;
+    }
+
+    stats.clients = count;
+    stats.queueDepth = deepest;
+    if (deepest > stats.queueHighWater)
+        stats.queueHighWater = deepest;
+    return count;
+}
+
+static int findStale(uint32_t clientId)
+{
+    for (size_t i = 0; i < staleCount; i++)
+    {
+        if (staleClients[i] == clientId)
+            return (int)i;
+    }
+    return -1;
+}
+
+/** @brief Buang tanda stale milik client yang sudah terputus */
+static void pruneStale(const SocketClientInfo *clients, size_t count)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < staleCount; i++)
+    {
+        for (size_t c = 0; c < count; c++)
+        {
+            if (clients[c].id == staleClients[i])
+            {
+                staleClients[kept++] = staleClients[i];
+                break;
+            }
+        }
+    }
+    staleCount = kept;
+}
+
+// =================================================================
+// PUBLIC API
+// =================================================================
+
+void sendToClients(uint32_t clientId, const char *message, size_t len)
+{
+    SocketClientInfo clients[SOCKET_MAX_CLIENTS];
+    size_t count = listClients(clients);
+
+    uint32_t recipients[SOCKET_MAX_CLIENTS];
+    size_t recipientCount = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (clientId != SOCKET_ALL_CLIENTS && clients[i].id != clientId)
+            continue;
+
+        if (clients[i].queued >= SOCKET_QUEUE_LIMIT)
+            stats.dropped++;
+        else
+            recipients[recipientCount++] = clients[i].id;
+    }
+
+    if (clientId == SOCKET_ALL_CLIENTS)
+        stats.broadcasts++;
+    else
+        stats.replies++;
+    stats.deliveries += recipientCount;
+    stats.bytesOut += len * recipientCount;
+
+    hal.sockets->textTo(recipients, recipientCount, message, len);
+}
+
+void sendStatusToClients(const char *message, size_t len, StatusSnapshotWriter writeSnapshot)
+{
+    SocketClientInfo clients[SOCKET_MAX_CLIENTS];
+    size_t count = listClients(clients);
+    pruneStale(clients, count);
+
+    uint32_t recipients[SOCKET_MAX_CLIENTS];
+    size_t recipientCount = 0;
+    uint32_t resync[SOCKET_MAX_CLIENTS];
+    size_t resyncCount = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t id = clients[i].id;
+        int stale = findStale(id);
+
+        if (clients[i].queued >= SOCKET_STATUS_QUEUE_LIMIT)
+        {
+            if (stale < 0)
+            {
+                staleClients[staleCount++] = id;
+                SWELL_LOGW(LOG_WS, "🐢 Klien #%u lambat (antrian %u), status dilewati sampai antrian longgar",
+                           (unsigned)id, (unsigned)clients[i].queued);
+            }
+            stats.statusSkipped++;
+        }
+        else if (stale >= 0)
+        {
+            staleClients[stale] = staleClients[--staleCount];
+            resync[resyncCount++] = id;
+        }
+        else
+        {
+            recipients[recipientCount++] = id;
+        }
+    }
+
+    stats.broadcasts++;
+    stats.deliveries += recipientCount;
+    stats.bytesOut += len * recipientCount;
+    hal.sockets->textTo(recipients, recipientCount, message, len);
+
+    if (resyncCount == 0)
+        return;
+
+    char snapshot[OUTBOUND_JSON_CAPACITY];
+    size_t snapshotLen = writeSnapshot(snapshot, sizeof(snapshot));
+    if (snapshotLen == 0)
+        return;
+
+    stats.resyncs += resyncCount;
+    stats.deliveries += resyncCount;
+    stats.bytesOut += snapshotLen * resyncCount;
+    hal.sockets->textTo(resync, resyncCount, snapshot, snapshotLen);
+}
+
+const SocketFanoutStats &socketFanoutStats()
+{
+    return stats;
+}
@@ -0,0 +1,272 @@
+/**
+ * @file status_broadcast.cpp
+ * @brief Swell Smart Lamp - Delta status broadcast (statusUpdate / statusPatch)
+ */
+
+#include "status_broadcast.h"
+
+#include <stdio.h>
+
+#include "json_writer.h"
+#include "socket_fanout.h"
+#include "swell_core.h"
+
+// =================================================================
+// STATUS FIELD TABLE
+// =================================================================
+
+enum StatusFieldKind : uint8_t
+{
+    KIND_BOOL,
+    KIND_INT,
+    KIND_TIME // Menit sejak 00:00, dikirim sebagai "HH:MM"
+};
+
+struct StatusFieldInfo
+{
+    const char *section; // "state" atau "executionState"
+    const char *group;   // nullptr jika langsung di bawah section
+                         // (field dengan section/group sama harus berurutan)
+    const char *key;
+    StatusFieldKind kind;
+};
+
+enum StatusField : uint8_t
+{
+    STATUS_TIMER_ON,
+    STATUS_TIMER_CONFIRMED,
+    STATUS_TIMER_START,
+    STATUS_TIMER_END,
+    STATUS_AROMA_ENABLED,
+    STATUS_MUSIC_ENABLED,
+    STATUS_MUSIC_TRACK,
+    STATUS_MUSIC_VOLUME,
+    STATUS_ALARM_ENABLED,
+    STATUS_LIGHT_INTENSITY,
+    STATUS_EXEC_AROMA_ACTIVE,
+    STATUS_EXEC_MUSIC_ACTIVE,
+    STATUS_EXEC_IN_TIMER_WINDOW,
+    STATUS_EXEC_IN_MUSIC_WINDOW,
+    STATUS_FIELD_COUNT
+};
+
+static const StatusFieldInfo STATUS_FIELDS[STATUS_FIELD_COUNT] = {
+    {"state", "timer", "on", KIND_BOOL},
+    {"state", "timer", "confirmed", KIND_BOOL},
+    {"state", "timer", "start", KIND_TIME},
+    {"state", "timer", "end", KIND_TIME},
+    {"state", "aromatherapy", "enabled", KIND_BOOL},
+    {"state", "music", "enabled", KIND_BOOL},
+    {"state", "music", "track", KIND_INT},
+    {"state", "music", "volume", KIND_INT},
+    {"state", "alarm", "enabled", KIND_BOOL},
+    {"state", "light", "intensity", KIND_INT},
+    {"executionState", nullptr, "aromatherapyActive", KIND_BOOL},
+    {"executionState", nullptr, "musicActive", KIND_BOOL},
+    {"executionState", nullptr, "inTimerWindow", KIND_BOOL},
+    {"executionState", nullptr, "inMusicWindow", KIND_BOOL},
+};
+
+struct StatusSnapshot
+{
+    int16_t values[STATUS_FIELD_COUNT];
+};
+
+// =================================================================
+// BROADCAST STATE
+// =================================================================
+
+static StatusSnapshot lastBroadcast;
+static bool hasLastBroadcast = false;
+static uint32_t statusSeq = 0;
+static StatusBroadcastStats stats;
+
+static void captureStatus(StatusSnapshot &snapshot)
+{
+    int16_t *v = snapshot.values;
+    v[STATUS_TIMER_ON] = userSettings.timer.on;
+    v[STATUS_TIMER_CONFIRMED] = userSettings.timer.confirmed;
+    v[STATUS_TIMER_START] = (int16_t)(userSettings.timer.startHour * 60 + userSettings.timer.startMinute);
+    v[STATUS_TIMER_END] = (int16_t)(userSettings.timer.endHour * 60 + userSettings.timer.endMinute);
+    v[STATUS_AROMA_ENABLED] = userSettings.aromatherapy.enabled;
+    v[STATUS_MUSIC_ENABLED] = userSettings.music.enabled;
+    v[STATUS_ALARM_ENABLED] = userSettings.alarm.enabled;
+    v[STATUS_MUSIC_TRACK] = (int16_t)userSettings.music.track;
+    v[STATUS_MUSIC_VOLUME] = (int16_t)(userSettings.music.volume * 100 / 30); // DFPlayer 0-30 -> 0-100%
+    v[STATUS_LIGHT_INTENSITY] = (int16_t)userSettings.light.intensity;
+    v[STATUS_EXEC_AROMA_ACTIVE] = executionState.aromatherapyActive;
+    v[STATUS_EXEC_MUSIC_ACTIVE] = executionState.musicActive;
+    v[STATUS_EXEC_IN_TIMER_WINDOW] = executionState.inTimerWindow;
+    v[STATUS_EXEC_IN_MUSIC_WINDOW] = executionState.inMusicWindow;
+}
+
+static void writeValue(JsonWriter &json, const StatusFieldInfo &info, int16_t value)
+{
+    if (info.kind == KIND_BOOL)
+    {
+        json.add(info.key, value != 0);
+    }
+    else if (info.kind == KIND_INT)
+    {
+        json.add(info.key, (int)value);
+    }
+    else
+    {
+        unsigned minutes = (uint16_t)value;
+        char timeStr[6];
+        snprintf(timeStr, sizeof(timeStr), "%02u:%02u", minutes / 60 % 24, minutes % 60);
+        json.add(info.key, timeStr);
+    }
+}
+
+/**
+ * @brief Tulis field yang dipilih, membuka/menutup object section & group
+ *        saat berpindah (STATUS_FIELDS sudah dikelompokkan).
+ */
+static void writeFields(JsonWriter &json, const StatusSnapshot &current, const bool *include)
+{
+    const char *openSection = nullptr;
+    const char *openGroup = nullptr;
+
+    for (int i = 0; i < STATUS_FIELD_COUNT; i++)
+    {
+        if (!include[i])
+            continue;
+
+        const StatusFieldInfo &info = STATUS_FIELDS[i];
+        if (info.section != openSection)
+        {
+            if (openGroup)
+                json.endObject();
+            if (openSection)
+                json.endObject();
+            json.beginObject(info.section);
+            openSection = info.section;
+            openGroup = nullptr;
+        }
+        if (info.group != openGroup)
+        {
+            if (openGroup)
+                json.endObject();
+            if (info.group)
+                json.beginObject(info.group);
+            openGroup = info.group;
+        }
+
+        writeValue(json, info, current.values[i]);
+    }
+
+    if (openGroup)
+        json.endObject();
+    if (openSection)
+        json.endObject();
+}
+
+// =================================================================
+// ⭐ SNAPSHOT (BALASAN getStatus / CLIENT YANG TERTINGGAL)
+// =================================================================
+
+/**
+ * @brief statusUpdate lengkap dengan seq saat ini. Tidak mengubah
+ *        lastBroadcast/seq, jadi patch berikutnya tetap berurutan untuk
+ *        semua client (patch berisi nilai absolut, aman diterapkan ulang).
+ */
+static size_t writeSnapshot(char *buffer, size_t capacity)
+{
+    StatusSnapshot current;
+    captureStatus(current);
+
+    bool include[STATUS_FIELD_COUNT];
+    for (int i = 0; i < STATUS_FIELD_COUNT; i++)
+        include[i] = true;
+
+    JsonWriter json(buffer, capacity);
+    json.beginObject().add("type", "statusUpdate").add("seq", statusSeq);
+    writeFields(json, current, include);
+    json.endObject();
+    if (json.overflowed())
+        return 0;
+
+    stats.fullUpdates++;
+    stats.fieldsSent += STATUS_FIELD_COUNT;
+    return json.length();
+}
+
+void sendStatusSnapshot(uint32_t clientId)
+{
+    char buffer[OUTBOUND_JSON_CAPACITY];
+    size_t len = writeSnapshot(buffer, sizeof(buffer));
+    if (len > 0)
+        sendToClients(clientId, buffer, len);
+}
+
+// =================================================================
+// ⭐ DELTA NOTIFY
+// =================================================================
+
+/**
+ * @brief Kirim status ke semua client: full snapshot jika belum pernah
+ *        broadcast, selain itu hanya field yang berubah.
+ */
+void notifyClients()
+{
+    StatusSnapshot current;
+    captureStatus(current);
+
+    bool full = !hasLastBroadcast;
+    bool include[STATUS_FIELD_COUNT];
+    int changedFields = 0;
+    for (int i = 0; i < STATUS_FIELD_COUNT; i++)
+    {
+        include[i] = full || current.values[i] != lastBroadcast.values[i];
+        if (include[i])
+            changedFields++;
+    }
+
+    char buffer[OUTBOUND_JSON_CAPACITY];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject();
+
+    if (full)
+    {
+        json.add("type", "statusUpdate").add("seq", ++statusSeq);
+        writeFields(json, current, include);
+
+        stats.fullUpdates++;
+        stats.fieldsSent += STATUS_FIELD_COUNT;
+    }
+    else if (changedFields > 0)
+    {
+        json.add("type", "statusPatch").add("seq", ++statusSeq);
+        writeFields(json, current, include);
+
+        stats.patches++;
+        stats.fieldsSent += changedFields;
+        stats.fieldsSuppressed += STATUS_FIELD_COUNT - changedFields;
+    }
+    else
+    {
+        // Tidak ada perubahan: cukup kirim seq supaya client bisa deteksi pesan hilang
+        json.add("type", "statusSeq").add("seq", statusSeq);
+
+        stats.heartbeats++;
+        stats.fieldsSuppressed += STATUS_FIELD_COUNT;
+    }
+
+    json.endObject();
+
+    lastBroadcast = current;
+    hasLastBroadcast = true;
+    if (!json.overflowed())
+        sendStatusToClients(json.c_str(), json.length(), writeSnapshot);
+}
+
+uint32_t currentStatusSeq()
+{
+    return statusSeq;
+}
+
+const StatusBroadcastStats &statusBroadcastStats()
+{
+    return stats;
+}
@@ -0,0 +1,1239 @@
+/**
+ * @file swell_core.cpp
+ * @brief Swell Smart Lamp - Core logic yang portable (ESP32 & env:native)
+ *
+ * Dipindahkan dari main.cpp. Semua akses hardware lewat `hal` (hal.h),
+ * main.cpp hanya menyisakan WiFi, web server, SPIFFS dan setup()/loop().
+ */
+
+#include "swell_core.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "actuators.h"
+#include "audio_driver.h"
+#include "binary_protocol.h"
+#include "command_table.h"
+#include "json_writer.h"
+#include "light_engine.h"
+#include "metrics.h"
+#include "settings_store.h"
+#include "socket_fanout.h"
+#include "status_broadcast.h"
+#include "swell_log.h"
+#include "wall_clock.h"
+
+// =================================================================
+// FIXED PLAYLIST CONFIGURATION
+// =================================================================
+
+constexpr MusicTrack RELAX_PLAYLIST[] = {
+    {1, "AYAT KURSI", "0001_Relax_AYAT_KURSI.mp3"},
+    {2, "FAN", "0002_Relax_FAN.mp3"},
+    {3, "FROG", "0003_Relax_FROG.mp3"},
+    {4, "OCEAN WAVES", "0004_Relax_OCEAN_WAVES.mp3"},
+    {6, "RAINDROP", "0006_Relax_RAINDROP.mp3"},
+    {7, "RIVER", "0007_Relax_RIVER.mp3"},
+    {8, "VACUUM CLEANER", "0008_Relax_VACUM_CLEANER.mp3"},
+};
+
+constexpr int RELAX_PLAYLIST_SIZE = sizeof(RELAX_PLAYLIST) / sizeof(RELAX_PLAYLIST[0]);
+
+// FNV-1a 32-bit (gaya C++11 rekursif) supaya versi playlist dihitung saat compile
+constexpr uint32_t fnv1a(const char *text, uint32_t hash)
+{
+    return *text ? fnv1a(text + 1, (hash ^ (uint8_t)*text) * 16777619u) : hash;
+}
+
+constexpr uint32_t hashPlaylist(int index, uint32_t hash)
+{
+    return index < RELAX_PLAYLIST_SIZE
+               ? hashPlaylist(index + 1,
+                              fnv1a(RELAX_PLAYLIST[index].filename,
+                                    fnv1a(RELAX_PLAYLIST[index].title,
+                                          (hash ^ (uint32_t)RELAX_PLAYLIST[index].trackNumber) * 16777619u)))
+               : hash;
+}
+
+// Berubah otomatis setiap kali isi RELAX_PLAYLIST diubah
+constexpr uint32_t PLAYLIST_VERSION = hashPlaylist(0, 2166136261u);
+
+// =================================================================
+// GLOBAL STATE
+// =================================================================
+
+bool dfPlayerInitialized = false;
+
+// ⭐ FIXED: Global instances
+UserSettings userSettings;     // User configuration (persistent)
+ExecutionState executionState; // Hardware state (runtime only)
+
+// =================================================================
+// TIMING & STATE MANAGEMENT VARIABLES
+// =================================================================
+
+unsigned long lastAromatherapyCheck = 0;
+unsigned long aromatherapyOnTime = 0;
+bool isAromatherapySpraying = false;
+unsigned long lastAromatherapySprayStart = 0;
+
+unsigned long alarmStopTime = 0;
+bool isAlarmPlaying = false;
+
+bool isMusicPaused = false;
+bool previousMusicState = false;
+unsigned long musicStartTime = 0;
+const unsigned long MUSIC_GRACE_PERIOD = 5000;
+unsigned long musicPlayStartTime = 0;
+const unsigned long MUSIC_MAX_DURATION = 3600000;
+
+// =================================================================
+// PORTABLE HELPERS (pengganti map()/constrain() Arduino)
+// =================================================================
+
+static long mapRange(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+static int clampInt(int value, int low, int high)
+{
+    return value < low ? low : (value > high ? high : value);
+}
+
+// =================================================================
+// COMPILE-TIME FUNCTIONS UNTUK RTC SETUP
+// =================================================================
+
+int getCompileDayOfWeek(const char *ts)
+{
+    if (ts[0] == 'S' && ts[1] == 'u')
+        return 1; // Sunday
+    if (ts[0] == 'M' && ts[1] == 'o')
+        return 2; // Monday
+    if (ts[0] == 'T' && ts[1] == 'u')
+        return 3; // Tuesday
+    if (ts[0] == 'W' && ts[1] == 'e')
+        return 4; // Wednesday
+    if (ts[0] == 'T' && ts[1] == 'h')
+        return 5; // Thursday
+    if (ts[0] == 'F' && ts[1] == 'r')
+        return 6; // Friday
+    if (ts[0] == 'S' && ts[1] == 'a')
+        return 7; // Saturday
+    return 0;
+}
+
+int getCompileMonth(const char *date)
+{
+    if (date[0] == 'J' && date[1] == 'a' && date[2] == 'n')
+        return 1;
+    if (date[0] == 'F' && date[1] == 'e' && date[2] == 'b')
+        return 2;
+    if (date[0] == 'M' && date[1] == 'a' && date[2] == 'r')
+        return 3;
+    if (date[0] == 'A' && date[1] == 'p' && date[2] == 'r')
+        return 4;
+    if (date[0] == 'M' && date[1] == 'a' && date[2] == 'y')
+        return 5;
+    if (date[0] == 'J' && date[1] == 'u' && date[2] == 'n')
+        return 6;
+    if (date[0] == 'J' && date[1] == 'u' && date[2] == 'l')
+        return 7;
+    if (date[0] == 'A' && date[1] == 'u' && date[2] == 'g')
+        return 8;
+    if (date[0] == 'S' && date[1] == 'e' && date[2] == 'p')
+        return 9;
+    if (date[0] == 'O' && date[1] == 'c' && date[2] == 't')
+        return 10;
+    if (date[0] == 'N' && date[1] == 'o' && date[2] == 'v')
+        return 11;
+    if (date[0] == 'D' && date[1] == 'e' && date[2] == 'c')
+        return 12;
+    return 0;
+}
+
+#define CONV_STR2DEC_2(str, i) ((str[i] - '0') * 10 + (str[i + 1] - '0'))
+#define __TIME_SECONDS__ CONV_STR2DEC_2(__TIME__, 6)
+#define __TIME_MINUTES__ CONV_STR2DEC_2(__TIME__, 3)
+#define __TIME_HOURS__ CONV_STR2DEC_2(__TIME__, 0)
+#define __TIME_DOW__ getCompileDayOfWeek(__TIMESTAMP__)
+#define __TIME_DAYS__ CONV_STR2DEC_2(__DATE__, 4)
+#define __TIME_MONTH__ getCompileMonth(__DATE__)
+#define __TIME_YEARS__ (2000 + CONV_STR2DEC_2(__DATE__, 9))
+
+// =================================================================
+// HARDWARE INITIALIZATION FUNCTIONS
+// =================================================================
+
+void checkAndSetRTC()
+{
+    hal.rtc->refresh();
+    bool needsSetting = false;
+
+    if (hal.rtc->lostPower())
+    {
+        SWELL_LOGW(LOG_CLOCK, "⚠️ INFO: RTC kehilangan daya. Waktu akan diatur ulang ke compile time.");
+        hal.rtc->lostPowerClear();
+        needsSetting = true;
+    }
+
+    uint8_t compileYear = (uint8_t)(__TIME_YEARS__ - 2000);
+    if (hal.rtc->day() != __TIME_DAYS__ || hal.rtc->month() != __TIME_MONTH__ || hal.rtc->year() != compileYear)
+    {
+        SWELL_LOGW(LOG_CLOCK, "⚠️ INFO: Tanggal RTC tidak akurat. Waktu akan dikalibrasi ke compile time.");
+        needsSetting = true;
+    }
+
+    if (needsSetting)
+    {
+        hal.rtc->set(__TIME_SECONDS__, __TIME_MINUTES__, __TIME_HOURS__, __TIME_DOW__,
+                     __TIME_DAYS__, __TIME_MONTH__, compileYear);
+        SWELL_LOGI(LOG_CLOCK, "✅ OK: Waktu RTC berhasil disetel ke compile time.");
+    }
+    else
+    {
+        SWELL_LOGI(LOG_CLOCK, "✅ OK: Waktu RTC sudah akurat.");
+    }
+
+    wallClockSync(true); // Anchor jam software ke DS3231
+}
+
+/**
+ * @brief Event dari driver DFPlayer (dipanggil dari serviceAudio() di loop())
+ */
+static void onAudioEvent(AudioEvent event, int param)
+{
+    if (event == AUDIO_EVENT_READY)
+    {
+        SWELL_LOGI(LOG_AUDIO, "✅ DFPlayer Mini berhasil diinisialisasi!");
+        SWELL_LOGI(LOG_AUDIO, "📻 DFPlayer: volume %d/30, %d relax tracks + 1 alarm track, NO REPEAT, MAX 1 HOUR",
+                   userSettings.music.volume, RELAX_PLAYLIST_SIZE);
+    }
+    else if (event == AUDIO_EVENT_FAILED)
+    {
+        SWELL_LOGE(LOG_AUDIO, "❌ KRITIS: DFPlayer Mini gagal diinisialisasi setelah %d percobaan!", param);
+        dfPlayerInitialized = false;
+    }
+    else if (event == AUDIO_EVENT_ERROR)
+    {
+        SWELL_LOGW(LOG_AUDIO, "⚠️ DFPlayer error code %d", param);
+    }
+    else if (event == AUDIO_EVENT_FINISHED)
+    {
+        SWELL_LOGI(LOG_MUSIC, "🎵 Track %d selesai diputar", param);
+
+        // Alarm selesai sebelum 5 menit: akhiri sekarang supaya relax music lanjut
+        if (isAlarmPlaying && param == ALARM_TRACK_NUMBER)
+            alarmStopTime = hal.clock->millis();
+        requestScheduleRun();
+    }
+}
+
+/**
+ * @brief Mulai handshake DFPlayer tanpa menunggu. Command play/volume
+ *        diantrikan driver dan dikirim setelah modul siap; jika handshake
+ *        gagal, dfPlayerInitialized menjadi false (lihat onAudioEvent).
+ */
+bool initializeDFPlayer()
+{
+    SWELL_LOGI(LOG_AUDIO, "🔊 Menginisialisasi DFPlayer Mini (non-blocking)...");
+
+    audioDriverBegin(onAudioEvent);
+    audioVolume(userSettings.music.volume);
+    audioEqNormal();
+
+    dfPlayerInitialized = true;
+    return true;
+}
+
+// =================================================================
+// RTC SYSTEM FUNCTIONS
+// =================================================================
+
+// Epoch 2000-01-01 dalam ms sejak 1970 (clockSync memakai epoch JavaScript)
+const long long UNIX_MS_AT_2000 = 946684800000LL;
+
+static uint32_t lastClockSyncGeneration = 0;
+
+/**
+ * @brief Kirim waktu device sekali; browser mengekstrapolasi sendiri dengan
+ *        performance.now() dan hanya meminta lagi jika estimasi error-nya
+ *        melewati batas (lihat swell-script.js).
+ *
+ * localMs = waktu lokal device (jam dinding, bukan UTC) sebagai epoch ms,
+ * dibaca di browser dengan getUTC*(). uptimeMs untuk deteksi reboot,
+ * generation naik jika jam device melompat.
+ */
+void sendClockSync(uint32_t token, uint32_t clientId)
+{
+    const WallClockStats &clock = wallClockStats();
+
+    char buffer[OUTBOUND_JSON_CAPACITY];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .add("type", "clockSync")
+        .add("localMs", wallClockEpochMs() + UNIX_MS_AT_2000)
+        .add("uptimeMs", hal.clock->millis())
+        .add("generation", (unsigned long)clock.generation)
+        .add("driftPpb", clock.driftPpb);
+    if (token)
+    {
+        json.add("echo", (unsigned long)token);
+    }
+    json.endObject();
+
+    sendJson(json, clientId);
+    if (clientId == SOCKET_ALL_CLIENTS)
+        lastClockSyncGeneration = clock.generation; // Balasan terarah tidak menggantikan push ke semua
+}
+
+void serviceClockSync()
+{
+    if (wallClockStats().generation == lastClockSyncGeneration)
+        return;
+
+    SWELL_LOGI(LOG_CLOCK, "🕐 Jam device melompat, clockSync dikirim ke semua client");
+    sendClockSync();
+}
+
+bool calibrateRTC(int year, int month, int day, int dayOfWeek, int hour, int minute, int second)
+{
+    try
+    {
+        if (year < 2020 || year > 2099 ||
+            month < 1 || month > 12 ||
+            day < 1 || day > 31 ||
+            dayOfWeek < 1 || dayOfWeek > 7 ||
+            hour < 0 || hour > 23 ||
+            minute < 0 || minute > 59 ||
+            second < 0 || second > 59)
+        {
+            SWELL_LOGE(LOG_CLOCK, "❌ RTC Calibration: Invalid time data received");
+            return false;
+        }
+
+        SWELL_LOGI(LOG_CLOCK, "🕐 RTC Calibration: Setting time to %02d/%02d/%04d %02d:%02d:%02d",
+                   day, month, year, hour, minute, second);
+
+        hal.rtc->set(second, minute, hour, dayOfWeek, day, month, year - 2000);
+
+        wallClockSync(true); // Jam software ikut waktu baru (drift tetap dipakai)
+        requestScheduleRun(); // Waktu berubah, deadline lama tidak berlaku lagi
+        SWELL_LOGI(LOG_CLOCK, "✅ RTC Calibration: Successfully calibrated with browser time");
+        return true;
+    }
+    catch (...)
+    {
+        SWELL_LOGE(LOG_CLOCK, "❌ RTC Calibration: Exception occurred during calibration");
+        return false;
+    }
+}
+
+// =================================================================
+// MUSIC SYSTEM FUNCTIONS
+// =================================================================
+
+void playMusicTrack(int trackNumber)
+{
+    if (!dfPlayerInitialized)
+    {
+        SWELL_LOGE(LOG_MUSIC, "❌ DFPlayer tidak tersedia untuk memutar musik");
+        return;
+    }
+
+    SWELL_LOGI(LOG_MUSIC, "🎵 Playing track %d (NO REPEAT - Max 1 hour)", trackNumber);
+    audioPlay(trackNumber);
+
+    musicStartTime = hal.clock->millis();
+    musicPlayStartTime = hal.clock->millis();
+    SWELL_LOGD(LOG_MUSIC, "🎵 Music started at: %lu ms", musicStartTime);
+}
+
+void stopMusic()
+{
+    // Tidak ada yang diputar: jangan kirim stop (scheduler memanggil ini tiap run)
+    if (!dfPlayerInitialized || musicPlayStartTime == 0)
+        return;
+
+    SWELL_LOGI(LOG_MUSIC, "🎵 Music stopped");
+    audioStop();
+    isMusicPaused = false;
+    musicStartTime = 0;
+    musicPlayStartTime = 0;
+}
+
+void setMusicVolume(int volume)
+{
+    if (!dfPlayerInitialized)
+        return;
+
+    volume = clampInt(volume, 0, 30);
+    SWELL_LOGI(LOG_MUSIC, "🎵 Volume set to: %d/30", volume);
+    audioVolume(volume);
+}
+
+// =================================================================
+// PLAYLIST MANAGEMENT FUNCTIONS
+// =================================================================
+
+// Payload playlist hanya diserialisasi sekali, setelah itu dikirim dari cache
+static char playlistPayload[OUTBOUND_JSON_CAPACITY];
+static size_t playlistPayloadLength = 0;
+static char playlistEtag[9];
+
+const char *playlistEtagString()
+{
+    if (!playlistEtag[0])
+        snprintf(playlistEtag, sizeof(playlistEtag), "%08lx", (unsigned long)PLAYLIST_VERSION);
+    return playlistEtag;
+}
+
+static bool buildPlaylistPayload()
+{
+    if (playlistPayloadLength > 0)
+        return true;
+
+    JsonWriter json(playlistPayload, sizeof(playlistPayload));
+    json.beginObject()
+        .add("type", "playlist")
+        .add("etag", playlistEtagString())
+        .beginArray("playlist");
+
+    for (int i = 0; i < RELAX_PLAYLIST_SIZE; i++)
+    {
+        json.beginObject()
+            .add("trackNumber", RELAX_PLAYLIST[i].trackNumber)
+            .add("title", RELAX_PLAYLIST[i].title)
+            .add("filename", RELAX_PLAYLIST[i].filename)
+            .endObject();
+    }
+
+    json.endArray().endObject();
+    if (json.overflowed())
+    {
+        SWELL_LOGE(LOG_MUSIC, "❌ Playlist melebihi OUTBOUND_JSON_CAPACITY!");
+        return false;
+    }
+
+    playlistPayloadLength = json.length();
+    return true;
+}
+
+/**
+ * @brief Kirim playlist. Jika client sudah punya versi yang sama
+ *        (knownEtag cocok), cukup kirim "playlistUnchanged".
+ */
+void generateAndSendPlaylist(const char *knownEtag, uint32_t clientId)
+{
+    if (knownEtag && strcmp(knownEtag, playlistEtagString()) == 0)
+    {
+        char buffer[64];
+        JsonWriter json(buffer, sizeof(buffer));
+        json.beginObject().add("type", "playlistUnchanged").add("etag", playlistEtagString()).endObject();
+        sendJson(json, clientId);
+        SWELL_LOGD(LOG_MUSIC, "📻 Playlist client sudah terbaru (etag cocok).");
+        return;
+    }
+
+    SWELL_LOGI(LOG_MUSIC, "📻 Mengirim fixed playlist dengan %d lagu relax music.", RELAX_PLAYLIST_SIZE);
+
+    if (!buildPlaylistPayload())
+        return;
+
+    sendToClients(clientId, playlistPayload, playlistPayloadLength);
+    SWELL_LOGI(LOG_MUSIC, "✅ Fixed playlist berhasil dikirim ke frontend.");
+}
+
+int getValidMusicTrackNumber(int requestedTrack)
+{
+    for (int i = 0; i < RELAX_PLAYLIST_SIZE; i++)
+    {
+        if (RELAX_PLAYLIST[i].trackNumber == requestedTrack)
+        {
+            return requestedTrack;
+        }
+    }
+
+    SWELL_LOGW(LOG_MUSIC, "⚠️ Track %d tidak valid, menggunakan track %d",
+               requestedTrack, RELAX_PLAYLIST[0].trackNumber);
+    return RELAX_PLAYLIST[0].trackNumber;
+}
+
+// =================================================================
+// ⭐ FIXED: TIMING & SCHEDULING FUNCTIONS
+// =================================================================
+
+bool calculateInTimerWindow(int currentTime, int startTime, int endTime)
+{
+    if (startTime > endTime)
+    {
+        // Timer melewati midnight
+        return (currentTime >= startTime) || (currentTime < endTime);
+    }
+    else
+    {
+        // Timer dalam hari yang sama
+        return (currentTime >= startTime) && (currentTime < endTime);
+    }
+}
+
+bool isInMusicTimeWindow(int currentTimeInMinutes, int startTimeInMinutes)
+{
+    int musicEndTimeInMinutes = (startTimeInMinutes + 60) % 1440;
+
+    bool inMusicTime;
+    if (startTimeInMinutes + 60 >= 1440)
+    {
+        inMusicTime = (currentTimeInMinutes >= startTimeInMinutes) || (currentTimeInMinutes < musicEndTimeInMinutes);
+    }
+    else
+    {
+        inMusicTime = (currentTimeInMinutes >= startTimeInMinutes) && (currentTimeInMinutes < musicEndTimeInMinutes);
+    }
+
+    return inMusicTime;
+}
+
+bool hasReached1HourLimit()
+{
+    if (musicPlayStartTime == 0)
+        return false;
+    return (hal.clock->millis() - musicPlayStartTime >= MUSIC_MAX_DURATION);
+}
+
+// Scene lampu terakhir, untuk membedakan tepi jendela timer dari perubahan lain
+enum LightScene : uint8_t
+{
+    LIGHT_SCENE_OFF, // Timer belum dikonfirmasi / belum pernah di-apply
+    LIGHT_SCENE_DAY, // Putih penuh
+    LIGHT_SCENE_NIGHT // Kuning sesuai intensitas
+};
+
+static LightScene lightScene = LIGHT_SCENE_OFF;
+
+/**
+ * ⭐ FIXED: Main scheduler function - TIDAK MENGUBAH USER SETTINGS
+ * @return Detik sejak 00:00 (RTC) saat dijalankan, -1 jika timer belum dikonfirmasi
+ */
+static long applySchedules()
+{
+    // Jika timer belum dikonfirmasi, reset execution state saja
+    if (!userSettings.timer.confirmed)
+    {
+        executionState.aromatherapyActive = false;
+        executionState.musicActive = false;
+        executionState.inTimerWindow = false;
+        executionState.inMusicWindow = false;
+
+        // Matikan hardware
+        lightScene = LIGHT_SCENE_OFF;
+        setLightScene(0, 0, LIGHT_ADJUST_FADE_MS);
+        setActuator(ACTUATOR_AROMATHERAPY, 0);
+        stopMusic();
+        return -1;
+    }
+
+    // Get current time (jam software, tanpa I2C)
+    WallClockTime now;
+    wallClockNow(now);
+    int currentTimeInMinutes = now.hour * 60 + now.minute;
+    int startTimeInMinutes = userSettings.timer.startHour * 60 + userSettings.timer.startMinute;
+    int endTimeInMinutes = userSettings.timer.endHour * 60 + userSettings.timer.endMinute;
+
+    // ⭐ FIXED: Update execution state flags saja
+    executionState.inTimerWindow = calculateInTimerWindow(currentTimeInMinutes, startTimeInMinutes, endTimeInMinutes);
+    executionState.inMusicWindow = isInMusicTimeWindow(currentTimeInMinutes, startTimeInMinutes);
+
+    // =================================================================
+    // ADAPTIVE LIGHTING
+    // =================================================================
+    // Melewati tepi jendela: sunset/sunrise panjang. Selain itu (slider,
+    // konfirmasi timer, boot) cukup fade singkat
+    LightScene scene = executionState.inTimerWindow ? LIGHT_SCENE_NIGHT : LIGHT_SCENE_DAY;
+    unsigned long fadeMs = (lightScene != LIGHT_SCENE_OFF && lightScene != scene) ? LIGHT_SUNSET_FADE_MS
+                                                                                   : LIGHT_ADJUST_FADE_MS;
+    lightScene = scene;
+
+    if (scene == LIGHT_SCENE_NIGHT)
+        setLightScene(0, lightLevelForIntensity(userSettings.light.intensity), fadeMs);
+    else
+        setLightScene(LIGHT_LEVEL_MAX, 0, fadeMs);
+
+    // =================================================================
+    // ⭐ FIXED: AROMATHERAPY EXECUTION - TIDAK MENGUBAH USER SETTING
+    // =================================================================
+    if (userSettings.aromatherapy.enabled && executionState.inMusicWindow)
+    {
+        // User enabled + in window → execute
+        if (!executionState.aromatherapyActive)
+        {
+            executionState.aromatherapyActive = true;
+            executionState.aromaStartTime = hal.clock->millis();
+            SWELL_LOGI(LOG_AROMA, "💨 Aromatherapy: EXECUTION started (user enabled + in window)");
+        }
+        handleAromatherapyExecution();
+    }
+    else
+    {
+        // Outside window or disabled → stop execution BUT DON'T CHANGE USER SETTING
+        if (executionState.aromatherapyActive)
+        {
+            executionState.aromatherapyActive = false;
+            setActuator(ACTUATOR_AROMATHERAPY, 0);
+            isAromatherapySpraying = false;
+            SWELL_LOGI(LOG_AROMA, "💨 Aromatherapy: EXECUTION stopped (outside window or user disabled)");
+            // ⭐ CRITICAL: userSettings.aromatherapy.enabled TIDAK DIUBAH
+        }
+    }
+
+    // =================================================================
+    // ⭐ FIXED: MUSIC EXECUTION - TIDAK MENGUBAH USER SETTING
+    // =================================================================
+    bool shouldMusicPlay = userSettings.music.enabled &&
+                           executionState.inMusicWindow &&
+                           !hasReached1HourLimit();
+
+    if (shouldMusicPlay && !executionState.musicActive)
+    {
+        // Start music execution
+        executionState.musicActive = true;
+        if (dfPlayerInitialized)
+        {
+            setMusicVolume(userSettings.music.volume);
+            playMusicTrack(userSettings.music.track);
+            SWELL_LOGI(LOG_MUSIC, "🎵 Music: EXECUTION started (user enabled + in window)");
+        }
+    }
+    else if (!shouldMusicPlay && executionState.musicActive)
+    {
+        // Stop music execution
+        executionState.musicActive = false;
+        stopMusic();
+        if (hasReached1HourLimit())
+        {
+            SWELL_LOGI(LOG_MUSIC, "🎵 Music: EXECUTION stopped (1 hour limit reached)");
+        }
+        else
+        {
+            SWELL_LOGI(LOG_MUSIC, "🎵 Music: EXECUTION stopped (outside window)");
+        }
+        // ⭐ CRITICAL: userSettings.music.enabled TIDAK DIUBAH
+    }
+
+    // =================================================================
+    // ALARM EXECUTION
+    // =================================================================
+    if (userSettings.alarm.enabled && !isAlarmPlaying && !executionState.musicActive)
+    {
+        if (now.hour == userSettings.timer.endHour && now.minute == userSettings.timer.endMinute)
+        {
+            SWELL_LOGI(LOG_ALARM, "🔔 ALARM: Waktunya bangun! Memutar track %d", ALARM_TRACK_NUMBER);
+
+            if (dfPlayerInitialized)
+            {
+                audioVolume(30);
+                playMusicTrack(ALARM_TRACK_NUMBER);
+                isAlarmPlaying = true;
+                alarmStopTime = hal.clock->millis() + 300000; // 5 minutes
+            }
+        }
+    }
+
+    // Stop alarm setelah 5 menit
+    if (isAlarmPlaying && hal.clock->millis() >= alarmStopTime)
+    {
+        SWELL_LOGI(LOG_ALARM, "🔔 ALARM: Durasi 5 menit selesai.");
+        stopMusic();
+        isAlarmPlaying = false;
+
+        // Resume relax music jika user enabled
+        if (userSettings.music.enabled && dfPlayerInitialized)
+        {
+            int validTrack = getValidMusicTrackNumber(userSettings.music.track);
+            setMusicVolume(userSettings.music.volume);
+            playMusicTrack(validTrack);
+        }
+    }
+
+    return now.hour * 3600L + now.minute * 60L + now.second;
+}
+
+// =================================================================
+// ⭐ DEADLINE SCHEDULER
+// =================================================================
+//
+// Setelah setiap run, transisi berikutnya dihitung (timer window mulai/
+// selesai + alarm, music window selesai, semprot on/off, batas 1 jam music,
+// alarm stop). loop() tidur sampai deadline terdekat; command WebSocket
+// menjalankan scheduler langsung dan membangunkan loop() lebih awal.
+
+const unsigned long SCHEDULE_MAX_SLEEP_MS = 600000; // Evaluasi ulang minimal tiap 10 menit
+
+static unsigned long scheduleDeadline = 0;
+static bool scheduleRunRequested = true; // Run pertama saat boot
+static ScheduleStats scheduleStatistics;
+
+static void considerDeadline(unsigned long &earliestMs, unsigned long delayMs)
+{
+    if (delayMs < earliestMs)
+        earliestMs = delayMs;
+}
+
+static unsigned long millisUntilMinuteOfDay(long nowSecondOfDay, int targetMinute)
+{
+    long seconds = targetMinute * 60L - nowSecondOfDay;
+    if (seconds <= 0)
+        seconds += 86400;
+    return (unsigned long)seconds * 1000UL;
+}
+
+static unsigned long millisUntil(unsigned long at, unsigned long now)
+{
+    return (long)(at - now) > 0 ? at - now : 0;
+}
+
+static void planNextSchedule(long nowSecondOfDay)
+{
+    unsigned long now = hal.clock->millis();
+    unsigned long delayMs = SCHEDULE_MAX_SLEEP_MS;
+
+    if (nowSecondOfDay >= 0)
+    {
+        int startTimeInMinutes = userSettings.timer.startHour * 60 + userSettings.timer.startMinute;
+        int endTimeInMinutes = userSettings.timer.endHour * 60 + userSettings.timer.endMinute;
+
+        considerDeadline(delayMs, millisUntilMinuteOfDay(nowSecondOfDay, startTimeInMinutes));
+        considerDeadline(delayMs, millisUntilMinuteOfDay(nowSecondOfDay, endTimeInMinutes)); // + alarm
+        considerDeadline(delayMs, millisUntilMinuteOfDay(nowSecondOfDay, (startTimeInMinutes + 60) % 1440));
+
+        if (executionState.aromatherapyActive)
+        {
+            unsigned long next = isAromatherapySpraying ? aromatherapyOnTime + 5000 : lastAromatherapySprayStart + 300000;
+            considerDeadline(delayMs, millisUntil(next, now));
+        }
+        if (executionState.musicActive && musicPlayStartTime != 0)
+            considerDeadline(delayMs, millisUntil(musicPlayStartTime + MUSIC_MAX_DURATION, now));
+        if (isAlarmPlaying)
+            considerDeadline(delayMs, millisUntil(alarmStopTime, now));
+    }
+
+    scheduleDeadline = now + delayMs;
+}
+
+void checkAndApplySchedules()
+{
+    scheduleStatistics.runs++;
+    scheduleRunRequested = false;
+    planNextSchedule(applySchedules());
+}
+
+void requestScheduleRun()
+{
+    scheduleRunRequested = true;
+}
+
+bool serviceSchedules()
+{
+    if (!scheduleRunRequested && (long)(hal.clock->millis() - scheduleDeadline) < 0)
+        return false;
+
+    checkAndApplySchedules();
+    return true;
+}
+
+unsigned long millisUntilNextSchedule()
+{
+    return scheduleRunRequested ? 0 : millisUntil(scheduleDeadline, hal.clock->millis());
+}
+
+const ScheduleStats &scheduleStats()
+{
+    return scheduleStatistics;
+}
+
+// =================================================================
+// AROMATHERAPY SYSTEM FUNCTIONS
+// =================================================================
+
+void handleAromatherapyExecution()
+{
+    unsigned long currentMillis = hal.clock->millis();
+
+    // Handle spray duration (5 detik ON)
+    if (isAromatherapySpraying)
+    {
+        if (currentMillis - aromatherapyOnTime >= 5000) // 5 detik spray
+        {
+            setActuator(ACTUATOR_AROMATHERAPY, 0);
+            isAromatherapySpraying = false;
+            lastAromatherapySprayStart = currentMillis;
+            SWELL_LOGI(LOG_AROMA, "💨 Aromatherapy: Semprotan selesai (5 detik)");
+        }
+        return;
+    }
+
+    // Handle spray interval (5 menit OFF)
+    unsigned long timeSinceLastSpray = currentMillis - lastAromatherapySprayStart;
+    bool timeToSpray = false;
+
+    if (lastAromatherapySprayStart == 0)
+    {
+        timeToSpray = true;
+        SWELL_LOGI(LOG_AROMA, "💨 Aromatherapy: Semprotan pertama kali");
+    }
+    else if (timeSinceLastSpray >= 300000) // 5 menit
+    {
+        timeToSpray = true;
+        SWELL_LOGI(LOG_AROMA, "💨 Aromatherapy: 5 menit berlalu (%.1f menit), semprot lagi",
+                   timeSinceLastSpray / 60000.0);
+    }
+
+    if (timeToSpray)
+    {
+        setActuator(ACTUATOR_AROMATHERAPY, 1);
+        isAromatherapySpraying = true;
+        aromatherapyOnTime = currentMillis;
+        SWELL_LOGI(LOG_AROMA, "💨 Aromatherapy: Mulai semprot");
+    }
+}
+
+void resetAromatherapy()
+{
+    setActuator(ACTUATOR_AROMATHERAPY, 0);
+
+    isAromatherapySpraying = false;
+    lastAromatherapySprayStart = 0;
+    SWELL_LOGI(LOG_AROMA, "💨 Aromatherapy: Reset semua state");
+}
+
+// =================================================================
+// ⭐ FIXED: WEBSOCKET COMMUNICATION FUNCTIONS
+// =================================================================
+
+static void copyEtag(char *dest, size_t size, const char *etag)
+{
+    snprintf(dest, size, "%s", etag ? etag : "");
+}
+
+static void parseTime(const char *text, int16_t &hour, int16_t &minute)
+{
+    int parsedHour = -1;
+    int parsedMinute = -1;
+    sscanf(text, "%d:%d", &parsedHour, &parsedMinute);
+    hour = (int16_t)parsedHour;
+    minute = (int16_t)parsedMinute;
+}
+
+static bool parseArgument(const CommandSpec &spec, JsonVariantConst value, SwellCommand &command)
+{
+    switch (spec.arg)
+    {
+    case ARG_NONE:
+        return true;
+
+    case ARG_BOOL:
+        if (!value.is<bool>() && !value.is<int>())
+            return false;
+        command.value = value.as<bool>() ? 1 : 0;
+        return true;
+
+    case ARG_INT:
+        if (!value.is<int32_t>())
+            return false;
+        command.value = value.as<int32_t>();
+        return true;
+
+    case ARG_FIELD:
+    {
+        JsonVariantConst field = value[spec.field];
+        if (field.isNull())
+            return true;
+        if (!field.is<uint32_t>())
+            return false;
+        command.value = (int32_t)field.as<uint32_t>();
+        return true;
+    }
+
+    case ARG_ETAG:
+        copyEtag(command.etag, sizeof(command.etag), value["etag"].as<const char *>());
+        return true;
+
+    case ARG_TIME_RANGE:
+        parseTime(value["start"] | "", command.startHour, command.startMinute);
+        parseTime(value["end"] | "", command.endHour, command.endMinute);
+        return true;
+
+    case ARG_DATE_TIME:
+        command.year = value["year"].as<int>();
+        command.month = value["month"].as<int>();
+        command.day = value["day"].as<int>();
+        command.dayOfWeek = value["dayOfWeek"].as<int>();
+        command.hour = value["hour"].as<int>();
+        command.minute = value["minute"].as<int>();
+        command.second = value["second"].as<int>();
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief JSON -> SwellCommand. Aman dipanggil dari task AsyncTCP
+ *        (tidak menyentuh state global).
+ * @return false jika JSON rusak, command tidak dikenal atau argumen
+ *         tidak sesuai skema di command_table.cpp
+ */
+bool parseCommand(const uint8_t *data, size_t len, SwellCommand &command)
+{
+    // Nama dicari langsung di buffer: command tak dikenal ditolak sebelum
+    // JsonDocument mengalokasikan apa pun
+    const char *name;
+    size_t nameLen;
+    CommandType type = scanJsonCommand(data, len, name, nameLen);
+    if (type == CMD_UNKNOWN)
+    {
+        SWELL_LOGW(LOG_CMD, "⚠️ Command tidak dikenal: '%.*s'", (int)nameLen, name);
+        return false;
+    }
+
+    JsonDocument doc;
+    if (deserializeJson(doc, (const char *)data, len))
+        return false;
+
+    const CommandSpec &spec = commandSpec(type);
+    if (strcmp(doc["command"] | "", spec.name) != 0)
+        return false; // Yang ditemukan scan bukan key "command" di level atas
+
+    command = SwellCommand();
+    command.type = type;
+    if (!parseArgument(spec, doc["value"], command) || !validateCommand(command))
+    {
+        SWELL_LOGW(LOG_CMD, "⚠️ Argumen command '%s' tidak valid", spec.name);
+        return false;
+    }
+    return true;
+}
+
+// =================================================================
+// ⭐ COMMAND HANDLERS
+// =================================================================
+// Satu handler per CommandType (urutan sama dengan SWELL_COMMANDS).
+// Gating (timer on / confirmed) sudah dicek applyCommand() sebelum
+// handler dipanggil. Return true jika userSettings berubah.
+
+typedef bool (*CommandHandler)(const SwellCommand &command);
+
+static bool applyGetStatus(const SwellCommand &command)
+{
+    sendStatusSnapshot(command.clientId); // Full resync (client baru / seq terlewat)
+    return false;
+}
+
+static bool applyGetPlaylist(const SwellCommand &command)
+{
+    generateAndSendPlaylist(command.etag[0] ? command.etag : nullptr, command.clientId);
+    return false;
+}
+
+static bool applyGetClockSync(const SwellCommand &command)
+{
+    sendClockSync((uint32_t)command.value, command.clientId);
+    return false;
+}
+
+static bool applyHello(const SwellCommand &command)
+{
+    // Client boleh mengirim frame biner jika versinya cocok
+    char buffer[OUTBOUND_JSON_CAPACITY];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject().add("type", "hello").add("binaryVersion", (int)BINARY_PROTOCOL_VERSION).endObject();
+    sendJson(json, command.clientId);
+    return false;
+}
+
+static bool applyGetLogs(const SwellCommand &command)
+{
+    // Satu halaman per permintaan; client meminta lagi dengan "since": next
+    char buffer[OUTBOUND_JSON_CAPACITY];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject().add("type", "logs").beginArray("entries");
+
+    uint32_t cursor = (uint32_t)command.value;
+    LogEntry entry;
+    while (json.length() + LOG_TEXT_MAX * 2 + 96 < sizeof(buffer) && readLog(cursor, entry))
+    {
+        char level[2] = {logLevelLetter(entry.level), '\0'};
+        json.beginObject()
+            .add("seq", (unsigned long)entry.seq)
+            .add("t", (unsigned long)entry.timeMs)
+            .add("level", level)
+            .add("tag", logTagName(entry.tag))
+            .add("msg", entry.text)
+            .endObject();
+    }
+
+    json.endArray().add("next", (unsigned long)cursor).add("head", (unsigned long)logHeadSeq()).endObject();
+    sendJson(json, command.clientId);
+    return false;
+}
+
+static bool applyGetMetrics(const SwellCommand &command)
+{
+    sendMetrics(command.clientId);
+    return false;
+}
+
+static bool applyRtcCalibrate(const SwellCommand &command)
+{
+    bool calibrationSuccess = calibrateRTC(command.year, command.month, command.day, command.dayOfWeek,
+                                           command.hour, command.minute, command.second);
+
+    char buffer[OUTBOUND_JSON_CAPACITY];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject().add("type", "rtcCalibrated").add("success", calibrationSuccess);
+    if (!calibrationSuccess)
+    {
+        json.add("error", "Failed to calibrate RTC");
+    }
+    json.endObject();
+
+    sendJson(json, command.clientId);
+
+    if (calibrationSuccess)
+    {
+        serviceClockSync(); // Generation jam naik -> clockSync ke semua client
+    }
+    return false;
+}
+
+static bool applyTimerToggle(const SwellCommand &command)
+{
+    userSettings.timer.on = command.value != 0;
+
+    if (!userSettings.timer.on)
+    {
+        userSettings.timer.confirmed = false;
+        // Reset execution state, not user settings
+        executionState.aromatherapyActive = false;
+        executionState.musicActive = false;
+        resetAromatherapy();
+    }
+    return true;
+}
+
+static bool applyTimerConfirm(const SwellCommand &command)
+{
+    userSettings.timer.confirmed = true;
+    if (command.startHour >= 0)
+        userSettings.timer.startHour = command.startHour;
+    if (command.startMinute >= 0)
+        userSettings.timer.startMinute = command.startMinute;
+    if (command.endHour >= 0)
+        userSettings.timer.endHour = command.endHour;
+    if (command.endMinute >= 0)
+        userSettings.timer.endMinute = command.endMinute;
+    return true;
+}
+
+static bool applyLightIntensity(const SwellCommand &command)
+{
+    userSettings.light.intensity = command.value;
+    SWELL_LOGI(LOG_LIGHT, "💡 Light intensity USER SETTING: %d%%", userSettings.light.intensity);
+    return true;
+}
+
+static bool applyAromaToggle(const SwellCommand &command)
+{
+    // ⭐ FIXED: Update user setting, bukan execution state
+    userSettings.aromatherapy.enabled = command.value != 0;
+    SWELL_LOGI(LOG_AROMA, "💨 Aromatherapy USER SETTING: %s",
+               userSettings.aromatherapy.enabled ? "ENABLED" : "DISABLED");
+
+    // Reset execution state jika user disable
+    if (!userSettings.aromatherapy.enabled && executionState.aromatherapyActive)
+    {
+        executionState.aromatherapyActive = false;
+        resetAromatherapy();
+    }
+    return true;
+}
+
+static bool applyAlarmToggle(const SwellCommand &command)
+{
+    userSettings.alarm.enabled = command.value != 0;
+    SWELL_LOGI(LOG_ALARM, "🔔 Alarm USER SETTING: %s (fixed track %d)",
+               userSettings.alarm.enabled ? "ENABLED" : "DISABLED", ALARM_TRACK_NUMBER);
+    return true;
+}
+
+static bool applyMusicToggle(const SwellCommand &command)
+{
+    // ⭐ FIXED: Update user setting, bukan execution state
+    userSettings.music.enabled = command.value != 0;
+    SWELL_LOGI(LOG_MUSIC, "🎵 Music USER SETTING: %s",
+               userSettings.music.enabled ? "ENABLED" : "DISABLED");
+
+    // Reset execution state jika user disable
+    if (!userSettings.music.enabled && executionState.musicActive)
+    {
+        executionState.musicActive = false;
+        stopMusic();
+    }
+    return true;
+}
+
+static bool applyMusicTrack(const SwellCommand &command)
+{
+    int validTrack = getValidMusicTrackNumber(command.value);
+    userSettings.music.track = validTrack;
+
+    // Jika musik sedang active, ganti track langsung
+    if (executionState.musicActive && dfPlayerInitialized)
+    {
+        playMusicTrack(validTrack);
+        SWELL_LOGI(LOG_MUSIC, "🎵 Music track changed to: %d (NO REPEAT)", validTrack);
+    }
+    return true;
+}
+
+static bool applyMusicVolume(const SwellCommand &command)
+{
+    int frontendVolume = command.value;
+    frontendVolume = (frontendVolume / 10) * 10;
+    int dfPlayerVolume = mapRange(frontendVolume, 0, 100, 0, 30);
+    userSettings.music.volume = dfPlayerVolume;
+
+    if (dfPlayerInitialized)
+    {
+        setMusicVolume(dfPlayerVolume);
+    }
+    SWELL_LOGI(LOG_MUSIC, "🎵 Music volume USER SETTING: %d%% (DFPlayer: %d/30)", frontendVolume, dfPlayerVolume);
+    return true;
+}
+
+static const CommandHandler COMMAND_HANDLERS[] = {
+    nullptr,             // unknown
+    applyGetStatus,      // getStatus
+    applyGetPlaylist,    // getPlaylist
+    applyGetClockSync,   // getClockSync
+    applyRtcCalibrate,   // rtc-calibrate
+    applyTimerToggle,    // timer-toggle
+    applyTimerConfirm,   // timer-confirm
+    applyLightIntensity, // light-intensity
+    applyAromaToggle,    // aroma-toggle
+    applyAlarmToggle,    // alarm-toggle
+    applyMusicToggle,    // music-toggle
+    applyMusicTrack,     // music-track
+    applyMusicVolume,    // music-volume
+    applyHello,          // hello
+    applyGetLogs,        // getLogs
+    applyGetMetrics,     // getMetrics
+};
+
+static_assert(sizeof(COMMAND_HANDLERS) / sizeof(COMMAND_HANDLERS[0]) == COMMAND_TYPE_COUNT,
+              "Setiap CommandType harus punya handler");
+
+/** @return nullptr jika gate terbuka, selain itu alasan command diabaikan */
+static const char *closedGateReason(CommandGate gate)
+{
+    switch (gate)
+    {
+    case GATE_TIMER_ON:
+        return userSettings.timer.on ? nullptr : "timer belum aktif";
+    case GATE_TIMER_CONFIRMED:
+        return userSettings.timer.confirmed ? nullptr : "timer belum dikonfirmasi";
+    default:
+        return nullptr;
+    }
+}
+
+/**
+ * ⭐ FIXED: Apply command - UPDATE USER SETTINGS SAJA
+ * @note Hanya dipanggil dari pemilik state (loop() / processCommandQueue())
+ */
+void applyCommand(const SwellCommand &command)
+{
+    const CommandSpec &spec = commandSpec(command.type);
+    if (spec.type == CMD_UNKNOWN)
+        return;
+
+    SWELL_LOGD(LOG_CMD, "📨 Command diterima: %s", spec.name);
+
+    const char *reason = closedGateReason(spec.gate);
+    if (reason)
+    {
+        SWELL_LOGW(LOG_CMD, "⚠️ Perintah '%s' diabaikan, %s.", spec.name, reason);
+        return;
+    }
+
+    // =================================================================
+    // SAVE & NOTIFY JIKA ADA PERUBAHAN
+    // =================================================================
+    if (COMMAND_HANDLERS[spec.type](command))
+    {
+        SWELL_LOGD(LOG_CMD, "✅ Perintah '%s' diterima dan diproses.", spec.name);
+        markUserSettingsDirty();  // ⭐ Flush ke flash di-coalesce oleh loop()
+        checkAndApplySchedules(); // Apply ke hardware execution
+        notifyClients();          // ⭐ Broadcast user settings + execution state
+    }
+}
+
+static bool parseMessage(const uint8_t *data, size_t len, bool binary, uint32_t clientId, SwellCommand &command)
+{
+    bool parsed = binary ? decodeBinaryCommand(data, len, command) : parseCommand(data, len, command);
+    recordWebSocketIn(len, parsed);
+    if (!parsed)
+        return false;
+    command.clientId = clientId;
+    return true;
+}
+
+/**
+ * @brief Parse + apply langsung (env:native, benchmark, single task)
+ */
+void handleWebSocketMessage(const uint8_t *data, size_t len, bool binary, uint32_t clientId)
+{
+    SwellCommand command;
+    if (parseMessage(data, len, binary, clientId, command))
+        applyCommand(command);
+}
+
+/**
+ * @brief Dipanggil dari task AsyncTCP: parse lalu enqueue, tanpa menyentuh state
+ */
+bool queueWebSocketMessage(const uint8_t *data, size_t len, bool binary, uint32_t clientId)
+{
+    SwellCommand command;
+    if (!parseMessage(data, len, binary, clientId, command))
+        return false;
+    return enqueueCommand(command);
+}
+
+/**
+ * @brief Command latestWins (slider light-intensity / music-volume) yang langsung disusul
+ *        command sejenis cukup di-apply nilai terakhirnya
+ */
+static bool isSupersededBy(const SwellCommand &command, const SwellCommand *next)
+{
+    if (!next || next->type != command.type)
+        return false;
+    return commandSpec(command.type).latestWins;
+}
+
+void processCommandQueue()
+{
+    CommandQueueStats &stats = commandQueueStats();
+    SwellCommand command;
+    while (dequeueCommand(command))
+    {
+        if (isSupersededBy(command, peekCommand()))
+        {
+            stats.coalesced++;
+            continue;
+        }
+
+        applyCommand(command);
+        stats.applied++;
+    }
+}
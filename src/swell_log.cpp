@@ -0,0 +1,225 @@
+/**
+ * @file swell_log.cpp
+ * @brief Swell Smart Lamp - Logging berlevel + ring buffer (ESP32 & native)
+ */
+
+#include "swell_log.h"
+
+#include <atomic>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hal.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+static_assert((LOG_RING_ENTRIES & (LOG_RING_ENTRIES - 1)) == 0, "LOG_RING_ENTRIES harus pangkat 2");
+
+// Slot ring: seq = ticket + 1 setelah selesai ditulis, 0 selama ditulis
+// (seqlock sederhana; pembaca mengecek seq sebelum dan sesudah menyalin)
+struct LogSlot
+{
+    std::atomic<uint32_t> seq;
+    uint32_t timeMs;
+    uint8_t level;
+    LogTag tag;
+    char text[LOG_TEXT_MAX];
+};
+
+static LogSlot ring[LOG_RING_ENTRIES];
+static std::atomic<uint32_t> nextTicket(0);
+static LogStats stats;
+
+static const char *const TAG_NAMES[LOG_TAG_COUNT] = {
+    "sys", "net", "web", "ws", "cmd", "clock", "settings", "audio", "music", "aroma", "alarm", "light",
+};
+
+// =================================================================
+// PRODUCER
+// =================================================================
+
+/** @brief Potong di batas karakter UTF-8 supaya getLogs tetap JSON/teks valid */
+static void trimUtf8(char *text, size_t len)
+{
+    while (len > 0 && ((unsigned char)text[len - 1] & 0xC0) == 0x80)
+        len--;
+    if (len > 0 && ((unsigned char)text[len - 1] & 0x80))
+        len--; // Byte awal multi-byte yang kehilangan lanjutannya
+    text[len] = '\0';
+}
+
+static void drainNow();
+
+void swellLog(uint8_t level, LogTag tag, const char *format, ...)
+{
+    uint32_t ticket = nextTicket.fetch_add(1, std::memory_order_relaxed);
+    LogSlot &slot = ring[ticket & (LOG_RING_ENTRIES - 1)];
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.timeMs = hal.clock->millis();
+    slot.level = level;
+    slot.tag = tag;
+
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(slot.text, sizeof(slot.text), format, args);
+    va_end(args);
+
+    if (len < 0)
+        slot.text[0] = '\0';
+    else if ((size_t)len >= sizeof(slot.text))
+    {
+        trimUtf8(slot.text, sizeof(slot.text) - 1);
+        stats.truncated++;
+    }
+
+    slot.seq.store(ticket + 1, std::memory_order_release);
+    stats.written++;
+    drainNow();
+}
+
+// =================================================================
+// READER
+// =================================================================
+
+bool readLog(uint32_t &cursor, LogEntry &entry)
+{
+    for (;;)
+    {
+        uint32_t head = nextTicket.load(std::memory_order_acquire);
+        if ((int32_t)(head - cursor) <= 0)
+            return false;
+        if (head - cursor > LOG_RING_ENTRIES)
+            cursor = head - LOG_RING_ENTRIES; // Sudah tertimpa
+
+        const LogSlot &slot = ring[cursor & (LOG_RING_ENTRIES - 1)];
+        uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if (before != cursor + 1)
+        {
+            if (before == 0 || (int32_t)(before - (cursor + 1)) < 0)
+                return false; // Producer masih menulis entri ini
+            cursor++;         // Tertimpa entri yang lebih baru
+            continue;
+        }
+
+        entry.seq = cursor;
+        entry.timeMs = slot.timeMs;
+        entry.level = slot.level;
+        entry.tag = slot.tag;
+        memcpy(entry.text, slot.text, sizeof(entry.text));
+        entry.text[sizeof(entry.text) - 1] = '\0';
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        cursor++;
+        if (slot.seq.load(std::memory_order_relaxed) == before)
+            return true;
+        // Ditimpa selagi disalin: lanjut ke entri berikutnya
+    }
+}
+
+uint32_t logHeadSeq()
+{
+    return nextTicket.load(std::memory_order_acquire);
+}
+
+uint32_t logOldestSeq()
+{
+    uint32_t head = logHeadSeq();
+    return head > LOG_RING_ENTRIES ? head - LOG_RING_ENTRIES : 0;
+}
+
+char logLevelLetter(uint8_t level)
+{
+    static const char LETTERS[] = "-EWID";
+    return level < sizeof(LETTERS) - 1 ? LETTERS[level] : '?';
+}
+
+const char *logTagName(LogTag tag)
+{
+    return tag < LOG_TAG_COUNT ? TAG_NAMES[tag] : "?";
+}
+
+const LogStats &logStats()
+{
+    return stats;
+}
+
+// =================================================================
+// DRAIN (Serial / stdout)
+// =================================================================
+
+static uint32_t drainCursor = 0;
+
+static void countLost(uint32_t expected, const LogEntry &entry)
+{
+    stats.lost += entry.seq - expected;
+}
+
+#ifdef ARDUINO
+
+static TaskHandle_t drainTask = nullptr;
+
+static void drainNow()
+{
+    if (drainTask)
+        xTaskNotifyGive(drainTask);
+}
+
+static void drainLoop(void *)
+{
+    LogEntry entry;
+    for (;;)
+    {
+        uint32_t expected = drainCursor;
+        while (readLog(drainCursor, entry))
+        {
+            countLost(expected, entry);
+            expected = drainCursor;
+            // Blocking di UART tidak apa-apa di sini, bukan di pemanggil log
+            Serial.printf("[%6lu.%03lu] %c %-8s %s\n", (unsigned long)(entry.timeMs / 1000),
+                          (unsigned long)(entry.timeMs % 1000), logLevelLetter(entry.level),
+                          logTagName(entry.tag), entry.text);
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+void logBegin()
+{
+    if (drainTask)
+        return;
+
+    // Core 0 (loop() di core 1), di bawah AsyncTCP/WiFi: log tidak pernah
+    // mendahului pekerjaan lain
+    xTaskCreatePinnedToCore(drainLoop, "swellLog", 3072, nullptr, tskIDLE_PRIORITY + 1, &drainTask, 0);
+}
+
+#else
+
+static void drainNow()
+{
+    if (!swellNativeLogEnabled)
+    {
+        drainCursor = logHeadSeq(); // Benchmark: tidak dicetak, tidak dihitung hilang
+        return;
+    }
+
+    LogEntry entry;
+    uint32_t expected = drainCursor;
+    while (readLog(drainCursor, entry))
+    {
+        countLost(expected, entry);
+        expected = drainCursor;
+        printf("%c %-8s %s\n", logLevelLetter(entry.level), logTagName(entry.tag), entry.text);
+    }
+}
+
+void logBegin()
+{
+}
+
+#endif
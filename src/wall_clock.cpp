@@ -0,0 +1,222 @@
+/**
+ * @file wall_clock.cpp
+ * @brief Swell Smart Lamp - Jam software yang didisiplinkan oleh DS3231
+ */
+
+#include "wall_clock.h"
+
+#include "hal.h"
+#include "swell_log.h"
+
+#ifdef ARDUINO
+#include <esp_attr.h>
+#else
+#define IRAM_ATTR
+#endif
+
+// =================================================================
+// KALENDER
+// =================================================================
+
+long long daysFromCivil(int y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const long long era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (long long)doe - 730425; // 730425 = 2000-01-01
+}
+
+void civilFromDays(long long z, int &y, unsigned &m, unsigned &d)
+{
+    z += 730425;
+    const long long era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int)(yoe + era * 400) + (m <= 2);
+}
+
+// =================================================================
+// STATE
+// =================================================================
+
+static bool synced = false;
+static unsigned long anchorMillis = 0; // millis() saat anchor
+static long long anchorEpochMs = 0;    // Waktu (epoch ms) saat anchor
+static unsigned long lastSyncMillis = 0;
+
+// Baseline estimasi drift (direset saat RTC di-set ulang). Selisih millis()
+// dijumlahkan per sync ke 64-bit: millis() 32-bit wrap setiap ~49,7 hari.
+static unsigned long long baselineElapsedMs = 0;
+static long long baselineEpochMs = 0;
+
+static volatile unsigned long edgeMillis = 0;
+static volatile bool edgePending = false;
+
+static WallClockStats stats;
+
+static long long predictEpochMs(unsigned long now)
+{
+    long long elapsed = (long long)(unsigned long)(now - anchorMillis);
+    return anchorEpochMs + elapsed + elapsed * stats.driftPpb / 1000000000LL;
+}
+
+static long long readRtcEpochSeconds()
+{
+    hal.rtc->refresh();
+    long long days = daysFromCivil(2000 + hal.rtc->year(), hal.rtc->month(), hal.rtc->day());
+    return days * 86400 + hal.rtc->hour() * 3600L + hal.rtc->minute() * 60L + hal.rtc->second();
+}
+
+static void reanchor(unsigned long now, long long epochMs)
+{
+    anchorMillis = now;
+    anchorEpochMs = epochMs;
+}
+
+static void updateDrift(long long epochMs)
+{
+    long long elapsed = (long long)baselineElapsedMs;
+    if (elapsed < (long long)WALL_CLOCK_DRIFT_MIN_BASELINE_MS)
+        return;
+
+    // Laju RTC relatif terhadap millis(), dari baseline sampai sekarang
+    long long rtcElapsed = epochMs - baselineEpochMs;
+    long long ppb = (rtcElapsed - elapsed) * 1000000000LL / elapsed;
+    if (ppb > WALL_CLOCK_MAX_DRIFT_PPB)
+        ppb = WALL_CLOCK_MAX_DRIFT_PPB;
+    if (ppb < -WALL_CLOCK_MAX_DRIFT_PPB)
+        ppb = -WALL_CLOCK_MAX_DRIFT_PPB;
+    stats.driftPpb = (long)ppb;
+}
+
+// =================================================================
+// SYNC
+// =================================================================
+
+void wallClockSync(bool reset)
+{
+    unsigned long now = hal.clock->millis();
+    long long rtcMs = readRtcEpochSeconds() * 1000;
+    stats.syncs++;
+    lastSyncMillis = now;
+
+    // Tepi SQW baru saja lewat: detik RTC dimulai tepat di edgeMillis
+    bool useEdge = edgePending && now - edgeMillis < 1000;
+    edgePending = false;
+
+    if (!synced || reset)
+    {
+        if (useEdge)
+            reanchor(edgeMillis, rtcMs);
+        else
+            reanchor(now, rtcMs);
+        baselineElapsedMs = 0;
+        baselineEpochMs = anchorEpochMs;
+        synced = true;
+        stats.lastStepMs = 0;
+        stats.generation++;
+        return;
+    }
+
+    long long predicted = predictEpochMs(now);
+    long long corrected = predicted;
+    if (useEdge)
+    {
+        corrected = rtcMs + (long long)(now - edgeMillis);
+        stats.edgeSyncs++;
+    }
+    else if (predicted < rtcMs)
+    {
+        corrected = rtcMs; // Detik RTC sudah berganti lebih awal dari prediksi
+    }
+    else if (predicted > rtcMs + 999)
+    {
+        corrected = rtcMs + 999; // Prediksi sudah melewati detik RTC
+    }
+
+    if (corrected != predicted)
+    {
+        stats.steps++;
+        stats.lastStepMs = (long)(corrected - predicted);
+        if (stats.lastStepMs >= 1000 || stats.lastStepMs <= -1000)
+        {
+            SWELL_LOGI(LOG_CLOCK, "🕐 Jam software dikoreksi %ld ms", stats.lastStepMs);
+            stats.generation++; // Client perlu clockSync baru
+        }
+    }
+
+    baselineElapsedMs += (unsigned long)(now - anchorMillis); // Anchor lama < WALL_CLOCK_RESYNC_MS lalu
+    reanchor(now, corrected);
+    updateDrift(corrected);
+}
+
+bool serviceWallClock()
+{
+    if (synced && millisUntilWallClockSync() > 0)
+        return false;
+
+    wallClockSync();
+    return true;
+}
+
+unsigned long millisUntilWallClockSync()
+{
+    if (!synced)
+        return 0;
+
+    unsigned long elapsed = hal.clock->millis() - lastSyncMillis;
+    return elapsed >= WALL_CLOCK_RESYNC_MS ? 0 : WALL_CLOCK_RESYNC_MS - elapsed;
+}
+
+void IRAM_ATTR wallClockSecondEdge(unsigned long atMillis)
+{
+    edgeMillis = atMillis;
+    edgePending = true;
+}
+
+// =================================================================
+// QUERY (tanpa I2C)
+// =================================================================
+
+long long wallClockEpochMs()
+{
+    if (!synced)
+        wallClockSync();
+    return predictEpochMs(hal.clock->millis());
+}
+
+void wallClockNow(WallClockTime &time)
+{
+    long long epochMs = wallClockEpochMs();
+    long long days = epochMs / 86400000LL;
+    long msOfDay = (long)(epochMs % 86400000LL);
+
+    int year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+
+    time.year = year;
+    time.month = (uint8_t)month;
+    time.day = (uint8_t)day;
+    time.dayOfWeek = (uint8_t)((days + 6) % 7 + 1); // 2000-01-01 = Sabtu (7)
+    time.hour = (uint8_t)(msOfDay / 3600000L);
+    time.minute = (uint8_t)(msOfDay / 60000L % 60);
+    time.second = (uint8_t)(msOfDay / 1000L % 60);
+    time.millisecond = (uint16_t)(msOfDay % 1000L);
+}
+
+long wallClockSecondOfDay()
+{
+    return (long)(wallClockEpochMs() % 86400000LL / 1000);
+}
+
+const WallClockStats &wallClockStats()
+{
+    return stats;
+}
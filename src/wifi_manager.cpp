@@ -0,0 +1,299 @@
+/**
+ * @file wifi_manager.cpp
+ * @brief Swell Smart Lamp - Koneksi WiFi non-blocking dengan reconnect di background
+ */
+
+#include "wifi_manager.h"
+
+#include <atomic>
+#include <string.h>
+
+#include "hal.h"
+#include "metrics.h"
+#include "swell_log.h"
+
+// =================================================================
+// ANTRIAN EVENT (TASK EVENT WIFI -> loop(), SPSC)
+// =================================================================
+
+const size_t WIFI_EVENT_QUEUE_SIZE = 8; // Harus pangkat 2
+
+enum LinkEventType : uint8_t
+{
+    LINK_CONNECTED,
+    LINK_GOT_IP,
+    LINK_DISCONNECTED
+};
+
+struct LinkEvent
+{
+    LinkEventType type;
+    uint8_t detail; // Channel (CONNECTED) / reason (DISCONNECTED)
+    uint8_t bssid[6];
+    unsigned long atMs;
+};
+
+static LinkEvent events[WIFI_EVENT_QUEUE_SIZE];
+static std::atomic<uint32_t> eventHead(0);
+static std::atomic<uint32_t> eventTail(0);
+
+static WifiManagerStats stats;
+
+static void pushEvent(LinkEventType type, uint8_t detail, const uint8_t *bssid)
+{
+    uint32_t head = eventHead.load(std::memory_order_relaxed);
+    if (head - eventTail.load(std::memory_order_acquire) >= WIFI_EVENT_QUEUE_SIZE)
+    {
+        stats.eventsDropped++; // Timeout percobaan tetap memulihkan state
+        return;
+    }
+
+    LinkEvent &event = events[head & (WIFI_EVENT_QUEUE_SIZE - 1)];
+    event.type = type;
+    event.detail = detail;
+    if (bssid)
+        memcpy(event.bssid, bssid, sizeof(event.bssid));
+    event.atMs = hal.clock->millis();
+    eventHead.store(head + 1, std::memory_order_release);
+}
+
+static bool popEvent(LinkEvent &event)
+{
+    uint32_t tail = eventTail.load(std::memory_order_relaxed);
+    if (tail == eventHead.load(std::memory_order_acquire))
+        return false;
+    event = events[tail & (WIFI_EVENT_QUEUE_SIZE - 1)];
+    eventTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+void wifiLinkConnected(const uint8_t *bssid, uint8_t channel)
+{
+    pushEvent(LINK_CONNECTED, channel, bssid);
+}
+
+void wifiLinkGotIp()
+{
+    pushEvent(LINK_GOT_IP, 0, nullptr);
+}
+
+void wifiLinkDisconnected(uint8_t reason)
+{
+    pushEvent(LINK_DISCONNECTED, reason, nullptr);
+}
+
+// =================================================================
+// CACHE AP TERAKHIR (NVS)
+// =================================================================
+
+static const char *WIFI_NAMESPACE = "swell-wifi";
+static const char *WIFI_AP_KEY = "ap";
+
+struct AccessPointCache
+{
+    uint8_t bssid[6];
+    uint8_t channel; // 0 = cache kosong
+};
+
+static AccessPointCache savedAp = {};   // Isi NVS
+static AccessPointCache currentAp = {}; // Dari event CONNECTED terakhir
+
+static void loadAccessPointCache()
+{
+    hal.store->begin(WIFI_NAMESPACE, true);
+    if (!hal.store->isKey(WIFI_AP_KEY) || hal.store->getBytes(WIFI_AP_KEY, &savedAp, sizeof(savedAp)) != sizeof(savedAp))
+        savedAp.channel = 0;
+    hal.store->end();
+}
+
+static void saveAccessPointCache()
+{
+    if (currentAp.channel == 0 || memcmp(&currentAp, &savedAp, sizeof(savedAp)) == 0)
+        return; // AP sama: tidak ada write flash
+
+    savedAp = currentAp;
+    hal.store->begin(WIFI_NAMESPACE, false);
+    hal.store->putBytes(WIFI_AP_KEY, &savedAp, sizeof(savedAp));
+    hal.store->end();
+    stats.cacheWrites++;
+}
+
+// =================================================================
+// STATE MACHINE
+// =================================================================
+
+static const char *networkSsid = nullptr;
+static const char *networkPassword = nullptr;
+static WifiStateCallback stateCallback = nullptr;
+
+static WifiLinkState state = WIFI_LINK_IDLE;
+static bool cachedAttempt = false; // Percobaan sekarang memakai savedAp
+static bool skipCache = false;     // Cache baru saja gagal: percobaan berikutnya scan
+static unsigned long attemptStart = 0;
+static unsigned long retryAt = 0;
+static unsigned long backoffMs = WIFI_BACKOFF_MIN_MS;
+static unsigned long lostAt = 0;
+static bool linkLost = false; // Pernah online lalu putus, menunggu IP lagi
+
+static void startAttempt(unsigned long now)
+{
+    cachedAttempt = savedAp.channel != 0 && !skipCache;
+    skipCache = false;
+    state = WIFI_LINK_CONNECTING;
+    attemptStart = now;
+    stats.attempts++;
+    if (cachedAttempt)
+        stats.cachedAttempts++;
+
+    hal.wifi->connect(networkSsid, networkPassword, cachedAttempt ? savedAp.bssid : nullptr,
+                      cachedAttempt ? savedAp.channel : 0);
+}
+
+/** @brief Percobaan gagal: cache dulu diganti scan, setelah itu backoff eksponensial */
+static void attemptFailed(unsigned long now, unsigned long minDelayMs)
+{
+    unsigned long delayMs;
+    if (cachedAttempt)
+    {
+        skipCache = true; // AP pindah channel / BSSID lain: scan penuh berikutnya
+        delayMs = 0;
+    }
+    else
+    {
+        delayMs = backoffMs;
+        backoffMs = backoffMs * 2 > WIFI_BACKOFF_MAX_MS ? WIFI_BACKOFF_MAX_MS : backoffMs * 2;
+    }
+    if (delayMs < minDelayMs)
+        delayMs = minDelayMs;
+
+    state = WIFI_LINK_BACKOFF;
+    retryAt = now + delayMs;
+    SWELL_LOGD(LOG_NET, "📡 WiFi: coba lagi dalam %lu ms", delayMs);
+}
+
+static void handleEvent(const LinkEvent &event)
+{
+    switch (event.type)
+    {
+    case LINK_CONNECTED:
+        memcpy(currentAp.bssid, event.bssid, sizeof(currentAp.bssid));
+        currentAp.channel = event.detail;
+        if (state == WIFI_LINK_CONNECTING)
+            state = WIFI_LINK_ASSOCIATED;
+        break;
+
+    case LINK_GOT_IP:
+        if (state == WIFI_LINK_ONLINE)
+            break;
+        state = WIFI_LINK_ONLINE;
+        backoffMs = WIFI_BACKOFF_MIN_MS;
+        stats.connects++;
+        if (linkLost)
+        {
+            linkLost = false;
+            stats.lastReconnectMs = event.atMs - lostAt;
+            recordWifiReconnect(stats.lastReconnectMs);
+            SWELL_LOGI(LOG_NET, "✅ WiFi tersambung lagi setelah %lu ms", stats.lastReconnectMs);
+        }
+        saveAccessPointCache();
+        if (stateCallback)
+            stateCallback(true);
+        break;
+
+    case LINK_DISCONNECTED:
+        stats.lastReason = event.detail;
+        if (state == WIFI_LINK_ONLINE)
+        {
+            stats.disconnects++;
+            linkLost = true;
+            lostAt = event.atMs;
+            SWELL_LOGW(LOG_NET, "⚠️ WiFi terputus (reason %u), reconnect di background", (unsigned)event.detail);
+            if (stateCallback)
+                stateCallback(false);
+            startAttempt(hal.clock->millis()); // Router reboot: AP lama biasanya kembali di channel sama
+        }
+        else if (state == WIFI_LINK_CONNECTING || state == WIFI_LINK_ASSOCIATED)
+        {
+            SWELL_LOGD(LOG_NET, "📡 WiFi: percobaan gagal (reason %u)", (unsigned)event.detail);
+            attemptFailed(hal.clock->millis(), 0);
+        }
+        // WIFI_LINK_BACKOFF: event dari disconnect() kita sendiri setelah timeout
+        break;
+    }
+}
+
+// =================================================================
+// PUBLIC API
+// =================================================================
+
+void wifiManagerBegin(const char *ssid, const char *password, WifiStateCallback onChange)
+{
+    networkSsid = ssid;
+    networkPassword = password;
+    stateCallback = onChange;
+
+    loadAccessPointCache();
+    if (savedAp.channel)
+        SWELL_LOGI(LOG_NET, "📡 Connecting to WiFi: %s (AP terakhir, channel %u)", ssid, (unsigned)savedAp.channel);
+    else
+        SWELL_LOGI(LOG_NET, "📡 Connecting to WiFi: %s (scan)", ssid);
+
+    hal.wifi->begin();
+    startAttempt(hal.clock->millis());
+}
+
+void serviceWiFi()
+{
+    LinkEvent event;
+    while (popEvent(event))
+        handleEvent(event);
+
+    unsigned long now = hal.clock->millis();
+    if (state == WIFI_LINK_CONNECTING || state == WIFI_LINK_ASSOCIATED)
+    {
+        unsigned long timeoutMs = cachedAttempt ? WIFI_FAST_CONNECT_TIMEOUT_MS : WIFI_CONNECT_TIMEOUT_MS;
+        if (now - attemptStart >= timeoutMs)
+        {
+            stats.timeouts++;
+            hal.wifi->disconnect();
+            // Jeda minimal supaya event disconnect di atas tidak dihitung ke percobaan berikutnya
+            attemptFailed(now, WIFI_BACKOFF_MIN_MS);
+        }
+    }
+    else if (state == WIFI_LINK_BACKOFF && (long)(now - retryAt) >= 0)
+    {
+        startAttempt(now);
+    }
+}
+
+unsigned long millisUntilWiFiService()
+{
+    if (eventTail.load(std::memory_order_relaxed) != eventHead.load(std::memory_order_acquire))
+        return 0; // Event masuk setelah serviceWiFi()
+
+    unsigned long now = hal.clock->millis();
+    unsigned long deadline;
+    if (state == WIFI_LINK_CONNECTING || state == WIFI_LINK_ASSOCIATED)
+        deadline = attemptStart + (cachedAttempt ? WIFI_FAST_CONNECT_TIMEOUT_MS : WIFI_CONNECT_TIMEOUT_MS);
+    else if (state == WIFI_LINK_BACKOFF)
+        deadline = retryAt;
+    else
+        return WIFI_NO_DEADLINE;
+
+    return (long)(deadline - now) > 0 ? deadline - now : 0;
+}
+
+WifiLinkState wifiState()
+{
+    return state;
+}
+
+bool wifiOnline()
+{
+    return state == WIFI_LINK_ONLINE;
+}
+
+const WifiManagerStats &wifiManagerStats()
+{
+    return stats;
+}
@@ -0,0 +1,189 @@
+/**
+ * @file ws_reassembly.cpp
+ * @brief Swell Smart Lamp - Penyusunan ulang pesan WebSocket (fragmen / multi-paket)
+ */
+
+#include "ws_reassembly.h"
+
+#include <string.h>
+
+struct ReassemblySlot
+{
+    bool used = false;
+    bool discarding = false; // Pesan ditolak, buang potongan sampai akhir pesan
+    uint32_t clientId = 0;
+    uint32_t nextFrame = 0;   // Nomor frame yang ditunggu
+    uint64_t frameOffset = 0; // Offset yang ditunggu di dalam frame
+    size_t length = 0;
+    uint8_t buffer[WS_MESSAGE_MAX_SIZE];
+};
+
+static ReassemblySlot slots[WS_REASSEMBLY_SLOTS];
+static WsReassemblyStats stats;
+
+static ReassemblySlot *findSlot(uint32_t clientId)
+{
+    for (size_t i = 0; i < WS_REASSEMBLY_SLOTS; i++)
+    {
+        if (slots[i].used && slots[i].clientId == clientId)
+            return &slots[i];
+    }
+    return nullptr;
+}
+
+static ReassemblySlot *claimSlot(uint32_t clientId)
+{
+    for (size_t i = 0; i < WS_REASSEMBLY_SLOTS; i++)
+    {
+        if (!slots[i].used)
+        {
+            slots[i].used = true;
+            slots[i].clientId = clientId;
+            return &slots[i];
+        }
+    }
+    return nullptr;
+}
+
+static bool isLastChunk(const WsFragment &fragment, size_t len)
+{
+    return fragment.finalFrame && fragment.frameIndex + len >= fragment.frameLength;
+}
+
+/** @brief Pesan setengah jadi di slot tidak akan pernah selesai */
+static void abandonPartial(ReassemblySlot &slot)
+{
+    if (!slot.discarding && slot.length > 0)
+    {
+        stats.outOfOrder++;
+        stats.bytesDropped += slot.length;
+    }
+    slot.length = 0;
+}
+
+static WsReassemblyResult reject(ReassemblySlot &slot, const WsFragment &fragment, size_t len)
+{
+    stats.bytesDropped += slot.length + len;
+    slot.length = 0;
+    slot.discarding = !isLastChunk(fragment, len);
+    slot.used = slot.discarding;
+    return WS_MESSAGE_REJECTED;
+}
+
+WsReassemblyResult reassembleWebSocketMessage(uint32_t clientId, const WsFragment &fragment,
+                                              const uint8_t *data, size_t len,
+                                              const uint8_t *&message, size_t &messageLen)
+{
+    message = nullptr;
+    messageLen = 0;
+
+    bool messageStart = fragment.frameNumber == 0 && fragment.frameIndex == 0;
+    ReassemblySlot *slot = findSlot(clientId);
+
+    // Jalur umum: satu frame, satu paket -> zero-copy
+    if (messageStart && fragment.finalFrame && len == fragment.frameLength)
+    {
+        if (slot)
+        {
+            abandonPartial(*slot);
+            slot->used = false;
+        }
+        if (len > WS_MESSAGE_MAX_SIZE)
+        {
+            stats.oversized++;
+            stats.bytesDropped += len;
+            return WS_MESSAGE_REJECTED;
+        }
+
+        stats.zeroCopy++;
+        if (len > stats.largestMessage)
+            stats.largestMessage = len;
+        message = data;
+        messageLen = len;
+        return WS_MESSAGE_COMPLETE;
+    }
+
+    if (messageStart)
+    {
+        if (slot)
+            abandonPartial(*slot);
+        else
+            slot = claimSlot(clientId);
+
+        if (!slot)
+        {
+            stats.noSlot++;
+            stats.bytesDropped += len;
+            return WS_MESSAGE_REJECTED;
+        }
+        slot->discarding = false;
+        slot->nextFrame = 0;
+        slot->frameOffset = 0;
+        slot->length = 0;
+    }
+    else if (!slot)
+    {
+        // Potongan tanpa awal pesan (awalnya hilang / sudah ditolak tanpa slot)
+        stats.outOfOrder++;
+        stats.bytesDropped += len;
+        return WS_MESSAGE_REJECTED;
+    }
+
+    if (slot->discarding)
+    {
+        stats.bytesDropped += len;
+        if (isLastChunk(fragment, len))
+            slot->used = slot->discarding = false;
+        return WS_MESSAGE_INCOMPLETE;
+    }
+
+    if (fragment.frameNumber != slot->nextFrame || fragment.frameIndex != slot->frameOffset)
+    {
+        stats.outOfOrder++;
+        return reject(*slot, fragment, len);
+    }
+
+    // Panjang frame sudah diketahui di potongan pertamanya: tolak sebelum menyalin
+    uint64_t expectedLength = slot->length + (fragment.frameLength - fragment.frameIndex);
+    if (expectedLength > WS_MESSAGE_MAX_SIZE || slot->length + len > WS_MESSAGE_MAX_SIZE)
+    {
+        stats.oversized++;
+        return reject(*slot, fragment, len);
+    }
+
+    memcpy(slot->buffer + slot->length, data, len);
+    slot->length += len;
+    slot->frameOffset += len;
+
+    if (slot->frameOffset < fragment.frameLength)
+        return WS_MESSAGE_INCOMPLETE;
+
+    slot->nextFrame++;
+    slot->frameOffset = 0;
+    if (!fragment.finalFrame)
+        return WS_MESSAGE_INCOMPLETE;
+
+    // Slot dilepas, buffer tetap valid sampai event berikutnya
+    slot->used = false;
+    stats.reassembled++;
+    if (slot->length > stats.largestMessage)
+        stats.largestMessage = slot->length;
+    message = slot->buffer;
+    messageLen = slot->length;
+    return WS_MESSAGE_COMPLETE;
+}
+
+void releaseWebSocketClient(uint32_t clientId)
+{
+    ReassemblySlot *slot = findSlot(clientId);
+    if (!slot)
+        return;
+
+    abandonPartial(*slot);
+    slot->used = slot->discarding = false;
+}
+
+const WsReassemblyStats &wsReassemblyStats()
+{
+    return stats;
+}
@@ -0,0 +1,399 @@
+/**
+ * @file test_main.cpp
+ * @brief Swell Smart Lamp - Unit test record settings NVS (codec + migrasi v1)
+ *
+ *   pio test -e native
+ */
+
+#include <string.h>
+#include <unity.h>
+
+#include "hal_native.h"
+#include "settings_store.h"
+#include "swell_core.h"
+
+static const char *RECORD_ENTRY = "swell-app/settings";
+static const char *COMPAT_ENTRY = "swell-app/settingsCompat";
+static const char *LEGACY_ENTRY = "swell-app/userSettings";
+
+/** @brief Layout dump v1 (sama dengan LegacyUserSettingsV1 di settings_store.cpp) */
+struct LegacyRecord
+{
+    struct
+    {
+        bool on;
+        bool confirmed;
+        int startHour;
+        int startMinute;
+        int endHour;
+        int endMinute;
+    } timer;
+    struct
+    {
+        int intensity;
+    } light;
+    struct
+    {
+        bool enabled;
+    } aromatherapy;
+    struct
+    {
+        bool enabled;
+        int track;
+    } alarm;
+    struct
+    {
+        bool enabled;
+        int track;
+        int volume;
+    } music;
+};
+
+/** @brief Record dengan header + CRC valid di sekitar payload bebas */
+static size_t buildRecord(uint8_t version, const uint8_t *payload, size_t payloadSize, uint8_t *out)
+{
+    out[0] = 'S';
+    out[1] = 'W';
+    out[2] = version;
+    out[3] = (uint8_t)payloadSize;
+    memcpy(out + SETTINGS_RECORD_HEADER_SIZE, payload, payloadSize);
+
+    size_t size = SETTINGS_RECORD_HEADER_SIZE + payloadSize;
+    uint16_t crc = settingsCrc16(out, size);
+    out[size] = (uint8_t)(crc & 0xFF);
+    out[size + 1] = (uint8_t)(crc >> 8);
+    return size + SETTINGS_RECORD_CRC_SIZE;
+}
+
+static UserSettings sampleSettings()
+{
+    UserSettings settings;
+    settings.timer.on = true;
+    settings.timer.confirmed = true;
+    settings.timer.startHour = 22;
+    settings.timer.startMinute = 30;
+    settings.timer.endHour = 6;
+    settings.timer.endMinute = 15;
+    settings.light.intensity = 80;
+    settings.aromatherapy.enabled = true;
+    settings.music.enabled = true;
+    settings.music.track = 1;
+    settings.music.volume = 25;
+    return settings;
+}
+
+void setUp()
+{
+    nativeFakes.store.entries.clear();
+    nativeFakes.store.failWrites = false;
+    userSettings = UserSettings();
+}
+
+void tearDown()
+{
+}
+
+// =================================================================
+// CODEC
+// =================================================================
+
+static void test_round_trip()
+{
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    size_t size = encodeSettingsRecord(sampleSettings(), record, sizeof(record));
+    TEST_ASSERT_EQUAL(SETTINGS_RECORD_HEADER_SIZE + SETTINGS_PAYLOAD_SIZE + SETTINGS_RECORD_CRC_SIZE, size);
+
+    UserSettings decoded;
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_OK, decodeSettingsRecord(record, size, decoded));
+    TEST_ASSERT_TRUE(decoded.timer.on);
+    TEST_ASSERT_TRUE(decoded.timer.confirmed);
+    TEST_ASSERT_EQUAL(22, decoded.timer.startHour);
+    TEST_ASSERT_EQUAL(30, decoded.timer.startMinute);
+    TEST_ASSERT_EQUAL(6, decoded.timer.endHour);
+    TEST_ASSERT_EQUAL(15, decoded.timer.endMinute);
+    TEST_ASSERT_EQUAL(80, decoded.light.intensity);
+    TEST_ASSERT_TRUE(decoded.aromatherapy.enabled);
+    TEST_ASSERT_FALSE(decoded.alarm.enabled);
+    TEST_ASSERT_TRUE(decoded.music.enabled);
+    TEST_ASSERT_EQUAL(25, decoded.music.volume);
+}
+
+static void test_encode_rejects_small_buffer()
+{
+    uint8_t record[SETTINGS_RECORD_HEADER_SIZE + SETTINGS_PAYLOAD_SIZE];
+    TEST_ASSERT_EQUAL(0, encodeSettingsRecord(sampleSettings(), record, sizeof(record)));
+}
+
+static void test_crc_mismatch()
+{
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    size_t size = encodeSettingsRecord(sampleSettings(), record, sizeof(record));
+    UserSettings decoded;
+
+    record[SETTINGS_RECORD_HEADER_SIZE + FIELD_LIGHT_INTENSITY] ^= 0x01; // Bit flip di payload
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_BAD_CRC, decodeSettingsRecord(record, size, decoded));
+
+    record[SETTINGS_RECORD_HEADER_SIZE + FIELD_LIGHT_INTENSITY] ^= 0x01;
+    record[size - 1] ^= 0x80; // Bit flip di CRC
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_BAD_CRC, decodeSettingsRecord(record, size, decoded));
+
+    // Record ditolak: settings tujuan tidak disentuh
+    TEST_ASSERT_EQUAL(UserSettings().light.intensity, decoded.light.intensity);
+}
+
+static void test_bad_magic()
+{
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    size_t size = encodeSettingsRecord(sampleSettings(), record, sizeof(record));
+    record[1] = 'X';
+
+    UserSettings decoded;
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_BAD_MAGIC, decodeSettingsRecord(record, size, decoded));
+}
+
+static void test_truncated()
+{
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    size_t size = encodeSettingsRecord(sampleSettings(), record, sizeof(record));
+    UserSettings decoded;
+
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_TRUNCATED, decodeSettingsRecord(record, 0, decoded));
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_TRUNCATED,
+                      decodeSettingsRecord(record, SETTINGS_RECORD_HEADER_SIZE + SETTINGS_RECORD_CRC_SIZE - 1, decoded));
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_TRUNCATED, decodeSettingsRecord(record, size - 1, decoded));
+
+    // Panjang payload di header lebih besar dari data yang ada
+    record[3] = SETTINGS_PAYLOAD_SIZE + 1;
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_TRUNCATED, decodeSettingsRecord(record, size, decoded));
+}
+
+static void test_out_of_range_fields_use_defaults()
+{
+    uint8_t payload[SETTINGS_PAYLOAD_SIZE] = {};
+    payload[FIELD_FLAGS] = 0x02 | 0x08;      // confirmed tanpa timer.on, alarm
+    payload[FIELD_TIMER_START_HOUR] = 24;    // > 23
+    payload[FIELD_TIMER_START_MINUTE] = 45;  // Valid
+    payload[FIELD_TIMER_END_HOUR] = 5;       // Valid
+    payload[FIELD_TIMER_END_MINUTE] = 60;    // > 59
+    payload[FIELD_LIGHT_INTENSITY] = 101;    // > 100
+    payload[FIELD_MUSIC_TRACK] = 0xFE;       // Tidak ada di playlist
+    payload[FIELD_MUSIC_VOLUME] = 31;        // > 30
+
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    size_t size = buildRecord(SETTINGS_RECORD_VERSION, payload, sizeof(payload), record);
+
+    const UserSettings defaults;
+    UserSettings decoded;
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_OK, decodeSettingsRecord(record, size, decoded));
+    TEST_ASSERT_FALSE(decoded.timer.on);
+    TEST_ASSERT_FALSE(decoded.timer.confirmed);
+    TEST_ASSERT_TRUE(decoded.alarm.enabled);
+    TEST_ASSERT_EQUAL(defaults.timer.startHour, decoded.timer.startHour);
+    TEST_ASSERT_EQUAL(45, decoded.timer.startMinute);
+    TEST_ASSERT_EQUAL(5, decoded.timer.endHour);
+    TEST_ASSERT_EQUAL(defaults.timer.endMinute, decoded.timer.endMinute);
+    TEST_ASSERT_EQUAL(defaults.light.intensity, decoded.light.intensity);
+    TEST_ASSERT_EQUAL(getValidMusicTrackNumber(0xFE), decoded.music.track);
+    TEST_ASSERT_EQUAL(defaults.music.volume, decoded.music.volume);
+}
+
+static void test_shorter_and_longer_payloads()
+{
+    uint8_t full[SETTINGS_RECORD_MAX_SIZE];
+    encodeSettingsRecord(sampleSettings(), full, sizeof(full));
+    const uint8_t *payload = full + SETTINGS_RECORD_HEADER_SIZE;
+    const UserSettings defaults;
+    UserSettings decoded;
+
+    // Record lama: field setelah intensity belum ada -> default
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    size_t size = buildRecord(SETTINGS_RECORD_VERSION, payload, FIELD_LIGHT_INTENSITY + 1, record);
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_OK, decodeSettingsRecord(record, size, decoded));
+    TEST_ASSERT_EQUAL(80, decoded.light.intensity);
+    TEST_ASSERT_EQUAL(defaults.music.track, decoded.music.track);
+    TEST_ASSERT_EQUAL(defaults.music.volume, decoded.music.volume);
+
+    // Firmware lebih baru menambah field di akhir (versi sama): prefix tetap terbaca
+    uint8_t extended[SETTINGS_PAYLOAD_SIZE + 3];
+    memcpy(extended, payload, SETTINGS_PAYLOAD_SIZE);
+    memset(extended + SETTINGS_PAYLOAD_SIZE, 0xAA, 3);
+    size = buildRecord(SETTINGS_RECORD_VERSION, extended, sizeof(extended), record);
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_OK, decodeSettingsRecord(record, size, decoded));
+    TEST_ASSERT_EQUAL(25, decoded.music.volume);
+}
+
+static void test_version_checks()
+{
+    uint8_t full[SETTINGS_RECORD_MAX_SIZE];
+    encodeSettingsRecord(sampleSettings(), full, sizeof(full));
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    UserSettings decoded;
+
+    size_t size = buildRecord(SETTINGS_RECORD_VERSION + 1, full + SETTINGS_RECORD_HEADER_SIZE, SETTINGS_PAYLOAD_SIZE, record);
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_NEWER_VERSION, decodeSettingsRecord(record, size, decoded));
+
+    size = buildRecord(1, full + SETTINGS_RECORD_HEADER_SIZE, SETTINGS_PAYLOAD_SIZE, record);
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_BAD_VERSION, decodeSettingsRecord(record, size, decoded));
+}
+
+// =================================================================
+// LOAD / SAVE (FAKE NVS)
+// =================================================================
+
+static void test_newer_record_is_not_overwritten()
+{
+    uint8_t full[SETTINGS_RECORD_MAX_SIZE];
+    encodeSettingsRecord(sampleSettings(), full, sizeof(full));
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    size_t size = buildRecord(SETTINGS_RECORD_VERSION + 1, full + SETTINGS_RECORD_HEADER_SIZE, SETTINGS_PAYLOAD_SIZE, record);
+    nativeFakes.store.entries[RECORD_ENTRY].assign(record, record + size);
+
+    loadUserSettings();
+    TEST_ASSERT_EQUAL(UserSettings().light.intensity, userSettings.light.intensity);
+
+    userSettings.light.intensity = 10;
+    markUserSettingsDirty();
+    flushUserSettings();
+    TEST_ASSERT_FALSE(userSettingsDirty());
+    TEST_ASSERT_EQUAL(size, nativeFakes.store.entries[RECORD_ENTRY].size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(record, nativeFakes.store.entries[RECORD_ENTRY].data(), size);
+}
+
+static void test_changes_after_downgrade_survive_reboot()
+{
+    uint8_t full[SETTINGS_RECORD_MAX_SIZE];
+    encodeSettingsRecord(sampleSettings(), full, sizeof(full));
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    size_t size = buildRecord(SETTINGS_RECORD_VERSION + 1, full + SETTINGS_RECORD_HEADER_SIZE, SETTINGS_PAYLOAD_SIZE, record);
+    nativeFakes.store.entries[RECORD_ENTRY].assign(record, record + size);
+
+    loadUserSettings();
+    unsigned long compatWrites = userSettingsPersistenceStats().compatWrites;
+    userSettings.light.intensity = 10;
+    markUserSettingsDirty();
+    flushUserSettings();
+    TEST_ASSERT_EQUAL(compatWrites + 1, userSettingsPersistenceStats().compatWrites);
+    TEST_ASSERT_EQUAL(1, nativeFakes.store.entries.count(COMPAT_ENTRY));
+
+    // Reboot: perubahan dibaca dari key compat, record versi baru tetap utuh
+    userSettings = UserSettings();
+    loadUserSettings();
+    TEST_ASSERT_EQUAL(10, userSettings.light.intensity);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(record, nativeFakes.store.entries[RECORD_ENTRY].data(), size);
+
+    // Settings sama dengan isi key compat: tidak ada write lagi
+    unsigned long writes = nativeFakes.store.writes;
+    markUserSettingsDirty();
+    flushUserSettings();
+    TEST_ASSERT_EQUAL(writes, nativeFakes.store.writes);
+}
+
+static void test_corrupt_record_falls_back_to_defaults()
+{
+    uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+    size_t size = encodeSettingsRecord(sampleSettings(), record, sizeof(record));
+    record[SETTINGS_RECORD_HEADER_SIZE] ^= 0xFF;
+    nativeFakes.store.entries[RECORD_ENTRY].assign(record, record + size);
+
+    loadUserSettings();
+    TEST_ASSERT_FALSE(userSettings.timer.on);
+    TEST_ASSERT_EQUAL(UserSettings().light.intensity, userSettings.light.intensity);
+}
+
+static void putLegacy(const LegacyRecord &legacy)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&legacy);
+    nativeFakes.store.entries[LEGACY_ENTRY].assign(bytes, bytes + sizeof(legacy));
+}
+
+static LegacyRecord sampleLegacy()
+{
+    LegacyRecord legacy;
+    memset(&legacy, 0, sizeof(legacy));
+    legacy.timer.on = true;
+    legacy.timer.confirmed = true;
+    legacy.timer.startHour = 23;
+    legacy.timer.startMinute = 5;
+    legacy.timer.endHour = 7;
+    legacy.timer.endMinute = 99; // Di luar range -> default
+    legacy.light.intensity = 65;
+    legacy.alarm.enabled = true;
+    legacy.alarm.track = 5;
+    legacy.music.enabled = true;
+    legacy.music.track = 1;
+    legacy.music.volume = 12;
+    return legacy;
+}
+
+static void test_legacy_v1_migration()
+{
+    putLegacy(sampleLegacy());
+
+    loadUserSettings();
+    TEST_ASSERT_TRUE(userSettings.timer.on);
+    TEST_ASSERT_TRUE(userSettings.timer.confirmed);
+    TEST_ASSERT_EQUAL(23, userSettings.timer.startHour);
+    TEST_ASSERT_EQUAL(5, userSettings.timer.startMinute);
+    TEST_ASSERT_EQUAL(7, userSettings.timer.endHour);
+    TEST_ASSERT_EQUAL(UserSettings().timer.endMinute, userSettings.timer.endMinute);
+    TEST_ASSERT_EQUAL(65, userSettings.light.intensity);
+    TEST_ASSERT_TRUE(userSettings.alarm.enabled);
+    TEST_ASSERT_TRUE(userSettings.music.enabled);
+    TEST_ASSERT_EQUAL(12, userSettings.music.volume);
+
+    // Record baru tersimpan, key v1 dihapus
+    TEST_ASSERT_EQUAL(0, nativeFakes.store.entries.count(LEGACY_ENTRY));
+    TEST_ASSERT_EQUAL(1, nativeFakes.store.entries.count(RECORD_ENTRY));
+    const std::vector<uint8_t> &stored = nativeFakes.store.entries[RECORD_ENTRY];
+    UserSettings decoded;
+    TEST_ASSERT_EQUAL(SETTINGS_DECODE_OK, decodeSettingsRecord(stored.data(), stored.size(), decoded));
+    TEST_ASSERT_EQUAL(65, decoded.light.intensity);
+}
+
+static void test_legacy_kept_when_save_fails()
+{
+    putLegacy(sampleLegacy());
+    nativeFakes.store.failWrites = true;
+
+    loadUserSettings();
+    TEST_ASSERT_EQUAL(65, userSettings.light.intensity);
+    TEST_ASSERT_EQUAL(1, nativeFakes.store.entries.count(LEGACY_ENTRY));
+    TEST_ASSERT_EQUAL(0, nativeFakes.store.entries.count(RECORD_ENTRY));
+    TEST_ASSERT_TRUE(userSettingsDirty());
+
+    // Write berikutnya berhasil: record baru tersimpan, baru key v1 dihapus
+    nativeFakes.store.failWrites = false;
+    flushUserSettings();
+    TEST_ASSERT_FALSE(userSettingsDirty());
+    TEST_ASSERT_EQUAL(1, nativeFakes.store.entries.count(RECORD_ENTRY));
+    TEST_ASSERT_EQUAL(0, nativeFakes.store.entries.count(LEGACY_ENTRY));
+}
+
+static void test_legacy_wrong_size_ignored()
+{
+    nativeFakes.store.entries[LEGACY_ENTRY].assign(sizeof(LegacyRecord) - 4, 0x11);
+
+    loadUserSettings();
+    TEST_ASSERT_EQUAL(UserSettings().light.intensity, userSettings.light.intensity);
+    TEST_ASSERT_EQUAL(0, nativeFakes.store.entries.count(RECORD_ENTRY));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_encode_rejects_small_buffer);
+    RUN_TEST(test_crc_mismatch);
+    RUN_TEST(test_bad_magic);
+    RUN_TEST(test_truncated);
+    RUN_TEST(test_out_of_range_fields_use_defaults);
+    RUN_TEST(test_shorter_and_longer_payloads);
+    RUN_TEST(test_version_checks);
+    RUN_TEST(test_newer_record_is_not_overwritten);
+    RUN_TEST(test_changes_after_downgrade_survive_reboot);
+    RUN_TEST(test_corrupt_record_falls_back_to_defaults);
+    RUN_TEST(test_legacy_v1_migration);
+    RUN_TEST(test_legacy_kept_when_save_fails);
+    RUN_TEST(test_legacy_wrong_size_ignored);
+    return UNITY_END();
+}